@@ -0,0 +1,729 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 3:40 AM
+ */
+
+// Multiple input signal filters with Grouped coefficients (IIR_MG_t)
+// Between IIR_MS_t (one set of coefs for all the signals) and IIR_MD_t (one
+// set for each signal): the filter keeps a small table of distinct coef
+// sets (groups) and the group index of each signal. Coefs assigned to a
+// signal are normalized and looked up in the table, so signals with the
+// same coefs share one group (deduplication).
+// The state is coefficient major (see IIR_M_LAYOUT_COEF_MAJOR) with the
+// signals of each group in consecutive positions, and each group is
+// filtered with the shared coefficients vector kernel (the IIR_MS_t one),
+// so outputs match bit by bit the ones of an IIR_MD_t filter with the same
+// coefs. Transposed direct form II only.
+
+#ifndef IIR_MG_FILTERS_H
+#define IIR_MG_FILTERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "IIR_filters.h"
+
+// Initial number of groups of the coefs table (it grows when needed)
+#define IIR_MG_GROUPS_CAPACITY 8
+
+// Number of frames gathered at once in position order by
+// IIR_MG_process_block (the filter keeps a buffer of this many frames)
+#define IIR_MG_BLOCK_FRAMES 16
+
+// Positions taken by a group of size signals: groups of IIR_SIMD_SIGNALS
+// signals or more are padded to a multiple of IIR_SIMD_SIGNALS (so the
+// kernel never runs its tail for them)
+#define _IIR_MG_GROUP_SPAN(size) ( ((size) < IIR_SIMD_SIGNALS) ? (size) : \
+    ((size) + IIR_SIMD_SIGNALS - 1) / IIR_SIMD_SIGNALS * IIR_SIMD_SIGNALS )
+// Number of positions (z row size) needed for n_signals signals in any
+// groups: at most n_signals/IIR_SIMD_SIGNALS groups are padded, each one
+// with less than IIR_SIMD_SIGNALS padding positions
+#define _IIR_MG_POSITIONS(n_signals) _IIR_M_PADDED_SIGNALS( \
+    (n_signals) + (n_signals) / IIR_SIMD_SIGNALS * (IIR_SIMD_SIGNALS - 1), IIR_M_LAYOUT_COEF_MAJOR )
+
+// Type for the structure holding the grouped coefs multiple input signal
+// IIR filter
+typedef struct {
+    int n_signals;
+    int n_coefs;
+    int n_groups;
+    IIR_signal_t *a;
+    IIR_signal_t *b;
+    int *group;
+    IIR_signal_t *z;
+    IIR_signal_t *last_output;
+    int simd_level;
+    IIR_M_kernel_t _kernel;
+    int _padded_signals;
+    int _groups_capacity;
+    int *_group_size;
+    int *_group_start;
+    int *_group_next;
+    int *_group_first;
+    int *_signal_position;
+    int _sorted;
+    int _in_order;
+    IIR_signal_t *_z_scratch;
+    IIR_signal_t *_x_buf;
+    IIR_signal_t *_y_buf;
+
+} IIR_MG_t;
+// Fields:
+//	a, b: coefs of each group, a[group*n_coefs + coef] (normalized)
+//	group: group index of each signal (do not change it, use the set_coefs
+//	    functions)
+//	n_groups: number of groups in the table (groups without signals are
+//	    reused for the next new coefs)
+//	z: state, z[coef*_padded_signals + position]. The positions of the
+//	    signals (_signal_position) keep the signals of each group together
+//	    (from _group_start[group], _group_size[group] signals): groups of
+//	    IIR_SIMD_SIGNALS signals or more go first, from aligned positions
+//	    and padded (see _IIR_MG_GROUP_SPAN), then the smaller ones. The
+//	    padding positions have zero inputs and states, so their outputs
+//	    are zeros. Positions are sorted again (_sorted == 0) before
+//	    filtering after any signal changes its group
+//	_in_order: the signals of each group are consecutive (from
+//	    _group_first[group]), so the inputs of a group are copied to
+//	    their positions in one go and the outputs written in place.
+//	    Otherwise inputs and outputs are gathered one by one
+
+/*
+ * Internal functions
+ */
+
+// Make room for one more group in the coefs table. Internal use.
+// Returns 0 upon error (memory allocation problem)
+inline int _IIR_MG_reserve_group(IIR_MG_t *filter) {
+
+    if (filter->n_groups < filter->_groups_capacity) {
+	return 1;
+    }
+
+    int capacity = 2 * filter->_groups_capacity;
+    size_t coefs_bytes = sizeof (IIR_signal_t) * filter->n_coefs * capacity;
+    IIR_signal_t *a = (IIR_signal_t*) realloc(filter->a, coefs_bytes);
+    if ( a ){
+	filter->a = a;
+    }
+    IIR_signal_t *b = (IIR_signal_t*) realloc(filter->b, coefs_bytes);
+    if ( b ){
+	filter->b = b;
+    }
+    int *group_size = (int*) realloc(filter->_group_size, sizeof (int) * capacity);
+    if ( group_size ){
+	filter->_group_size = group_size;
+    }
+    int *group_start = (int*) realloc(filter->_group_start, sizeof (int) * capacity);
+    if ( group_start ){
+	filter->_group_start = group_start;
+    }
+    int *group_next = (int*) realloc(filter->_group_next, sizeof (int) * capacity);
+    if ( group_next ){
+	filter->_group_next = group_next;
+    }
+    int *group_first = (int*) realloc(filter->_group_first, sizeof (int) * capacity);
+    if ( group_first ){
+	filter->_group_first = group_first;
+    }
+    if ( !a || !b || !group_size || !group_start || !group_next || !group_first ){
+	return 0;
+    }
+
+    filter->_groups_capacity = capacity;
+
+    return 1;
+}
+
+// Group of the normalized coefs stored just after the last group of the
+// table (see _IIR_MG_add_coefs): an equal group, else the first group
+// without signals (the coefs are copied to it), else a new group.
+// Internal use.
+inline int _IIR_MG_find_group(IIR_MG_t *filter) {
+
+    int g;
+    int n_coefs = filter->n_coefs;
+    size_t n_bytes = sizeof (IIR_signal_t) * n_coefs;
+    const IIR_signal_t *a_new = filter->a + filter->n_groups * n_coefs;
+    const IIR_signal_t *b_new = filter->b + filter->n_groups * n_coefs;
+    int empty = -1;
+
+    for (g = 0; g < filter->n_groups; g++) {
+	if ( !memcmp(filter->a + g*n_coefs, a_new, n_bytes)
+	     && !memcmp(filter->b + g*n_coefs, b_new, n_bytes) ) {
+	    return g;
+	}
+	if ( (empty < 0) && (filter->_group_size[g] == 0) ) {
+	    empty = g;
+	}
+    }
+
+    if (empty >= 0) {
+	memcpy(filter->a + empty*n_coefs, a_new, n_bytes);
+	memcpy(filter->b + empty*n_coefs, b_new, n_bytes);
+	return empty;
+    }
+
+    filter->_group_size[filter->n_groups] = 0;
+
+    return filter->n_groups++;
+}
+
+// Normalize a set of coefs and look for its group in the table (see
+// _IIR_MG_find_group). Internal use (the parameters are already checked).
+// The caller counts the signal in the group.
+// Returns the group or -1 upon error (memory allocation problem)
+inline int _IIR_MG_add_coefs(IIR_MG_t *filter,
+			     const IIR_signal_t *b_coefs,
+			     const IIR_signal_t *a_coefs) {
+
+    int n_coefs = filter->n_coefs;
+
+    if ( !_IIR_MG_reserve_group(filter) ){
+	return -1;
+    }
+
+    // The candidate goes after the last group, normalized as in
+    // IIR_MD_set_coefs_one_signal (so equal filters get equal coefs)
+    IIR_signal_t *a_new = filter->a + filter->n_groups * n_coefs;
+    IIR_signal_t *b_new = filter->b + filter->n_groups * n_coefs;
+    memcpy(a_new, a_coefs, sizeof (IIR_signal_t) * n_coefs);
+    memcpy(b_new, b_coefs, sizeof (IIR_signal_t) * n_coefs);
+    IIR_normalize_coefs(n_coefs, b_new, a_new);
+
+    return _IIR_MG_find_group(filter);
+}
+
+// Move one signal to group g. Internal use.
+inline void _IIR_MG_move_signal(IIR_MG_t *filter, int signal_index, int g) {
+
+    filter->_group_size[g]++;
+    if (g != filter->group[signal_index]) {
+	filter->group[signal_index] = g;
+	filter->_sorted = 0;
+    }
+}
+
+// Sort the positions of the signals by group (keeping the signals order
+// inside each group, see IIR_MG_t) and move their states to the new
+// positions. Internal use, called before filtering when needed. No memory
+// is allocated.
+inline void _IIR_MG_sort_signals(IIR_MG_t *filter) {
+
+    int g, k, j;
+    int stride = filter->_padded_signals;
+    int *start = filter->_group_start;
+    int position = 0;
+    int n_runs = 0, n_used_groups = 0;
+
+    // Each group one run of consecutive signals?
+    for (k = 0; k < filter->n_signals; k++) {
+	if ( (k == 0) || (filter->group[k] != filter->group[k-1]) ) {
+	    filter->_group_first[filter->group[k]] = k;
+	    n_runs++;
+	}
+    }
+    for (g = 0; g < filter->n_groups; g++) {
+	n_used_groups += (filter->_group_size[g] > 0);
+    }
+    filter->_in_order = (n_runs == n_used_groups);
+
+    for (g = 0; g < filter->n_groups; g++) {
+	if (filter->_group_size[g] >= IIR_SIMD_SIGNALS) {
+	    start[g] = position;
+	    position += _IIR_MG_GROUP_SPAN(filter->_group_size[g]);
+	}
+    }
+    for (g = 0; g < filter->n_groups; g++) {
+	if (filter->_group_size[g] < IIR_SIMD_SIGNALS) {
+	    start[g] = position;
+	    position += filter->_group_size[g];
+	}
+    }
+    for (g = 0; g < filter->n_groups; g++) {
+	filter->_group_next[g] = start[g];
+    }
+
+    // The padding positions are zeros
+    memset(filter->_z_scratch, 0, sizeof (IIR_signal_t) * filter->n_coefs * stride);
+    memset(filter->_x_buf, 0, sizeof (IIR_signal_t) * stride * IIR_MG_BLOCK_FRAMES);
+    for (k = 0; k < filter->n_signals; k++) {
+	int old_position = filter->_signal_position[k];
+	int new_position = filter->_group_next[filter->group[k]]++;
+	for (j = 0; j < filter->n_coefs; j++) {
+	    filter->_z_scratch[j*stride + new_position] = filter->z[j*stride + old_position];
+	}
+	filter->_signal_position[k] = new_position;
+    }
+
+    IIR_signal_t *z = filter->z;
+    filter->z = filter->_z_scratch;
+    filter->_z_scratch = z;
+    filter->_sorted = 1;
+}
+
+/*
+ * Public functions
+ */
+
+// Fills in the a and b coefficients of one signal of the filter. The
+// coefs are normalized (the contents of the input parameter arrays are not)
+// and the signal joins the group with the same coefs, or a new one.
+// Signals keep their state when they change their group.
+// Returns 0 on fail (given number of coefs does not agree with filters coefs
+// or any of coefs == NULL or signal index out of bounds or memory
+// allocation problem)
+inline int IIR_MG_set_coefs_one_signal(IIR_MG_t* filter,
+				       int n_coefs,
+				       const IIR_signal_t *b_coefs,
+				       const IIR_signal_t *a_coefs,
+				       int signal_index) {
+
+    if ( (n_coefs != filter->n_coefs) || (!a_coefs) || (!b_coefs) ) {
+
+	return 0;
+    }
+
+    if ( (signal_index >= filter->n_signals) || (signal_index < 0) ) {
+
+	return 0;
+    }
+
+    // The signal leaves its group first, so the group can be reused
+    filter->_group_size[filter->group[signal_index]]--;
+    int g = _IIR_MG_add_coefs(filter, b_coefs, a_coefs);
+    if (g < 0) {
+	filter->_group_size[filter->group[signal_index]]++;
+	return 0;
+    }
+    _IIR_MG_move_signal(filter, signal_index, g);
+
+    return 1;
+}
+
+// Fills in the a and b coefficients of all the signals (one group with all
+// the signals, the table is emptied).
+// Returns 0 on fail (given number of coefs does not agree with filters coefs
+// or any of coefs == NULL)
+inline int IIR_MG_set_coefs_all_signals(IIR_MG_t* filter,
+					int n_coefs,
+					const IIR_signal_t *b_coefs,
+					const IIR_signal_t *a_coefs) {
+
+    int k;
+
+    if ( (n_coefs != filter->n_coefs) || (!a_coefs) || (!b_coefs) ) {
+
+	return 0;
+    }
+
+    memcpy(filter->a, a_coefs, sizeof (IIR_signal_t) * n_coefs);
+    memcpy(filter->b, b_coefs, sizeof (IIR_signal_t) * n_coefs);
+    IIR_normalize_coefs(n_coefs, filter->b, filter->a);
+
+    filter->n_groups = 1;
+    filter->_group_size[0] = filter->n_signals;
+    for (k = 0; k < filter->n_signals; k++) {
+	if (filter->group[k] != 0) {
+	    filter->group[k] = 0;
+	    filter->_sorted = 0;
+	}
+    }
+
+    return 1;
+}
+
+// Fills in the a and b coefficients of every signal from a table with one
+// set of coefs for each signal ([n_signals][n_coefs], as in
+// IIR_MD_set_coefs_table). Equal rows (after normalization) share a group.
+// Returns 0 on fail (given number of coefs does not agree with filters coefs
+// or any of the tables == NULL or memory allocation problem)
+inline int IIR_MG_set_coefs_table(IIR_MG_t* filter,
+				  int n_coefs,
+				  const IIR_signal_t *b_table,
+				  const IIR_signal_t *a_table) {
+
+    int k;
+
+    if ( (n_coefs != filter->n_coefs) || (!a_table) || (!b_table) ) {
+
+	return 0;
+    }
+
+    // The table is built again from the first row
+    filter->n_groups = 0;
+    for (k = 0; k < filter->n_signals; k++) {
+	int g = _IIR_MG_add_coefs(filter, b_table + k*n_coefs, a_table + k*n_coefs);
+	if (g < 0) {
+	    break;
+	}
+	_IIR_MG_move_signal(filter, k, g);
+    }
+
+    if (k < filter->n_signals) {
+	// Keep the filter valid: the rest of the signals go to the first
+	// group (the table only fails to grow when it is full)
+	for (; k < filter->n_signals; k++) {
+	    _IIR_MG_move_signal(filter, k, 0);
+	}
+	return 0;
+    }
+
+    return 1;
+}
+
+// Free all the memory allocated by the filter
+inline void IIR_MG_destroy(IIR_MG_t *filter) {
+
+    free(filter->a);
+    free(filter->b);
+    free(filter->group);
+    free(filter->z);
+    free(filter->last_output);
+    free(filter->_group_size);
+    free(filter->_group_start);
+    free(filter->_group_next);
+    free(filter->_group_first);
+    free(filter->_signal_position);
+    free(filter->_z_scratch);
+    free(filter->_x_buf);
+    free(filter->_y_buf);
+    free(filter);
+}
+
+// Create a grouped coefs multiple input signal filter.
+// Parameters:
+//	n_coefs: number of coefficients (order+1)
+//	n_signals: number of input signals
+//	b_coefs, a_coefs: n_coefs coefs for all the signals (one group, as in
+//	    IIR_MS_create). Can be NULL (coefs left as 0s, set them later)
+// Returns:
+//    A filter structure initialized to rest state or NULL upon error
+//    (invalid parameters or memory allocation problem)
+inline IIR_MG_t *IIR_MG_create(int n_coefs, int n_signals,
+			       const IIR_signal_t *b_coefs,
+			       const IIR_signal_t *a_coefs) {
+
+    int k;
+
+    if (n_coefs <= 1) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a filter with not enough coefficients (%d). Min is 2.\n",
+		n_coefs
+		);
+	return NULL;
+    }
+
+    if (n_signals <= 0) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a filter without or negative number of signals: %d.\n",
+		n_signals
+		);
+	return NULL;
+    }
+
+    IIR_MG_t *filter = (IIR_MG_t*) calloc(1, sizeof (IIR_MG_t));
+    if ( !filter ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	return NULL;
+    }
+
+    int padded_signals = _IIR_MG_POSITIONS(n_signals);
+    size_t z_bytes = sizeof (IIR_signal_t) * n_coefs * padded_signals;
+    size_t positions_bytes = sizeof (IIR_signal_t) * padded_signals;
+
+    filter->n_coefs = n_coefs;
+    filter->n_signals = n_signals;
+    filter->_padded_signals = padded_signals;
+    filter->_groups_capacity = IIR_MG_GROUPS_CAPACITY;
+    filter->a = (IIR_signal_t*) calloc(n_coefs * IIR_MG_GROUPS_CAPACITY, sizeof (IIR_signal_t));
+    filter->b = (IIR_signal_t*) calloc(n_coefs * IIR_MG_GROUPS_CAPACITY, sizeof (IIR_signal_t));
+    filter->_group_size = (int*) malloc(sizeof (int) * IIR_MG_GROUPS_CAPACITY);
+    filter->_group_start = (int*) malloc(sizeof (int) * IIR_MG_GROUPS_CAPACITY);
+    filter->_group_next = (int*) malloc(sizeof (int) * IIR_MG_GROUPS_CAPACITY);
+    filter->_group_first = (int*) malloc(sizeof (int) * IIR_MG_GROUPS_CAPACITY);
+    filter->group = (int*) calloc(n_signals, sizeof (int));
+    filter->_signal_position = (int*) malloc(sizeof (int) * n_signals);
+    filter->z = (IIR_signal_t*) _IIR_aligned_malloc(z_bytes);
+    filter->_z_scratch = (IIR_signal_t*) _IIR_aligned_malloc(z_bytes);
+    filter->last_output = (IIR_signal_t*) calloc(n_signals, sizeof (IIR_signal_t));
+    filter->_x_buf = (IIR_signal_t*) _IIR_aligned_malloc(positions_bytes * IIR_MG_BLOCK_FRAMES);
+    filter->_y_buf = (IIR_signal_t*) _IIR_aligned_malloc(positions_bytes);
+
+    if ( !filter->a || !filter->b || !filter->_group_size || !filter->_group_start
+	 || !filter->_group_next || !filter->_group_first || !filter->group || !filter->_signal_position
+	 || !filter->z || !filter->_z_scratch || !filter->last_output
+	 || !filter->_x_buf || !filter->_y_buf ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	IIR_MG_destroy(filter);
+	return NULL;
+    }
+
+    memset(filter->z, 0, z_bytes);
+    memset(filter->_z_scratch, 0, z_bytes);
+
+    // All the signals in group 0 (sorted before filtering)
+    filter->n_groups = 1;
+    filter->_group_size[0] = n_signals;
+    for (k = 0; k < n_signals; k++) {
+	filter->_signal_position[k] = k;
+    }
+    filter->_sorted = 0;
+
+    filter->simd_level = IIR_simd_detect_level();
+    filter->_kernel = _IIR_M_select_kernel(filter->simd_level, 0);
+
+    if ( (a_coefs) && (b_coefs) ){
+	IIR_MG_set_coefs_all_signals(filter, n_coefs, b_coefs, a_coefs);
+    }
+
+    return filter;
+}
+
+// Create a grouped coefs filter with the coefs of each signal taken from a
+// table (see IIR_MG_set_coefs_table).
+// Returns NULL upon error
+inline IIR_MG_t *IIR_MG_create_table(int n_coefs, int n_signals,
+				     const IIR_signal_t *b_table,
+				     const IIR_signal_t *a_table) {
+
+    if ( (!a_table) || (!b_table) ) {
+	fprintf( stderr, "IIR ERROR: trying to create a filter bank without a coefficient table.\n" );
+	return NULL;
+    }
+
+    IIR_MG_t *filter = IIR_MG_create(n_coefs, n_signals, NULL, NULL);
+
+    if ( filter && !IIR_MG_set_coefs_table(filter, n_coefs, b_table, a_table) ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	IIR_MG_destroy(filter);
+	return NULL;
+    }
+
+    return filter;
+}
+
+// Select the instruction set level (IIR_SIMD_LEVEL_*) of the kernel used by
+// the filter (see _IIR_M_set_simd_level).
+// Returns 0 on fail (level not supported by the CPU or not compiled in), 1
+// otherwise
+inline int IIR_MG_set_simd_level(IIR_MG_t *filter, int level) {
+
+    if ( (level < IIR_SIMD_LEVEL_SCALAR) || (level > IIR_simd_cpu_level()) ) {
+	return 0;
+    }
+
+    filter->simd_level = level;
+    filter->_kernel = _IIR_M_select_kernel(level, 0);
+
+    return 1;
+}
+
+// Add the next input (x, one for each signal, so array of n_signals size)
+// to the filter and write the corresponding outputs to y (caller array of
+// n_signals size, not overlapping x), without storing them as the last
+// output of the filter (see IIR_MS_add_input_to)
+inline void IIR_MG_add_input_to(IIR_MG_t *filter, const IIR_signal_t x[], IIR_signal_t y[]) {
+
+    int g, k;
+    int n_coefs = filter->n_coefs;
+
+    if ( !filter->_sorted ){
+	_IIR_MG_sort_signals(filter);
+    }
+
+    // Signals in order: the inputs and outputs of each group are copied in
+    // one go
+    if ( filter->_in_order ) {
+	for (g = 0; g < filter->n_groups; g++) {
+	    int start = filter->_group_start[g];
+	    int first = filter->_group_first[g];
+	    if (filter->_group_size[g] > 0) {
+		memcpy(filter->_x_buf + start, x + first, sizeof (IIR_signal_t) * filter->_group_size[g]);
+		filter->_kernel(n_coefs, filter->_padded_signals,
+				filter->a + g*n_coefs, filter->b + g*n_coefs,
+				filter->z + start, filter->_x_buf + start,
+				filter->_y_buf + start, _IIR_MG_GROUP_SPAN(filter->_group_size[g]));
+		memcpy(y + first, filter->_y_buf + start, sizeof (IIR_signal_t) * filter->_group_size[g]);
+	    }
+	}
+	return;
+    }
+
+    // Otherwise the same with the inputs gathered in position order
+    for (k = 0; k < filter->n_signals; k++) {
+	filter->_x_buf[filter->_signal_position[k]] = x[k];
+    }
+    for (g = 0; g < filter->n_groups; g++) {
+	int start = filter->_group_start[g];
+	if (filter->_group_size[g] > 0) {
+	    filter->_kernel(n_coefs, filter->_padded_signals,
+			    filter->a + g*n_coefs, filter->b + g*n_coefs,
+			    filter->z + start, filter->_x_buf + start,
+			    filter->_y_buf + start, _IIR_MG_GROUP_SPAN(filter->_group_size[g]));
+	}
+    }
+    for (k = 0; k < filter->n_signals; k++) {
+	y[k] = filter->_y_buf[filter->_signal_position[k]];
+    }
+}
+
+// Add an input (one for each signal, so array of n_signals size) to the
+// filter and return a pointer to the corresponding outputs (last_output)
+inline IIR_signal_t *IIR_MG_add_input(IIR_MG_t *filter, const IIR_signal_t x[]) {
+
+    IIR_MG_add_input_to(filter, x, filter->last_output);
+
+    return filter->last_output;
+}
+
+// Filters n_frames frames (n_signals values each, stored one frame after
+// the other) from x and stores the corresponding frames in y (x and y can
+// be the same buffer). Same results as n_frames calls to IIR_MG_add_input.
+// Each group is filtered in chunks of IIR_M_COEF_MAJOR_CHUNK_SIGNALS
+// positions through the frames (as in _IIR_M_coef_major_process), so the
+// states of a chunk stay in cache: through the whole block if the signals
+// are in order, else through IIR_MG_BLOCK_FRAMES frames at a time gathered
+// in position order (_x_buf).
+// Returns 0 on fail (NULL buffers or negative n_frames)
+inline int IIR_MG_process_block(IIR_MG_t *filter,
+				const IIR_signal_t *x,
+				IIR_signal_t *y,
+				int n_frames) {
+
+    int f, f0, g, k, k0;
+    int n_coefs = filter->n_coefs;
+    int n_signals = filter->n_signals;
+    int stride = filter->_padded_signals;
+    const int *position = filter->_signal_position;
+    IIR_signal_t x_buf[IIR_M_COEF_MAJOR_CHUNK_SIGNALS];
+    IIR_signal_t y_buf[IIR_M_COEF_MAJOR_CHUNK_SIGNALS];
+
+    if ( (n_frames < 0) || (!x) || (!y) ) {
+	return 0;
+    }
+
+    if ( n_frames == 0 ) {
+	return 1;
+    }
+
+    if ( !filter->_sorted ){
+	_IIR_MG_sort_signals(filter);
+    }
+
+    // Signals in order: as in _IIR_M_coef_major_process, through the whole
+    // block for each chunk, with the inputs and outputs copied through
+    // x_buf and y_buf (so in-place filtering is supported and the kernel
+    // runs over the padded span, without a tail)
+    for (g = 0; filter->_in_order && (g < filter->n_groups); g++) {
+	int start = filter->_group_start[g];
+	int end = start + filter->_group_size[g];
+	for (k0 = start; k0 < end; k0 += IIR_M_COEF_MAJOR_CHUNK_SIGNALS) {
+	    int m = end - k0;
+	    if (m > IIR_M_COEF_MAJOR_CHUNK_SIGNALS) {
+		m = IIR_M_COEF_MAJOR_CHUNK_SIGNALS;
+	    }
+	    int first = filter->_group_first[g] + (k0 - start);
+	    int span = _IIR_MG_GROUP_SPAN(m);
+	    memset(x_buf, 0, sizeof (IIR_signal_t) * span);
+	    for (f = 0; f < n_frames; f++) {
+		memcpy(x_buf, x + f*n_signals + first, sizeof (IIR_signal_t) * m);
+		filter->_kernel(n_coefs, stride,
+				filter->a + g*n_coefs, filter->b + g*n_coefs,
+				filter->z + k0, x_buf, y_buf, span);
+		memcpy(y + f*n_signals + first, y_buf, sizeof (IIR_signal_t) * m);
+	    }
+	}
+    }
+
+    for (f0 = 0; !filter->_in_order && (f0 < n_frames); f0 += IIR_MG_BLOCK_FRAMES) {
+	int n = n_frames - f0;
+	if (n > IIR_MG_BLOCK_FRAMES) {
+	    n = IIR_MG_BLOCK_FRAMES;
+	}
+
+	// Gather the frames (the padding positions are always zeros)
+	for (f = 0; f < n; f++) {
+	    const IIR_signal_t *x_f = x + (f0+f)*n_signals;
+	    IIR_signal_t *buf_f = filter->_x_buf + f*stride;
+	    for (k = 0; k < n_signals; k++) {
+		buf_f[position[k]] = x_f[k];
+	    }
+	}
+
+	// Filter them, leaving the outputs in their positions
+	for (g = 0; g < filter->n_groups; g++) {
+	    int end = filter->_group_start[g] + _IIR_MG_GROUP_SPAN(filter->_group_size[g]);
+	    for (k0 = filter->_group_start[g]; k0 < end; k0 += IIR_M_COEF_MAJOR_CHUNK_SIGNALS) {
+		int m = end - k0;
+		if (m > IIR_M_COEF_MAJOR_CHUNK_SIGNALS) {
+		    m = IIR_M_COEF_MAJOR_CHUNK_SIGNALS;
+		}
+		for (f = 0; f < n; f++) {
+		    IIR_signal_t *buf_f = filter->_x_buf + f*stride + k0;
+		    filter->_kernel(n_coefs, stride,
+				    filter->a + g*n_coefs, filter->b + g*n_coefs,
+				    filter->z + k0, buf_f, y_buf, m);
+		    memcpy(buf_f, y_buf, sizeof (IIR_signal_t) * m);
+		}
+	    }
+	}
+
+	// Scatter the outputs
+	for (f = 0; f < n; f++) {
+	    IIR_signal_t *y_f = y + (f0+f)*n_signals;
+	    const IIR_signal_t *buf_f = filter->_x_buf + f*stride;
+	    for (k = 0; k < n_signals; k++) {
+		y_f[k] = buf_f[position[k]];
+	    }
+	}
+    }
+
+    // Keep the last frame as last output
+    memcpy(filter->last_output, y + (n_frames-1)*n_signals, sizeof (IIR_signal_t) * n_signals);
+
+    return 1;
+}
+
+// Reset the filter to the resting state (states and last output to 0)
+inline void IIR_MG_reset(IIR_MG_t *filter) {
+
+    memset(filter->z, 0, sizeof (IIR_signal_t) * filter->n_coefs * filter->_padded_signals);
+    memset(filter->last_output, 0, sizeof (IIR_signal_t) * filter->n_signals);
+}
+
+// Returns a pointer to the last outputs for each signal (see
+// IIR_MS_get_last_output)
+#define IIR_MG_get_last_output(filter) (filter->last_output)
+
+// Copies the last outputs for each signal into y (n_signals size)
+#define IIR_MG_copy_last_output(filter, y) memcpy(y, (filter)->last_output, sizeof (IIR_signal_t) * (filter)->n_signals)
+
+// Convenience macros for reading the coefficients of signal s (i = coef
+// index). Use the set_coefs functions to change them.
+#define IIR_MG_COEFS_A_INDEX(filter, i, s) filter->a[filter->group[s]*filter->n_coefs + (i)]
+#define IIR_MG_COEFS_B_INDEX(filter, i, s) filter->b[filter->group[s]*filter->n_coefs + (i)]
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIR_MG_FILTERS_H */
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 5:10 AM
+ */
+
+// Multiple input signal filters with Variable orders (IIR_MV_t)
+// Each signal has its own coefs and its own number of coefs, so short
+// filters are not padded with zero coefs up to the longest one. Internally
+// the signals are bucketed by their number of coefs: each bucket is a
+// coefficient major IIR_MD_t filter (see IIR_M_LAYOUT_COEF_MAJOR), which
+// runs the vectorized kernel for its order. Inputs and outputs are in the
+// caller signals order, and outputs match bit by bit the ones of an IIR_S_t
+// filter for each signal. Transposed direct form II only.
+
+#ifndef IIR_MV_FILTERS_H
+#define IIR_MV_FILTERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "IIR_filters.h"
+
+// Type for the structure holding the variable orders multiple input signal
+// IIR filter
+typedef struct {
+    int n_signals;
+    int n_buckets;
+    IIR_MD_t **buckets;
+    int *bucket_n_signals;
+    int **bucket_signals;
+    IIR_signal_t *last_output;
+    int _max_bucket_signals;
+    IIR_signal_t *_x_buf;
+    IIR_signal_t *_y_buf;
+
+} IIR_MV_t;
+// Fields:
+//	buckets: one MD filter for each number of coefs (in increasing order)
+//	bucket_n_signals: number of signals of each bucket. Bucket filters
+//	    with IIR_SIMD_SIGNALS signals or more have a multiple of
+//	    IIR_SIMD_SIGNALS signals (the kernel never runs its tail): the
+//	    padding signals have the coefs of the last one and zero inputs,
+//	    so their states and outputs are zeros
+//	bucket_signals: signal index (caller order) of each signal of each
+//	    bucket: bucket_signals[bucket][bucket signal]
+
+// Free all the memory allocated by the filter
+inline void IIR_MV_destroy(IIR_MV_t *filter) {
+
+    int i;
+
+    for (i = 0; i < filter->n_buckets; i++) {
+	if (filter->buckets) {
+	    if (filter->buckets[i]) {
+		IIR_MD_destroy(filter->buckets[i]);
+	    }
+	}
+	if (filter->bucket_signals) {
+	    free(filter->bucket_signals[i]);
+	}
+    }
+    free(filter->buckets);
+    free(filter->bucket_n_signals);
+    free(filter->bucket_signals);
+    free(filter->last_output);
+    free(filter->_x_buf);
+    free(filter->_y_buf);
+    free(filter);
+}
+
+// Create a variable orders multiple input signal filter.
+// Parameters:
+//	n_signals: number of input signals
+//	n_coefs: number of coefficients (order+1) of each signal
+//	b_coefs, a_coefs: coefs of each signal (b_coefs[signal] and
+//	    a_coefs[signal] hold n_coefs[signal] values each). They are
+//	    normalized in the filter (see IIR_MD_set_coefs_table)
+// Returns:
+//    A filter structure initialized to rest state or NULL upon error
+//    (invalid parameters or memory allocation problem)
+inline IIR_MV_t *IIR_MV_create(int n_signals,
+			       const int *n_coefs,
+			       const IIR_signal_t *const b_coefs[],
+			       const IIR_signal_t *const a_coefs[]) {
+
+    int i, j, k;
+
+    if (n_signals <= 0) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a filter without or negative number of signals: %d.\n",
+		n_signals
+		);
+	return NULL;
+    }
+
+    if ( (!n_coefs) || (!b_coefs) || (!a_coefs) ) {
+	fprintf( stderr, "IIR ERROR: trying to create a variable orders filter without coefficients.\n" );
+	return NULL;
+    }
+
+    for (k = 0; k < n_signals; k++) {
+	if (n_coefs[k] <= 1) {
+	    fprintf(stderr,
+		    "IIR ERROR: trying to create a filter with not enough coefficients (%d) for signal %d. Min is 2.\n",
+		    n_coefs[k], k
+		    );
+	    return NULL;
+	}
+	if ( (!b_coefs[k]) || (!a_coefs[k]) ) {
+	    fprintf( stderr, "IIR ERROR: trying to create a variable orders filter without coefficients for signal %d.\n", k );
+	    return NULL;
+	}
+    }
+
+    IIR_MV_t *filter = (IIR_MV_t*) calloc(1, sizeof (IIR_MV_t));
+    if ( !filter ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	return NULL;
+    }
+    filter->n_signals = n_signals;
+
+    // Distinct numbers of coefs, in increasing order (there are a few, so
+    // a simple insertion is enough). bucket_n_coefs has room for all
+    int *bucket_n_coefs = (int*) malloc(sizeof (int) * n_signals);
+    int *bucket_size = (int*) calloc(n_signals, sizeof (int));
+    filter->last_output = (IIR_signal_t*) calloc(n_signals, sizeof (IIR_signal_t));
+    if ( !bucket_n_coefs || !bucket_size || !filter->last_output ) {
+	free(bucket_n_coefs);
+	free(bucket_size);
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	IIR_MV_destroy(filter);
+	return NULL;
+    }
+    int n_buckets = 0;
+    for (k = 0; k < n_signals; k++) {
+	for (i = 0; (i < n_buckets) && (bucket_n_coefs[i] < n_coefs[k]); i++);
+	if ( (i == n_buckets) || (bucket_n_coefs[i] != n_coefs[k]) ) {
+	    for (j = n_buckets; j > i; j--) {
+		bucket_n_coefs[j] = bucket_n_coefs[j-1];
+		bucket_size[j] = bucket_size[j-1];
+	    }
+	    bucket_n_coefs[i] = n_coefs[k];
+	    bucket_size[i] = 0;
+	    n_buckets++;
+	}
+	bucket_size[i]++;
+    }
+
+    filter->n_buckets = n_buckets;
+    filter->buckets = (IIR_MD_t**) calloc(n_buckets, sizeof (IIR_MD_t*));
+    filter->bucket_n_signals = (int*) malloc(sizeof (int) * n_buckets);
+    filter->bucket_signals = (int**) calloc(n_buckets, sizeof (int*));
+    int ok = (filter->buckets != NULL) && (filter->bucket_n_signals != NULL)
+	     && (filter->bucket_signals != NULL);
+
+    // Gather the coefs of each bucket in one table (padding signals
+    // included) and build its filter
+    for (i = 0; ok && (i < n_buckets); i++) {
+	int n = bucket_n_coefs[i];
+	int n_padded = (bucket_size[i] < IIR_SIMD_SIGNALS) ? bucket_size[i]
+		       : (bucket_size[i] + IIR_SIMD_SIGNALS - 1) / IIR_SIMD_SIGNALS * IIR_SIMD_SIGNALS;
+	IIR_signal_t *a_table = (IIR_signal_t*) malloc(sizeof (IIR_signal_t) * n * n_padded);
+	IIR_signal_t *b_table = (IIR_signal_t*) malloc(sizeof (IIR_signal_t) * n * n_padded);
+	filter->bucket_n_signals[i] = bucket_size[i];
+	filter->bucket_signals[i] = (int*) malloc(sizeof (int) * bucket_size[i]);
+	ok = (a_table != NULL) && (b_table != NULL) && (filter->bucket_signals[i] != NULL);
+	for (k = 0, j = 0; ok && (k < n_signals); k++) {
+	    if (n_coefs[k] == n) {
+		memcpy(a_table + j*n, a_coefs[k], sizeof (IIR_signal_t) * n);
+		memcpy(b_table + j*n, b_coefs[k], sizeof (IIR_signal_t) * n);
+		filter->bucket_signals[i][j++] = k;
+	    }
+	}
+	for (; ok && (j < n_padded); j++) {
+	    memcpy(a_table + j*n, a_table + (j-1)*n, sizeof (IIR_signal_t) * n);
+	    memcpy(b_table + j*n, b_table + (j-1)*n, sizeof (IIR_signal_t) * n);
+	}
+	if (ok) {
+	    filter->buckets[i] = IIR_MD_create_bank_layout(n, n_padded, b_table, a_table,
+							   IIR_M_LAYOUT_COEF_MAJOR);
+	    ok = (filter->buckets[i] != NULL);
+	}
+	if (n_padded > filter->_max_bucket_signals) {
+	    filter->_max_bucket_signals = n_padded;
+	}
+	free(a_table);
+	free(b_table);
+    }
+
+    free(bucket_n_coefs);
+    free(bucket_size);
+
+    if (ok) {
+	size_t buf_bytes = sizeof (IIR_signal_t) * filter->_max_bucket_signals;
+	filter->_x_buf = (IIR_signal_t*) _IIR_aligned_malloc(buf_bytes);
+	filter->_y_buf = (IIR_signal_t*) _IIR_aligned_malloc(buf_bytes);
+	ok = (filter->_x_buf != NULL) && (filter->_y_buf != NULL);
+    }
+
+    if ( !ok ) {
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	IIR_MV_destroy(filter);
+	return NULL;
+    }
+
+    return filter;
+}
+
+// Add the next input (x, one for each signal, so array of n_signals size)
+// to the filter and write the corresponding outputs to y (caller array of
+// n_signals size, not overlapping x), without storing them as the last
+// output of the filter (see IIR_MS_add_input_to)
+inline void IIR_MV_add_input_to(IIR_MV_t *filter, const IIR_signal_t x[], IIR_signal_t y[]) {
+
+    int i, k;
+
+    for (i = 0; i < filter->n_buckets; i++) {
+	IIR_MD_t *bucket = filter->buckets[i];
+	const int *signals = filter->bucket_signals[i];
+	int m = filter->bucket_n_signals[i];
+	for (k = 0; k < m; k++) {
+	    filter->_x_buf[k] = x[signals[k]];
+	}
+	for (; k < bucket->n_signals; k++) {
+	    filter->_x_buf[k] = 0;
+	}
+	IIR_MD_add_input_to(bucket, filter->_x_buf, filter->_y_buf);
+	for (k = 0; k < m; k++) {
+	    y[signals[k]] = filter->_y_buf[k];
+	}
+    }
+}
+
+// Add an input (one for each signal, so array of n_signals size) to the
+// filter and return a pointer to the corresponding outputs (last_output)
+inline IIR_signal_t *IIR_MV_add_input(IIR_MV_t *filter, const IIR_signal_t x[]) {
+
+    IIR_MV_add_input_to(filter, x, filter->last_output);
+
+    return filter->last_output;
+}
+
+// Filters n_frames frames (n_signals values each, stored one frame after
+// the other) from x and stores the corresponding frames in y (x and y can
+// be the same buffer). Same results as n_frames calls to IIR_MV_add_input.
+// As in IIR_MD_process_block, each bucket is filtered in chunks of
+// IIR_M_COEF_MAJOR_CHUNK_SIGNALS signals through the whole block, with the
+// inputs of each frame gathered to x_buf and the outputs scattered from
+// y_buf, so no memory is allocated.
+// Returns 0 on fail (NULL buffers or negative n_frames)
+inline int IIR_MV_process_block(IIR_MV_t *filter,
+				const IIR_signal_t *x,
+				IIR_signal_t *y,
+				int n_frames) {
+
+    int i, f, k, k0;
+    int n_signals = filter->n_signals;
+    IIR_signal_t x_buf[IIR_M_COEF_MAJOR_CHUNK_SIGNALS];
+    IIR_signal_t y_buf[IIR_M_COEF_MAJOR_CHUNK_SIGNALS];
+
+    if ( (n_frames < 0) || (!x) || (!y) ) {
+	return 0;
+    }
+
+    if ( n_frames == 0 ) {
+	return 1;
+    }
+
+    for (i = 0; i < filter->n_buckets; i++) {
+	IIR_MD_t *bucket = filter->buckets[i];
+	int n_bucket_signals = filter->bucket_n_signals[i];
+	for (k0 = 0; k0 < bucket->n_signals; k0 += IIR_M_COEF_MAJOR_CHUNK_SIGNALS) {
+	    int span = bucket->n_signals - k0;
+	    if (span > IIR_M_COEF_MAJOR_CHUNK_SIGNALS) {
+		span = IIR_M_COEF_MAJOR_CHUNK_SIGNALS;
+	    }
+	    // Signals of the chunk (the rest are padding signals)
+	    int m = n_bucket_signals - k0;
+	    if (m > span) {
+		m = span;
+	    }
+	    const int *signals = filter->bucket_signals[i] + k0;
+	    // Bucket signal indexes are increasing, so they are consecutive
+	    // if the last one is m-1 after the first one
+	    int first = (signals[m-1] - signals[0] == m-1) ? signals[0] : -1;
+	    memset(x_buf, 0, sizeof (IIR_signal_t) * span);
+	    for (f = 0; f < n_frames; f++) {
+		const IIR_signal_t *x_f = x + f*n_signals;
+		IIR_signal_t *y_f = y + f*n_signals;
+		if (first >= 0) {
+		    memcpy(x_buf, x_f + first, sizeof (IIR_signal_t) * m);
+		} else {
+		    for (k = 0; k < m; k++) {
+			x_buf[k] = x_f[signals[k]];
+		    }
+		}
+		_IIR_MD_coef_major_step(bucket, k0, span, x_buf, y_buf);
+		if (first >= 0) {
+		    memcpy(y_f + first, y_buf, sizeof (IIR_signal_t) * m);
+		} else {
+		    for (k = 0; k < m; k++) {
+			y_f[signals[k]] = y_buf[k];
+		    }
+		}
+	    }
+	}
+    }
+
+    // Keep the last frame as last output
+    memcpy(filter->last_output, y + (n_frames-1)*n_signals, sizeof (IIR_signal_t) * n_signals);
+
+    return 1;
+}
+
+// Reset the filter to the resting state (states and last output to 0)
+inline void IIR_MV_reset(IIR_MV_t *filter) {
+
+    int i;
+
+    for (i = 0; i < filter->n_buckets; i++) {
+	IIR_MD_reset(filter->buckets[i]);
+    }
+    memset(filter->last_output, 0, sizeof (IIR_signal_t) * filter->n_signals);
+}
+
+// Returns a pointer to the last outputs for each signal (see
+// IIR_MS_get_last_output)
+#define IIR_MV_get_last_output(filter) (filter->last_output)
+
+// Copies the last outputs for each signal into y (n_signals size)
+#define IIR_MV_copy_last_output(filter, y) memcpy(y, (filter)->last_output, sizeof (IIR_signal_t) * (filter)->n_signals)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIR_MV_FILTERS_H */
@@ -32,6 +32,19 @@ extern "C" {
 
 #include "IIR_filters.h"
 
+// Memory layouts for the state (z) of the multiple input signal filters
+// Signal major: the n_coefs states of each signal are contiguous
+//	z[signal*n_coefs + coef]
+// Coefficient major: the states of all the signals for each coef are
+// contiguous, with the signals padded to a multiple of IIR_SIMD_SIGNALS
+// (_padded_signals) and each row aligned to IIR_SIMD_ALIGNMENT bytes
+//	z[coef*_padded_signals + signal]
+// Each filter step is then one vector operation across all the signals
+// For MD filters the a and b coefs use the same layout as z (use the
+// IIR_MD_COEFS_A_INDEX/IIR_MD_COEFS_B_INDEX macros to access them)
+#define IIR_M_LAYOUT_SIGNAL_MAJOR 0
+#define IIR_M_LAYOUT_COEF_MAJOR 1
+
 // Type for the structure holding the multiple input signal IIR filter state
 // IIR_MS_t for Multiple input signals with Shared coefficients
 // IIR_MD_t for Multiple input signals with Different coefficients
@@ -43,9 +56,47 @@ typedef struct {
     IIR_signal_t *z;
     IIR_signal_t *last_output;
     int _element_byte_size;
+    int layout;
+    int _padded_signals;
+    int simd_level;
+    IIR_M_kernel_t _kernel;
+    int structure;
+    IIR_signal_t *_lattice;
+    IIR_step_kernel_t _step;
+    IIR_signal_t *_z_block;
+    int _capacity;
+    int _owns_block;
     
 } IIR_M_t, IIR_MS_t, IIR_MD_t;
 
+// The filter is one block of memory aligned to IIR_SIMD_ALIGNMENT bytes:
+// the IIR_M_t structure followed by the z, a, b and last_output arrays,
+// each one starting at an aligned address (so the coefficient major rows
+// are aligned too). _z_block is the z array of the block: structures
+// needing a bigger state (IIR_STRUCTURE_DF1) and the lattice coefs are
+// allocated apart.
+// The arrays have room for _capacity signals (_padded_signals at creation,
+// so the padding of the coefficient major layout is used by the first
+// added signals, grown by _IIR_M_reserve and _IIR_M_add_signal). _owns_block is 1 if the block
+// was allocated by the library (_IIR_M_create), so it can be reallocated.
+// Offset (bytes) of the z array in the block
+#define _IIR_M_BLOCK_Z_OFFSET _IIR_ALIGNED_SIZE(sizeof (IIR_M_t))
+// Size (bytes) of the z array, padded_signals being the number of signals
+// (padded to a multiple of IIR_SIMD_SIGNALS in coefficient major layout)
+#define _IIR_M_BLOCK_Z_SIZE(n_coefs, padded_signals) \
+    _IIR_ALIGNED_SIZE(sizeof (IIR_signal_t) * (n_coefs) * (padded_signals))
+// Size (bytes) of each one of the a and b arrays
+#define _IIR_M_BLOCK_COEFS_SIZE(n_coefs, padded_signals, different_coefs) \
+    _IIR_ALIGNED_SIZE(sizeof (IIR_signal_t) * (n_coefs) * ((different_coefs) ? (padded_signals) : 1))
+// Number of signals of the z (and MD coefs) arrays for the given layout
+#define _IIR_M_PADDED_SIGNALS(n_signals, layout) ( ((layout) == IIR_M_LAYOUT_COEF_MAJOR) ? \
+    ((n_signals) + IIR_SIMD_SIGNALS - 1) / IIR_SIMD_SIGNALS * IIR_SIMD_SIGNALS : (n_signals) )
+// Size (bytes) of the whole block
+#define _IIR_M_BLOCK_SIZE(n_coefs, n_signals, padded_signals, different_coefs) \
+    (_IIR_M_BLOCK_Z_OFFSET + _IIR_M_BLOCK_Z_SIZE(n_coefs, padded_signals) \
+     + 2 * _IIR_M_BLOCK_COEFS_SIZE(n_coefs, padded_signals, different_coefs) \
+     + _IIR_ALIGNED_SIZE(sizeof (IIR_signal_t) * (n_signals)))
+
 /******************************************************
  * Functions common to both (Shared/Different coefs) Multi signal IIRs
  ******************************************************/
@@ -65,6 +116,111 @@ inline int IIR_MS_set_coefs(IIR_MS_t* filter, int n_coefs, const IIR_signal_t *b
  *	
  */
 
+// Number of bytes needed to build a multiple input signal filter in caller
+// memory (see _IIR_M_init). Internal use, aliased for MS and MD filters.
+// Returns 0 if the parameters are not valid
+inline size_t _IIR_M_required_bytes(int n_coefs, int n_signals, int different_coefs, int layout) {
+
+    if ( (n_coefs <= 1) || (n_signals <= 0)
+	 || ((layout != IIR_M_LAYOUT_SIGNAL_MAJOR) && (layout != IIR_M_LAYOUT_COEF_MAJOR)) ) {
+	return 0;
+    }
+
+    // last_output has room for the padding signals too (see _capacity)
+    int padded_signals = _IIR_M_PADDED_SIGNALS(n_signals, layout);
+    return _IIR_M_BLOCK_SIZE(n_coefs, padded_signals, padded_signals, different_coefs);
+}
+
+// Build a multiple input signal IIR filter inside the caller memory
+// (buffer), without allocating memory nor printing anything. This function
+// builds both MS and MD filters (used by _IIR_M_create) and is aliased for
+// each filter type.
+// Parameters:
+//	buffer: _IIR_M_required_bytes(n_coefs, n_signals, different_coefs,
+//	    layout) bytes, aligned to IIR_SIMD_ALIGNMENT bytes. It holds the
+//	    whole filter
+//	n_coefs, n_signals, b_coefs, a_coefs, different_coefs, layout: see
+//	    _IIR_M_create
+// Returns:
+//    The filter (at the start of buffer), initialized to rest state, or
+//    NULL upon error (invalid parameters, NULL or misaligned buffer)
+// The environment is not read: the IIR_SIMD_LEVEL_ENV limit applies only if
+// the level was detected before (any filter created or
+// IIR_simd_detect_level called, see _IIR_simd_init_level).
+// Do not destroy it, but deinit it if other structures than
+// IIR_STRUCTURE_TDF2/IIR_STRUCTURE_DF2 were used (they allocate memory
+// apart from the buffer)
+inline IIR_M_t *_IIR_M_init(void *buffer,
+	int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs,
+	int different_coefs,
+	int layout) {
+
+    if ( !_IIR_M_required_bytes(n_coefs, n_signals, different_coefs, layout)
+	 || !buffer || ((size_t)buffer % IIR_SIMD_ALIGNMENT) ) {
+	return NULL;
+    }
+
+    // Signals are padded in coefficient major layout
+    int padded_signals = _IIR_M_PADDED_SIGNALS(n_signals, layout);
+
+    char *block = (char*) buffer;
+    IIR_M_t *filter = (IIR_M_t*) block;
+    filter->n_coefs = n_coefs;
+    filter->n_signals = n_signals;
+    filter->layout = layout;
+    filter->_padded_signals = padded_signals;
+    filter->_capacity = padded_signals;
+    filter->_owns_block = 0;
+
+    // Bind the best kernel for this CPU (used in coefficient major layout)
+    filter->simd_level = _IIR_simd_init_level();
+    filter->_kernel = _IIR_M_select_kernel(filter->simd_level, different_coefs);
+
+    // Transposed direct form II (see _IIR_M_set_structure)
+    filter->structure = IIR_STRUCTURE_TDF2;
+    filter->_lattice = NULL;
+    filter->_step = _IIR_step_tdf2_fast;
+   
+    int coefs_size = sizeof (IIR_signal_t) * n_coefs;
+    size_t z_block_size = _IIR_M_BLOCK_Z_SIZE(n_coefs, padded_signals);
+    size_t coefs_block_size = _IIR_M_BLOCK_COEFS_SIZE(n_coefs, padded_signals, different_coefs);
+    
+    // Zs are always one n_coefs size vector for each signal
+    // (plus the padding signals in coefficient major layout)
+    filter->z = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET);
+    filter->_z_block = filter->z;
+    memset(filter->z, 0, coefs_size * filter->_padded_signals);
+    
+    if (different_coefs) {
+	coefs_size *= filter->_padded_signals;
+    }
+
+    filter->a = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET + z_block_size);
+    filter->b = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET + z_block_size + coefs_block_size);
+    
+    // Initialize the arrays
+    memset(filter->a, 0, coefs_size);
+    memset(filter->b, 0, coefs_size);    
+    
+    filter->_element_byte_size = sizeof (IIR_signal_t) * n_signals;
+    filter->last_output = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET + z_block_size + 2*coefs_block_size);
+    // Initialize the output (although not yet valid!)
+    memset(filter->last_output, 0, filter->_element_byte_size);
+
+    // Fill the coefficients if provided    
+    if ( (a_coefs) && (b_coefs) ){
+	if (different_coefs) {
+	    IIR_MD_set_coefs_all_signals(filter, filter->n_coefs, b_coefs, a_coefs);
+	} else {
+	    IIR_MS_set_coefs(filter, filter->n_coefs, b_coefs, a_coefs);
+	}
+    }
+
+    return filter;
+}
+
 // Create a multiple input signal IIR filter.
 // This function creates both MS and MD filters and is not supposed to be called
 // directly by the user but to be used internally. It is very similar to the 
@@ -83,13 +239,15 @@ inline int IIR_MS_set_coefs(IIR_MS_t* filter, int n_coefs, const IIR_signal_t *b
 //			 b0s1, b1s1,...,b<n_coefs-1>s1,...,
 //			 b0s<n_signals-1>, b1s<n_signals-1>,...,b<n_coefs-1>s<n_signals-1>
 //	different_coefs: 0 for MS creation (shared coefs) or 1 for MD creation (different coefs)
+//	layout: IIR_M_LAYOUT_SIGNAL_MAJOR or IIR_M_LAYOUT_COEF_MAJOR (see above)
 // Returns:
 //    A filter structure initialized to rest state or NULL upon error
 //    (memory allocation problem)
 inline IIR_M_t *_IIR_M_create(int n_coefs, int n_signals,
 	const IIR_signal_t *b_coefs,
 	const IIR_signal_t *a_coefs,
-	int different_coefs) {
+	int different_coefs,
+	int layout) {
 
     // Check the number of coefs. Minimum is order 1, which means two coefs
     if (n_coefs <= 1) {
@@ -109,57 +267,26 @@ inline IIR_M_t *_IIR_M_create(int n_coefs, int n_signals,
 	return NULL;
     }    
 
-    IIR_M_t *filter = (IIR_M_t*) malloc(sizeof (IIR_M_t));
-    if ( !filter ){
-	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
-	return NULL;
-    }    
-    
-    filter->n_coefs = n_coefs;
-    filter->n_signals = n_signals;
-   
-    int coefs_size = sizeof (IIR_signal_t) * n_coefs;
-    
-    // Zs are always one n_coefs size vector for each signal
-    filter->z = (IIR_signal_t*) malloc(coefs_size * n_signals);    
-    if ( !filter->z ){
-	free( filter );
-	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter z array.\n" );
+    // Check the layout
+    if ( (layout != IIR_M_LAYOUT_SIGNAL_MAJOR) && (layout != IIR_M_LAYOUT_COEF_MAJOR) ) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a filter with an unsupported layout: %d.\n",
+		layout
+		);
 	return NULL;
     }
-    memset(filter->z, 0, coefs_size * n_signals);
-    
-    if (different_coefs) {
-	coefs_size *= n_signals;
-    }
-
-    filter->a = (IIR_signal_t*) malloc(coefs_size);    
-    filter->b = (IIR_signal_t*) malloc(coefs_size);
 
-    if ( !filter->a || !filter->b ){
-	free( filter->z );
-	free( filter );
-	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter a or b.\n" );
+    // One block for the structure and the z, a, b and last_output arrays
+    void *block = _IIR_aligned_malloc( _IIR_M_required_bytes(n_coefs, n_signals, different_coefs, layout) );
+    if ( !block ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
 	return NULL;
-    }
-    
-    // Initialize the arrays
-    memset(filter->a, 0, coefs_size);
-    memset(filter->b, 0, coefs_size);    
-    
-    filter->_element_byte_size = sizeof (IIR_signal_t) * n_signals;
-    filter->last_output = (IIR_signal_t*) malloc(filter->_element_byte_size);
-    // Initialize the output (although not yet valid!)
-    memset(filter->last_output, 0, filter->_element_byte_size);
+    }    
 
-    // Fill the coefficients if provided    
-    if ( (a_coefs) && (b_coefs) ){
-	if (different_coefs) {
-	    IIR_MD_set_coefs_all_signals(filter, filter->n_coefs, b_coefs, a_coefs);
-	} else {
-	    IIR_MS_set_coefs(filter, filter->n_coefs, b_coefs, a_coefs);
-	}
-    }
+    // Detect the kernels level (reading IIR_SIMD_LEVEL_ENV) for _IIR_M_init
+    IIR_simd_detect_level();
+    IIR_M_t *filter = _IIR_M_init(block, n_coefs, n_signals, b_coefs, a_coefs, different_coefs, layout);
+    filter->_owns_block = 1;
 
     return filter;
 }
@@ -183,34 +310,802 @@ inline IIR_signal_t *_IIR_M_get_last_output_copy( IIR_M_t *filter ){
     return result;
 }
 
-// Return a copy of the filter output (or NULL if memory allocation problem)
-#define IIR_MS_get_last_output_copy(filter) _IIR_M_get_last_output_copy(filter)
-#define IIR_MD_get_last_output_copy(filter) _IIR_M_get_last_output_copy(filter)
+// Copy the last outputs of the filter (n_signals values) to y (caller array),
+// without allocating memory. Same for MS and MD, aliased with a macro for
+// each filter type
+inline void _IIR_M_copy_last_output( const IIR_M_t *filter, IIR_signal_t *y ){
+
+    memcpy( y, filter->last_output, sizeof(IIR_signal_t)*filter->n_signals );
+}
+
+#define IIR_MS_copy_last_output(filter, y) _IIR_M_copy_last_output(filter, y)
+#define IIR_MD_copy_last_output(filter, y) _IIR_M_copy_last_output(filter, y)
+
+// Return a copy of the filter output (or NULL if memory allocation problem)
+#define IIR_MS_get_last_output_copy(filter) _IIR_M_get_last_output_copy(filter)
+#define IIR_MD_get_last_output_copy(filter) _IIR_M_get_last_output_copy(filter)
+
+// Return the pointer to the filter output
+#define IIR_MS_get_last_output(filter) (filter->last_output)
+#define IIR_MD_get_last_output(filter) (filter->last_output)
+
+// Select the instruction set level (IIR_SIMD_LEVEL_*) of the kernel used by
+// the filter, overriding the one detected at creation. Intended for tests and
+// benchmarks. Internal use, aliased with a macro for each filter type.
+// different_coefs: 0 for MS filters or 1 for MD filters
+// Returns 0 on fail (level not supported by the CPU or not compiled in), 1
+// otherwise
+inline int _IIR_M_set_simd_level(IIR_M_t *filter, int level, int different_coefs) {
+
+    if ( (level < IIR_SIMD_LEVEL_SCALAR) || (level > IIR_simd_cpu_level()) ) {
+	return 0;
+    }
+
+    filter->simd_level = level;
+    filter->_kernel = _IIR_M_select_kernel(level, different_coefs);
+
+    return 1;
+}
+
+#define IIR_MS_set_simd_level(filter, level) _IIR_M_set_simd_level(filter, level, 0)
+#define IIR_MD_set_simd_level(filter, level) _IIR_M_set_simd_level(filter, level, 1)
+
+// Number of signals filtered together by _IIR_M_process_block
+// The recursions of different signals are independent, so interleaving a few
+// of them keeps the floating point units busy while each signal waits for
+// its previous output
+#define IIR_M_BLOCK_SIGNALS 8
+
+// Filter n_frames frames with the step kernel of a structure other than
+// IIR_STRUCTURE_TDF2 (signal major layout only). Internal use.
+// Same input/output addressing as _IIR_M_process_strided, or planar
+// addressing (x[signal][frame], y[signal][frame]) if x_planar and y_planar
+// are given (then x and y are ignored). Signals are filtered in groups of
+// IIR_M_BLOCK_SIGNALS as in _IIR_M_process_block, with the same operations
+// as the S filters with the same structure.
+// coefs_stride: offset between the coefs of consecutive signals (0 for
+//	shared coefs, n_coefs for different coefs)
+// store_last_output: 1 to copy the last frame of y to last_output, 0 to
+//	leave last_output as it is (see IIR_MS_add_input_to)
+inline void _IIR_M_structure_process(IIR_M_t *filter,
+				     const IIR_signal_t *x,
+				     int x_frame_stride,
+				     int x_signal_stride,
+				     IIR_signal_t *y,
+				     int y_frame_stride,
+				     int y_signal_stride,
+				     const IIR_signal_t *const x_planar[],
+				     IIR_signal_t *const y_planar[],
+				     int n_frames,
+				     int coefs_stride,
+				     int store_last_output) {
+
+    int i, k, k0, k1;
+    int n_coefs = filter->n_coefs;
+    int n_signals = filter->n_signals;
+    int state_size = _IIR_STRUCTURE_STATE_SIZE(n_coefs, filter->structure);
+    IIR_step_kernel_t step = filter->_step;
+    IIR_signal_t *z = filter->z;
+    const IIR_signal_t *a = filter->a;
+    const IIR_signal_t *b = filter->b;
+
+    // Lattice structure: k and v coefs instead of a and b
+    if (filter->_lattice) {
+	a = filter->_lattice;
+	b = filter->_lattice + n_coefs;
+	coefs_stride = coefs_stride ? _IIR_LATTICE_COEFS_SIZE(n_coefs) : 0;
+    }
+
+    for (k0=0; k0<n_signals; k0+=IIR_M_BLOCK_SIGNALS){
+	k1 = k0 + IIR_M_BLOCK_SIGNALS;
+	if (k1 > n_signals){
+	    k1 = n_signals;
+	}
+
+	for (i=0; i<n_frames; i++){
+	    for (k=k0; k<k1; k++){
+		IIR_signal_t x_k = x_planar ? x_planar[k][i]
+				   : x[i*x_frame_stride + k*x_signal_stride];
+		IIR_signal_t y_k = step(n_coefs, a + k*coefs_stride, b + k*coefs_stride,
+					z + k*state_size, x_k);
+		if (y_planar) {
+		    y_planar[k][i] = y_k;
+		} else {
+		    y[i*y_frame_stride + k*y_signal_stride] = y_k;
+		}
+	    }
+	}
+    }
+
+    for (k=0; store_last_output && (k<n_signals); k++){
+	filter->last_output[k] = y_planar ? y_planar[k][n_frames-1]
+			: y[(n_frames-1)*y_frame_stride + k*y_signal_stride];
+    }
+}
+
+// Filter a block of n_frames frames for all the signals.
+// This is a common function for both M filters used internally. It is
+// wrapped by IIR_MS_process_block and IIR_MD_process_block.
+// x and y hold n_frames interleaved frames of n_signals values each:
+//	x[frame*n_signals + signal]
+// Signals are filtered in groups of IIR_M_BLOCK_SIGNALS through the whole
+// block, so the state (and coefficients) of each group are loaded once and
+// stay in cache instead of streaming the whole state array once per frame.
+// Outputs are the same (bit by bit) as n_frames calls to the add_input
+// functions, and last_output is set to the last frame of y.
+// y can be the same array as x (in-place filtering): each value is read
+// before its output is written and no other value is read afterwards.
+// coefs_stride: offset between the coefs of consecutive signals (0 for
+//	shared coefs, n_coefs for different coefs)
+inline int _IIR_M_process_block(IIR_M_t *filter,
+				const IIR_signal_t *x,
+				IIR_signal_t *y,
+				int n_frames,
+				int coefs_stride) {
+
+    int i, k, k0, k1;
+
+    if ( (!x) || (!y) || (n_frames < 0) ) {
+	return 0;
+    }
+
+    if ( n_frames == 0 ) {
+	return 1;
+    }
+
+    int n_coefs = filter->n_coefs;
+    int n_signals = filter->n_signals;
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_M_structure_process(filter, x, n_signals, 1, y, n_signals, 1,
+				 NULL, NULL, n_frames, coefs_stride, 1);
+	return 1;
+    }
+
+    IIR_signal_t *z = filter->z;
+    const IIR_signal_t *a = filter->a;
+    const IIR_signal_t *b = filter->b;
+
+    for (k0=0; k0<n_signals; k0+=IIR_M_BLOCK_SIGNALS){
+	k1 = k0 + IIR_M_BLOCK_SIGNALS;
+	if (k1 > n_signals){
+	    k1 = n_signals;
+	}
+
+	const IIR_signal_t *x_i = x;
+	IIR_signal_t *y_i = y;
+
+	for (i=0; i<n_frames; i++){
+	    for (k=k0; k<k1; k++){
+		IIR_signal_t *z_k = z + k*n_coefs;
+		const IIR_signal_t *a_k = a + k*coefs_stride;
+		const IIR_signal_t *b_k = b + k*coefs_stride;
+		IIR_signal_t x_k = x_i[k];
+		IIR_signal_t y_k = _IIR_step_tdf2_fast(n_coefs, a_k, b_k, z_k, x_k);
+
+		y_i[k] = y_k;
+	    }
+	    x_i += n_signals;
+	    y_i += n_signals;
+	}
+    }
+
+    memcpy( filter->last_output, y + (n_frames-1)*n_signals, sizeof(IIR_signal_t) * n_signals );
+
+    return 1;
+}
+
+// Filter a block of n inputs for all the signals, with planar (one buffer
+// per signal) inputs and outputs.
+// This is a common function for both M filters used internally. It is
+// wrapped by IIR_MS_process_planar and IIR_MD_process_planar.
+// x and y are arrays of n_signals pointers, each one pointing to a buffer of
+// n values for the corresponding signal. Each signal is then a sequential
+// scan and no transposition to frames is needed.
+// y[k] can be the same buffer as x[k] (in-place filtering).
+// As in _IIR_M_process_block, signals are filtered in groups of
+// IIR_M_BLOCK_SIGNALS and outputs match the add_input functions bit by bit.
+// coefs_stride: offset between the coefs of consecutive signals (0 for
+//	shared coefs, n_coefs for different coefs)
+inline int _IIR_M_process_planar(IIR_M_t *filter,
+				 const IIR_signal_t *const x[],
+				 IIR_signal_t *const y[],
+				 int n,
+				 int coefs_stride) {
+
+    int i, k, k0, k1;
+
+    if ( (!x) || (!y) || (n < 0) ) {
+	return 0;
+    }
+
+    if ( n == 0 ) {
+	return 1;
+    }
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_M_structure_process(filter, NULL, 0, 0, NULL, 0, 0, x, y, n, coefs_stride, 1);
+	return 1;
+    }
+
+    int n_coefs = filter->n_coefs;
+    int n_signals = filter->n_signals;
+    IIR_signal_t *z = filter->z;
+    const IIR_signal_t *a = filter->a;
+    const IIR_signal_t *b = filter->b;
+
+    for (k0=0; k0<n_signals; k0+=IIR_M_BLOCK_SIGNALS){
+	k1 = k0 + IIR_M_BLOCK_SIGNALS;
+	if (k1 > n_signals){
+	    k1 = n_signals;
+	}
+
+	for (i=0; i<n; i++){
+	    for (k=k0; k<k1; k++){
+		IIR_signal_t *z_k = z + k*n_coefs;
+		const IIR_signal_t *a_k = a + k*coefs_stride;
+		const IIR_signal_t *b_k = b + k*coefs_stride;
+		IIR_signal_t x_k = x[k][i];
+		IIR_signal_t y_k = _IIR_step_tdf2_fast(n_coefs, a_k, b_k, z_k, x_k);
+
+		y[k][i] = y_k;
+	    }
+	}
+    }
+
+    for (k=0; k<n_signals; k++){
+	filter->last_output[k] = y[k][n-1];
+    }
+
+    return 1;
+}
+
+// Filter a block of n_frames frames for all the signals, with arbitrary
+// strides (in number of values, not bytes) for inputs and outputs.
+// This is a common function for both M filters used internally. It is
+// wrapped by IIR_MS_process_strided and IIR_MD_process_strided.
+// The value for signal k in frame i is read from
+//	x[i*x_frame_stride + k*x_signal_stride]
+// and its output is written to
+//	y[i*y_frame_stride + k*y_signal_stride]
+// Interleaved frames are x_frame_stride = n_signals, x_signal_stride = 1 and
+// planar buffers (base + channel stride) are x_frame_stride = 1,
+// x_signal_stride = <channel stride>. Packed interleaved frames use
+// _IIR_M_process_block directly.
+// In-place filtering (y == x) is supported when the x and y strides match.
+// coefs_stride: offset between the coefs of consecutive signals (0 for
+//	shared coefs, n_coefs for different coefs)
+inline int _IIR_M_process_strided(IIR_M_t *filter,
+				  const IIR_signal_t *x,
+				  int x_frame_stride,
+				  int x_signal_stride,
+				  IIR_signal_t *y,
+				  int y_frame_stride,
+				  int y_signal_stride,
+				  int n_frames,
+				  int coefs_stride) {
+
+    int i, k, k0, k1;
+    int n_signals = filter->n_signals;
+
+    if ( (x_frame_stride == n_signals) && (x_signal_stride == 1)
+	 && (y_frame_stride == n_signals) && (y_signal_stride == 1) ) {
+	return _IIR_M_process_block(filter, x, y, n_frames, coefs_stride);
+    }
+
+    if ( (!x) || (!y) || (n_frames < 0) ) {
+	return 0;
+    }
+
+    if ( n_frames == 0 ) {
+	return 1;
+    }
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_M_structure_process(filter,
+				 x, x_frame_stride, x_signal_stride,
+				 y, y_frame_stride, y_signal_stride,
+				 NULL, NULL, n_frames, coefs_stride, 1);
+	return 1;
+    }
+
+    int n_coefs = filter->n_coefs;
+    IIR_signal_t *z = filter->z;
+    const IIR_signal_t *a = filter->a;
+    const IIR_signal_t *b = filter->b;
+
+    for (k0=0; k0<n_signals; k0+=IIR_M_BLOCK_SIGNALS){
+	k1 = k0 + IIR_M_BLOCK_SIGNALS;
+	if (k1 > n_signals){
+	    k1 = n_signals;
+	}
+
+	const IIR_signal_t *x_i = x;
+	IIR_signal_t *y_i = y;
+
+	for (i=0; i<n_frames; i++){
+	    for (k=k0; k<k1; k++){
+		IIR_signal_t *z_k = z + k*n_coefs;
+		const IIR_signal_t *a_k = a + k*coefs_stride;
+		const IIR_signal_t *b_k = b + k*coefs_stride;
+		IIR_signal_t x_k = x_i[k*x_signal_stride];
+		IIR_signal_t y_k = _IIR_step_tdf2_fast(n_coefs, a_k, b_k, z_k, x_k);
+
+		y_i[k*y_signal_stride] = y_k;
+	    }
+	    x_i += x_frame_stride;
+	    y_i += y_frame_stride;
+	}
+    }
+
+    y += (n_frames-1)*y_frame_stride;
+    for (k=0; k<n_signals; k++){
+	filter->last_output[k] = y[k*y_signal_stride];
+    }
+
+    return 1;
+}
+
+// Number of signals processed together by the coefficient major kernels.
+// Their states (n_coefs rows of this many values) stay in cache for a whole
+// block of frames. Must be a multiple of IIR_SIMD_SIGNALS
+#define IIR_M_COEF_MAJOR_CHUNK_SIGNALS (8*IIR_SIMD_SIGNALS)
+
+// One filter step for signals k0 to k0+m-1 of a coefficient major MS filter.
+// Internal use. x holds the m inputs and y receives the m outputs (x and y
+// must not overlap). Uses the kernel selected for the filter (see
+// IIR_simd_kernels.h), which does the same operations for each signal as
+// IIR_MS_add_input so results match bit by bit.
+inline void _IIR_MS_coef_major_step(IIR_MS_t *filter, int k0, int m,
+				    const IIR_signal_t *IIR_RESTRICT x,
+				    IIR_signal_t *IIR_RESTRICT y) {
+
+    filter->_kernel(filter->n_coefs, filter->_padded_signals,
+		    filter->a, filter->b, filter->z + k0, x, y, m);
+}
+
+// Same as _IIR_MS_coef_major_step but for coefficient major MD filters,
+// where the a and b coefs are also rows across signals
+inline void _IIR_MD_coef_major_step(IIR_MD_t *filter, int k0, int m,
+				    const IIR_signal_t *IIR_RESTRICT x,
+				    IIR_signal_t *IIR_RESTRICT y) {
+
+    filter->_kernel(filter->n_coefs, filter->_padded_signals,
+		    filter->a + k0, filter->b + k0, filter->z + k0, x, y, m);
+}
+
+// Filter n_frames frames with a coefficient major filter. Internal use.
+// Same input/output addressing as _IIR_M_process_strided, or planar
+// addressing (x[signal][frame], y[signal][frame]) if x_planar and y_planar
+// are given (then x and y are ignored).
+// Signals are processed in chunks of IIR_M_COEF_MAJOR_CHUNK_SIGNALS through
+// the whole block. The inputs of each frame are copied to a contiguous
+// buffer, so in-place filtering is supported.
+// different_coefs: 0 for MS filters or 1 for MD filters
+inline int _IIR_M_coef_major_process(IIR_M_t *filter,
+				     const IIR_signal_t *x,
+				     int x_frame_stride,
+				     int x_signal_stride,
+				     IIR_signal_t *y,
+				     int y_frame_stride,
+				     int y_signal_stride,
+				     const IIR_signal_t *const x_planar[],
+				     IIR_signal_t *const y_planar[],
+				     int n_frames,
+				     int different_coefs) {
+
+    int i, k, k0, m;
+    int n_signals = filter->n_signals;
+    IIR_signal_t x_buf[IIR_M_COEF_MAJOR_CHUNK_SIGNALS];
+    IIR_signal_t y_buf[IIR_M_COEF_MAJOR_CHUNK_SIGNALS];
+
+    if ( (n_frames < 0) || ((!x_planar || !y_planar) && (!x || !y)) ) {
+	return 0;
+    }
+
+    if ( n_frames == 0 ) {
+	return 1;
+    }
+
+    for (k0=0; k0<n_signals; k0+=IIR_M_COEF_MAJOR_CHUNK_SIGNALS){
+	m = n_signals - k0;
+	if (m > IIR_M_COEF_MAJOR_CHUNK_SIGNALS){
+	    m = IIR_M_COEF_MAJOR_CHUNK_SIGNALS;
+	}
+
+	for (i=0; i<n_frames; i++){
+	    // Gather the inputs
+	    if (x_planar) {
+		for (k=0; k<m; k++){
+		    x_buf[k] = x_planar[k0+k][i];
+		}
+	    } else if (x_signal_stride == 1) {
+		memcpy( x_buf, x + i*x_frame_stride + k0, sizeof(IIR_signal_t) * m );
+	    } else {
+		const IIR_signal_t *x_i = x + i*x_frame_stride + k0*x_signal_stride;
+		for (k=0; k<m; k++){
+		    x_buf[k] = x_i[k*x_signal_stride];
+		}
+	    }
+
+	    // Filter, writing directly to y if it is contiguous
+	    IIR_signal_t *y_dest = y_buf;
+	    if ( !y_planar && (y_signal_stride == 1) ) {
+		y_dest = y + i*y_frame_stride + k0;
+	    }
+	    if (different_coefs) {
+		_IIR_MD_coef_major_step(filter, k0, m, x_buf, y_dest);
+	    } else {
+		_IIR_MS_coef_major_step(filter, k0, m, x_buf, y_dest);
+	    }
+
+	    if (y_dest == y_buf) {
+		if (y_planar) {
+		    for (k=0; k<m; k++){
+			y_planar[k0+k][i] = y_buf[k];
+		    }
+		} else {
+		    IIR_signal_t *y_i = y + i*y_frame_stride + k0*y_signal_stride;
+		    for (k=0; k<m; k++){
+			y_i[k*y_signal_stride] = y_buf[k];
+		    }
+		}
+	    }
+	}
+    }
+
+    // Keep the last frame as last output
+    for (k=0; k<n_signals; k++){
+	filter->last_output[k] = y_planar ? y_planar[k][n_frames-1]
+			: y[(n_frames-1)*y_frame_stride + k*y_signal_stride];
+    }
+
+    return 1;
+}
+
+// Reset the filter to the resting state
+// Just return all previous states and last output to 0
+// This one is a common function for both M filters used internally.
+// It is aliased with two names, one for each MS and MD filters
+inline void _IIR_M_reset(IIR_M_t *f) {
+    memset( f->z, 0, sizeof(IIR_signal_t) * _IIR_STRUCTURE_STATE_SIZE(f->n_coefs, f->structure) * f->_padded_signals );
+    memset( f->last_output, 0, sizeof(IIR_signal_t) * f->n_signals );
+}
+
+// Free the memory allocated by the filter apart from its block (state of
+// IIR_STRUCTURE_DF1 and lattice coefs), but not the block. For filters
+// built with _IIR_M_init: the caller owns the buffer. Internal use,
+// aliased later for both MS and MD
+inline void _IIR_M_deinit(IIR_M_t *filter) {
+
+    if (filter->z != filter->_z_block) {
+	free(filter->z);
+    }
+    free(filter->_lattice);
+    filter->z = filter->_z_block;
+    filter->_lattice = NULL;
+}
+
+// Free all the memory allocated by the filter. Internal use, aliased later
+// for both MS and MD
+inline void _IIR_M_destroy(IIR_M_t *filter) {
+
+    _IIR_M_deinit(filter);
+    // The z, a, b and last_output arrays are in the same block
+    free(filter);
+}
+
+// Compute the lattice coefs (see IIR_structures.h) of signals k0 to k1-1
+// (k0 = 0 and k1 = 1 for MS filters) into lattice. Signal major layout only.
+// Internal use.
+// Returns 0 if any of the signals has no lattice form (unstable filter), 1
+// otherwise
+inline int _IIR_M_lattice_coefs(IIR_M_t *filter, IIR_signal_t *lattice, int k0, int k1) {
+
+    int k;
+    int ok = 1;
+    int n_coefs = filter->n_coefs;
+
+    for (k=k0; k<k1; k++){
+	ok = _IIR_lattice_coefs(n_coefs, filter->b + k*n_coefs, filter->a + k*n_coefs,
+				lattice + k*_IIR_LATTICE_COEFS_SIZE(n_coefs)) && ok;
+    }
+
+    return ok;
+}
+
+// Select the filter structure (IIR_STRUCTURE_*, see IIR_structures.h). Only
+// the signal major layout supports structures other than
+// IIR_STRUCTURE_TDF2. The state is reset (its size and meaning depend on
+// the structure). For the lattice structure, the lattice coefs are computed
+// from the current coefs and recomputed by the set_coefs functions (but not
+// if the coefs are written directly). Internal use, aliased with a macro for
+// each filter type.
+// different_coefs: 0 for MS filters or 1 for MD filters
+// Returns 0 on fail (unknown structure, coefficient major layout, lattice
+// structure of an unstable filter or memory allocation problem; the filter
+// is left unchanged), 1 otherwise
+inline int _IIR_M_set_structure(IIR_M_t *filter, int structure, int different_coefs) {
+
+    int n_coefs = filter->n_coefs;
+    IIR_step_kernel_t step = _IIR_select_step_kernel(structure);
+
+    if ( !step ){
+	fprintf( stderr, "IIR ERROR: trying to set an unsupported filter structure: %d.\n", structure );
+	return 0;
+    }
+
+    if ( (filter->layout != IIR_M_LAYOUT_SIGNAL_MAJOR) && (structure != IIR_STRUCTURE_TDF2) ) {
+	fprintf( stderr, "IIR ERROR: filter structures other than TDF2 need the signal major layout.\n" );
+	return 0;
+    }
+
+    // The state is kept in the filter block if it fits
+    size_t state_size = sizeof (IIR_signal_t) * _IIR_STRUCTURE_STATE_SIZE(n_coefs, structure) * filter->_padded_signals;
+    int n_lattices = different_coefs ? filter->n_signals : 1;
+    int lattice_capacity = different_coefs ? filter->_capacity : 1;
+    int z_in_block = _IIR_STRUCTURE_STATE_SIZE(n_coefs, structure) <= n_coefs;
+    IIR_signal_t *z = z_in_block ? filter->_z_block : (IIR_signal_t*) malloc( state_size );
+    IIR_signal_t *lattice = NULL;
+    if (structure == IIR_STRUCTURE_LATTICE) {
+	lattice = (IIR_signal_t*) malloc( sizeof (IIR_signal_t) * _IIR_LATTICE_COEFS_SIZE(n_coefs) * lattice_capacity );
+    }
+    if ( !z || ((structure == IIR_STRUCTURE_LATTICE) && !lattice) ){
+	if ( !z_in_block ){
+	    free( z );
+	}
+	free( lattice );
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for the filter structure.\n" );
+	return 0;
+    }
+    if ( lattice && !_IIR_M_lattice_coefs(filter, lattice, 0, n_lattices) ){
+	if ( !z_in_block ){
+	    free( z );
+	}
+	free( lattice );
+	fprintf( stderr, "IIR ERROR: the filter has no lattice structure (it is not stable).\n" );
+	return 0;
+    }
+
+    memset( z, 0, state_size );
+    if ( filter->z != filter->_z_block ){
+	free( filter->z );
+    }
+    free( filter->_lattice );
+    filter->z = z;
+    filter->_lattice = lattice;
+    filter->_step = step;
+    filter->structure = structure;
+    memset( filter->last_output, 0, sizeof(IIR_signal_t) * filter->n_signals );
+
+    return 1;
+}
+
+#define IIR_MS_set_structure(filter, structure) _IIR_M_set_structure(filter, structure, 0)
+#define IIR_MD_set_structure(filter, structure) _IIR_M_set_structure(filter, structure, 1)
+
+// Copy (src != NULL) or clear (src == NULL) the state, coefs (MD filters),
+// lattice coefs (MD filters) and last output of signal k_src into signal
+// k_dst. Internal use by _IIR_M_add_signal and _IIR_M_remove_signal
+inline void _IIR_M_move_signal(IIR_M_t *filter, int k_dst, const IIR_M_t *src, int k_src,
+			       int different_coefs) {
+
+    int i;
+    int n_coefs = filter->n_coefs;
+    int state_size = _IIR_STRUCTURE_STATE_SIZE(n_coefs, filter->structure);
+    int lattice_size = _IIR_LATTICE_COEFS_SIZE(n_coefs);
+    int stride = filter->_padded_signals;
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	// One value in each row (only IIR_STRUCTURE_TDF2, state_size == n_coefs)
+	for (i=0; i<n_coefs; i++){
+	    filter->z[i*stride + k_dst] = src ? src->z[i*stride + k_src] : 0;
+	    if (different_coefs) {
+		filter->a[i*stride + k_dst] = src ? src->a[i*stride + k_src] : 0;
+		filter->b[i*stride + k_dst] = src ? src->b[i*stride + k_src] : 0;
+	    }
+	}
+    } else if (src) {
+	memcpy( filter->z + k_dst*state_size, src->z + k_src*state_size, sizeof (IIR_signal_t) * state_size );
+	if (different_coefs) {
+	    memcpy( filter->a + k_dst*n_coefs, src->a + k_src*n_coefs, sizeof (IIR_signal_t) * n_coefs );
+	    memcpy( filter->b + k_dst*n_coefs, src->b + k_src*n_coefs, sizeof (IIR_signal_t) * n_coefs );
+	}
+	if (different_coefs && filter->_lattice) {
+	    memcpy( filter->_lattice + k_dst*lattice_size, src->_lattice + k_src*lattice_size,
+		    sizeof (IIR_signal_t) * lattice_size );
+	}
+    } else {
+	memset( filter->z + k_dst*state_size, 0, sizeof (IIR_signal_t) * state_size );
+	if (different_coefs) {
+	    memset( filter->a + k_dst*n_coefs, 0, sizeof (IIR_signal_t) * n_coefs );
+	    memset( filter->b + k_dst*n_coefs, 0, sizeof (IIR_signal_t) * n_coefs );
+	}
+	if (different_coefs && filter->_lattice) {
+	    memset( filter->_lattice + k_dst*lattice_size, 0, sizeof (IIR_signal_t) * lattice_size );
+	}
+    }
+
+    filter->last_output[k_dst] = src ? src->last_output[k_src] : 0;
+}
+
+// Make room for capacity signals (rounded up to a multiple of
+// IIR_SIMD_SIGNALS in coefficient major layout), so that signals can be
+// added without reallocating memory (see _IIR_M_add_signal). The filter block is
+// reallocated (the filter moves) and the state, coefs and last output of
+// every signal are kept. Internal use, aliased with a macro for each
+// filter type.
+// different_coefs: 0 for MS filters or 1 for MD filters
+// Returns:
+//    The filter (the same one if it already had room for capacity signals,
+//    a new one otherwise: the old pointer is no longer valid), or NULL upon
+//    error (filter built with _IIR_M_init, memory allocation problem). On
+//    error the filter is left unchanged and valid
+inline IIR_M_t *_IIR_M_reserve(IIR_M_t *filter, int capacity, int different_coefs) {
+
+    int i;
+    int n_coefs = filter->n_coefs;
+    int n_signals = filter->n_signals;
+    int layout = filter->layout;
+
+    if (capacity <= filter->_capacity) {
+	return filter;
+    }
+
+    if ( !filter->_owns_block ) {
+	fprintf( stderr, "IIR ERROR: a filter built in caller memory can not grow over %d signals.\n",
+		 filter->_capacity );
+	return NULL;
+    }
+
+    // The padding of the coefficient major layout is part of the capacity
+    capacity = _IIR_M_PADDED_SIGNALS(capacity, layout);
+    int padded_signals = capacity;
+    int state_size = _IIR_STRUCTURE_STATE_SIZE(n_coefs, filter->structure);
+    int z_in_block = (filter->z == filter->_z_block);
+    int n_lattices = different_coefs ? n_signals : 1;
+    size_t lattice_bytes = sizeof (IIR_signal_t) * _IIR_LATTICE_COEFS_SIZE(n_coefs);
+
+    // Allocate everything before changing anything
+    size_t block_size = _IIR_M_BLOCK_SIZE(n_coefs, capacity, padded_signals, different_coefs);
+    char *block = (char*) _IIR_aligned_malloc( block_size );
+    IIR_signal_t *z = z_in_block ? NULL
+	: (IIR_signal_t*) malloc( sizeof (IIR_signal_t) * state_size * padded_signals );
+    IIR_signal_t *lattice = filter->_lattice;
+    if ( filter->_lattice && different_coefs ) {
+	lattice = (IIR_signal_t*) malloc( lattice_bytes * capacity );
+    }
+    if ( !block || (!z_in_block && !z) || (filter->_lattice && !lattice) ) {
+	free( block );
+	free( z );
+	if ( lattice != filter->_lattice ) {
+	    free( lattice );
+	}
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for %d filter signals.\n", capacity );
+	return NULL;
+    }
+
+    size_t z_block_size = _IIR_M_BLOCK_Z_SIZE(n_coefs, padded_signals);
+    size_t coefs_block_size = _IIR_M_BLOCK_COEFS_SIZE(n_coefs, padded_signals, different_coefs);
+    IIR_M_t *new_filter = (IIR_M_t*) block;
+    *new_filter = *filter;
+    new_filter->_padded_signals = padded_signals;
+    new_filter->_capacity = capacity;
+    new_filter->_z_block = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET);
+    new_filter->z = z_in_block ? new_filter->_z_block : z;
+    new_filter->a = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET + z_block_size);
+    new_filter->b = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET + z_block_size + coefs_block_size);
+    new_filter->last_output = (IIR_signal_t*) (block + _IIR_M_BLOCK_Z_OFFSET + z_block_size + 2*coefs_block_size);
+    new_filter->_lattice = lattice;
+    memset( block + _IIR_M_BLOCK_Z_OFFSET, 0, block_size - _IIR_M_BLOCK_Z_OFFSET );
+    if ( !z_in_block ) {
+	memset( z, 0, sizeof (IIR_signal_t) * state_size * padded_signals );
+    }
+
+    // Copy the arrays (the coefficient major rows get longer)
+    if (layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	for (i=0; i<n_coefs; i++){
+	    memcpy( new_filter->z + i*padded_signals, filter->z + i*filter->_padded_signals,
+		    sizeof (IIR_signal_t) * n_signals );
+	    if (different_coefs) {
+		memcpy( new_filter->a + i*padded_signals, filter->a + i*filter->_padded_signals,
+			sizeof (IIR_signal_t) * n_signals );
+		memcpy( new_filter->b + i*padded_signals, filter->b + i*filter->_padded_signals,
+			sizeof (IIR_signal_t) * n_signals );
+	    }
+	}
+    } else {
+	memcpy( new_filter->z, filter->z, sizeof (IIR_signal_t) * state_size * n_signals );
+	if (different_coefs) {
+	    memcpy( new_filter->a, filter->a, sizeof (IIR_signal_t) * n_coefs * n_signals );
+	    memcpy( new_filter->b, filter->b, sizeof (IIR_signal_t) * n_coefs * n_signals );
+	}
+    }
+    if (!different_coefs) {
+	memcpy( new_filter->a, filter->a, sizeof (IIR_signal_t) * n_coefs );
+	memcpy( new_filter->b, filter->b, sizeof (IIR_signal_t) * n_coefs );
+    }
+    if ( lattice != filter->_lattice ) {
+	memcpy( lattice, filter->_lattice, lattice_bytes * n_lattices );
+    }
+    memcpy( new_filter->last_output, filter->last_output, sizeof (IIR_signal_t) * n_signals );
+
+    // Free the old memory
+    if ( lattice != filter->_lattice ) {
+	free( filter->_lattice );
+    }
+    if ( !z_in_block ) {
+	free( filter->z );
+    }
+    free( filter );
+
+    return new_filter;
+}
+
+// Add one signal (at index n_signals) to the filter, at rest and keeping
+// the state of the other signals. If there is no room for it, the capacity
+// is doubled (see _IIR_M_reserve), so adding signals one by one takes
+// amortized constant time. The processing functions never allocate memory.
+// For MD filters the coefs of the new signal are 0s (the output is 0 until
+// they are set). Internal use, aliased with a macro for each filter type.
+// different_coefs: 0 for MS filters or 1 for MD filters
+// Returns:
+//    The filter (it moves if it had to grow: the old pointer is no longer
+//    valid), or NULL upon error (see _IIR_M_reserve). On error the filter is
+//    left unchanged and valid
+inline IIR_M_t *_IIR_M_add_signal(IIR_M_t *filter, int different_coefs) {
 
-// Return the pointer to the filter output
-#define IIR_MS_get_last_output(filter) (filter->last_output)
-#define IIR_MD_get_last_output(filter) (filter->last_output)
+    if (filter->n_signals == filter->_capacity) {
+	IIR_M_t *new_filter = _IIR_M_reserve(filter, 2*filter->_capacity, different_coefs);
+	if ( !new_filter ) {
+	    return NULL;
+	}
+	filter = new_filter;
+    }
 
-// Reset the filter to the resting state
-// Just return all previous states and last output to 0
-// This one is a common function for both M filters used internally.
-// It is aliased with two names, one for each MS and MD filters
-inline void _IIR_M_reset(IIR_M_t *f) {
-    memset( f->z, 0, sizeof(IIR_signal_t) * f->n_coefs * f->n_signals );
-    memset( f->last_output, 0, sizeof(IIR_signal_t) * f->n_signals );
+    _IIR_M_move_signal(filter, filter->n_signals, NULL, 0, different_coefs);
+    filter->n_signals++;
+    filter->_element_byte_size = sizeof (IIR_signal_t) * filter->n_signals;
+
+    return filter;
 }
 
-// Free all the memory allocated by the filter. Internal use, aliased later
-// for both MS and MD
-inline void _IIR_M_destroy(IIR_M_t *filter) {
+// Remove signal k from the filter, without allocating memory nor moving
+// the filter. The last signal takes its place, keeping its state (and
+// coefs), so the signal indexes change: the last signal becomes signal k.
+// Internal use, aliased with a macro for each filter type.
+// different_coefs: 0 for MS filters or 1 for MD filters
+// Returns 0 on fail (k out of bounds or k is the only signal), 1 otherwise
+inline int _IIR_M_remove_signal(IIR_M_t *filter, int k, int different_coefs) {
 
-    free(filter->a);
-    free(filter->b);
-    free(filter->last_output);
-    free(filter->z);
-    free(filter);
+    int last = filter->n_signals - 1;
+
+    if ( (k < 0) || (k > last) ) {
+	fprintf( stderr, "IIR ERROR: trying to remove a filter signal out of bounds: %d.\n", k );
+	return 0;
+    }
+
+    if (last == 0) {
+	fprintf( stderr, "IIR ERROR: trying to remove the only signal of a filter.\n" );
+	return 0;
+    }
+
+    if (k != last) {
+	_IIR_M_move_signal(filter, k, filter, last, different_coefs);
+    }
+    _IIR_M_move_signal(filter, last, NULL, 0, different_coefs);
+    filter->n_signals--;
+    filter->_element_byte_size = sizeof (IIR_signal_t) * filter->n_signals;
+
+    return 1;
 }
 
+#define IIR_MS_reserve(filter, capacity) _IIR_M_reserve(filter, capacity, 0)
+#define IIR_MD_reserve(filter, capacity) _IIR_M_reserve(filter, capacity, 1)
+#define IIR_MS_add_signal(filter) _IIR_M_add_signal(filter, 0)
+#define IIR_MS_remove_signal(filter, k) _IIR_M_remove_signal(filter, k, 0)
+#define IIR_MD_remove_signal(filter, k) _IIR_M_remove_signal(filter, k, 1)
+
 /******************************************************
  * Functions specific to Shared coefs Multi signal IIRs
  ******************************************************/
@@ -226,7 +1121,73 @@ inline IIR_MS_t *IIR_MS_create(int n_coefs, int n_signals,
 	const IIR_signal_t *b_coefs,
 	const IIR_signal_t *a_coefs) {
 
-    return _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 0);
+    return _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 0, IIR_M_LAYOUT_SIGNAL_MAJOR);
+}
+
+// Same as IIR_MS_create but choosing the memory layout of the filter state
+// layout: IIR_M_LAYOUT_SIGNAL_MAJOR (same as IIR_MS_create) or
+//	IIR_M_LAYOUT_COEF_MAJOR (vectorized across signals, see IIR_M_t)
+// The layout does not change the results (nor the rest of the API), only
+// the speed and the organization of the z array.
+inline IIR_MS_t *IIR_MS_create_layout(int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs,
+	int layout) {
+
+    return _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 0, layout);
+}
+
+// Number of bytes needed to build an MS filter in caller memory with
+// IIR_MS_init (same filter as IIR_MS_create). Returns 0 if the parameters are not
+// valid
+inline size_t IIR_MS_required_bytes(int n_coefs, int n_signals) {
+
+    return _IIR_M_required_bytes(n_coefs, n_signals, 0, IIR_M_LAYOUT_SIGNAL_MAJOR);
+}
+
+// Same as IIR_MS_required_bytes for the given layout (see IIR_MS_init_layout)
+inline size_t IIR_MS_required_bytes_layout(int n_coefs, int n_signals, int layout) {
+
+    return _IIR_M_required_bytes(n_coefs, n_signals, 0, layout);
+}
+
+// Same as IIR_MS_create, but the filter is built inside buffer
+// (IIR_MS_required_bytes bytes aligned to IIR_SIMD_ALIGNMENT), without
+// allocating memory nor printing anything. See _IIR_M_init.
+// Returns NULL upon error. Do not destroy the filter (see IIR_MS_deinit)
+inline IIR_MS_t *IIR_MS_init(void *buffer, int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs) {
+
+    return _IIR_M_init(buffer, n_coefs, n_signals, b_coefs, a_coefs, 0, IIR_M_LAYOUT_SIGNAL_MAJOR);
+}
+
+// Same as IIR_MS_init with the given layout (see IIR_MS_create_layout).
+// buffer must hold IIR_MS_required_bytes_layout bytes
+inline IIR_MS_t *IIR_MS_init_layout(void *buffer, int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs,
+	int layout) {
+
+    return _IIR_M_init(buffer, n_coefs, n_signals, b_coefs, a_coefs, 0, layout);
+}
+
+// Same as IIR_MS_create but with the given filter structure (see
+// _IIR_M_set_structure). Signal major layout.
+// Returns NULL upon error
+inline IIR_MS_t *IIR_MS_create_structure(int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs,
+	int structure) {
+
+    IIR_MS_t *filter = _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 0, IIR_M_LAYOUT_SIGNAL_MAJOR);
+
+    if ( filter && !IIR_MS_set_structure(filter, structure) ){
+	_IIR_M_destroy(filter);
+	return NULL;
+    }
+
+    return filter;
 }
 
 // Fills in the a and/or b coefficients of the filter
@@ -253,35 +1214,163 @@ inline int IIR_MS_set_coefs(IIR_MS_t* filter,
     
     IIR_normalize_coefs( n_coefs, filter->b, filter->a );
 
+    if (filter->_lattice) {
+	return _IIR_M_lattice_coefs(filter, filter->_lattice, 0, 1);
+    }
+
     return 1;
 }
 
-// Add the next input (x) to the filter and return the corresponding output
-// x is an array of size n_signals.
-// HUGE gain by declaring this as inline!
-inline IIR_signal_t *IIR_MS_add_input(IIR_MS_t *filter, const IIR_signal_t x[]) {
+// Add the next input (x) to the filter and write the corresponding outputs
+// to y (caller array), without storing them as the last output of the
+// filter (IIR_MS_get_last_output is not updated) nor allocating memory.
+// x and y are arrays of size n_signals and must not overlap.
+inline void IIR_MS_add_input_to(IIR_MS_t *filter, const IIR_signal_t x[], IIR_signal_t y[]) {
     
-    int j, k;
-    
-    IIR_signal_t *y = filter->last_output;
+    int k;
+
+    // Coefficient major layout: vectorized across signals, one chunk at a time
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	for (k=0; k<filter->n_signals; k+=IIR_M_COEF_MAJOR_CHUNK_SIGNALS){
+	    int m = filter->n_signals - k;
+	    if (m > IIR_M_COEF_MAJOR_CHUNK_SIGNALS){
+		m = IIR_M_COEF_MAJOR_CHUNK_SIGNALS;
+	    }
+	    _IIR_MS_coef_major_step(filter, k, m, x + k, y + k);
+	}
+	return;
+    }
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_M_structure_process(filter, x, filter->n_signals, 1, y, filter->n_signals, 1,
+				 NULL, NULL, 1, 0, 0);
+	return;
+    }
+
     IIR_signal_t *z = filter->z;
     IIR_signal_t *a = filter->a;
     IIR_signal_t *b = filter->b;
     
     int n_coefs = filter->n_coefs;
     int n_signals = filter->n_signals;
-    
-    for (k=0; k<n_signals; k++){    
-	y[k] = z[k*n_coefs] + b[0] * x[k];
 
-	for (j = 1; j< n_coefs-1 ; j++){
-	    z[k*n_coefs+(j-1)] = z[k*n_coefs+j] + x[k] * b[j] - y[k] * a[j];
+    // Unrolled for order 1 to 4 filters (see _IIR_step_tdf2_fast), with the
+    // shared coefs in local copies so that the stores to y (which could
+    // alias them) do not reload them for every signal
+    if (n_coefs <= 5) {
+	IIR_signal_t a_local[5], b_local[5];
+	memcpy(a_local, a, sizeof (IIR_signal_t) * n_coefs);
+	memcpy(b_local, b, sizeof (IIR_signal_t) * n_coefs);
+	switch (n_coefs) {
+	    case 2:
+		for (k=0; k<n_signals; k++){
+		    y[k] = _IIR_step_tdf2_2(a_local, b_local, z + 2*k, x[k]);
+		}
+		return;
+	    case 3:
+		for (k=0; k<n_signals; k++){
+		    y[k] = _IIR_step_tdf2_3(a_local, b_local, z + 3*k, x[k]);
+		}
+		return;
+	    case 4:
+		for (k=0; k<n_signals; k++){
+		    y[k] = _IIR_step_tdf2_4(a_local, b_local, z + 4*k, x[k]);
+		}
+		return;
+	    case 5:
+		for (k=0; k<n_signals; k++){
+		    y[k] = _IIR_step_tdf2_5(a_local, b_local, z + 5*k, x[k]);
+		}
+		return;
 	}
-	z[k*n_coefs+(j-1)] = x[k] * b[j] - y[k] * a[j];
     }
+
+    for (k=0; k<n_signals; k++){    
+	y[k] = _IIR_step_tdf2(n_coefs, a, b, z + k*n_coefs, x[k]);
+    }
+}
+
+// Add the next input (x) to the filter and return the corresponding output
+// x is an array of size n_signals.
+// HUGE gain by declaring this as inline!
+inline IIR_signal_t *IIR_MS_add_input(IIR_MS_t *filter, const IIR_signal_t x[]) {
     
-    return y;
+    IIR_MS_add_input_to(filter, x, filter->last_output);
     
+    return filter->last_output;
+}
+
+// Filter a block of n_frames frames (x) and store the outputs in y.
+// x and y are arrays of size n_frames*n_signals, with the frames stored
+// one after the other (x[frame*n_signals + signal]).
+// Returns 0 on fail (NULL arrays or negative n_frames), 1 otherwise
+inline int IIR_MS_process_block(IIR_MS_t *filter,
+				const IIR_signal_t *x,
+				IIR_signal_t *y,
+				int n_frames) {
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	return _IIR_M_coef_major_process(filter,
+					 x, filter->n_signals, 1,
+					 y, filter->n_signals, 1,
+					 NULL, NULL, n_frames, 0);
+    }
+
+    return _IIR_M_process_block(filter, x, y, n_frames, 0);
+}
+
+// Filter a block of n_frames frames in place: each value in xy (frames
+// stored one after the other) is replaced by the corresponding output.
+// Returns 0 on fail (NULL array or negative n_frames), 1 otherwise
+inline int IIR_MS_process_in_place(IIR_MS_t *filter, IIR_signal_t *xy, int n_frames) {
+
+    return IIR_MS_process_block(filter, xy, xy, n_frames);
+}
+
+// Filter a block of n inputs for each signal, with one input buffer and
+// one output buffer per signal (planar layout).
+// x and y are arrays of n_signals pointers to buffers of n values each.
+// Returns 0 on fail (NULL arrays or negative n), 1 otherwise
+inline int IIR_MS_process_planar(IIR_MS_t *filter,
+				 const IIR_signal_t *const x[],
+				 IIR_signal_t *const y[],
+				 int n) {
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	if ( (!x) || (!y) ) {
+	    return 0;
+	}
+	return _IIR_M_coef_major_process(filter, NULL, 0, 0, NULL, 0, 0, x, y, n, 0);
+    }
+
+    return _IIR_M_process_planar(filter, x, y, n, 0);
+}
+
+// Filter a block of n_frames frames with arbitrary input and output strides
+// (in number of values, not bytes). The input for signal k in frame i is
+// x[i*x_frame_stride + k*x_signal_stride] (same for y).
+// See _IIR_M_process_strided for details.
+// Returns 0 on fail (NULL arrays or negative n_frames), 1 otherwise
+inline int IIR_MS_process_strided(IIR_MS_t *filter,
+				  const IIR_signal_t *x,
+				  int x_frame_stride,
+				  int x_signal_stride,
+				  IIR_signal_t *y,
+				  int y_frame_stride,
+				  int y_signal_stride,
+				  int n_frames) {
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	return _IIR_M_coef_major_process(filter,
+					 x, x_frame_stride, x_signal_stride,
+					 y, y_frame_stride, y_signal_stride,
+					 NULL, NULL, n_frames, 0);
+    }
+
+    return _IIR_M_process_strided(filter,
+				  x, x_frame_stride, x_signal_stride,
+				  y, y_frame_stride, y_signal_stride,
+				  n_frames, 0);
 }
 
 // Reset the filter to the resting state
@@ -290,6 +1379,10 @@ inline IIR_signal_t *IIR_MS_add_input(IIR_MS_t *filter, const IIR_signal_t x[])
 // Free all the memory allocated by the MS filter.
 #define IIR_MS_destroy(filter) _IIR_M_destroy(filter)
 
+// Free the memory allocated apart from the filter block by an MS filter
+// built with IIR_MS_init (see _IIR_M_deinit). The caller owns the buffer.
+#define IIR_MS_deinit(filter) _IIR_M_deinit(filter)
+
 /******************************************************
  * Functions specific to Different coefs Multi signal IIRs
  ******************************************************/
@@ -299,8 +1392,11 @@ inline IIR_signal_t *IIR_MS_add_input(IIR_MS_t *filter, const IIR_signal_t x[])
 // They use two indexes:
 //	i = coef index
 //	s = signal index
-#define IIR_MD_COEFS_A_INDEX(filter, i, s) filter->a[filter->n_coefs*s + i]
-#define IIR_MD_COEFS_B_INDEX(filter, i, s) filter->b[filter->n_coefs*s + i]
+// They take care of the filter layout (see IIR_M_t)
+#define _IIR_MD_COEFS_INDEX(filter, i, s) ( ((filter)->layout == IIR_M_LAYOUT_COEF_MAJOR) ? \
+	(filter)->_padded_signals*(i) + (s) : (filter)->n_coefs*(s) + (i) )
+#define IIR_MD_COEFS_A_INDEX(filter, i, s) filter->a[_IIR_MD_COEFS_INDEX(filter, i, s)]
+#define IIR_MD_COEFS_B_INDEX(filter, i, s) filter->b[_IIR_MD_COEFS_INDEX(filter, i, s)]
 
 // Just a call to the general creation for multi signal IIR
 // See the _IIR_MS_create function doc
@@ -308,7 +1404,95 @@ inline IIR_MD_t *IIR_MD_create(int n_coefs, int n_signals,
 	const IIR_signal_t *b_coefs,
 	const IIR_signal_t *a_coefs) {
 
-    return _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 1);
+    return _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 1, IIR_M_LAYOUT_SIGNAL_MAJOR);
+}
+
+// Same as IIR_MD_create but choosing the memory layout of the filter state
+// and coefficients (see IIR_MS_create_layout). The coefs passed as parameter
+// are always contiguous for each signal (as in IIR_MD_create). In
+// coefficient major layout they are scattered to [coef][signal] internally.
+inline IIR_MD_t *IIR_MD_create_layout(int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs,
+	int layout) {
+
+    return _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 1, layout);
+}
+
+// Number of bytes needed to build an MD filter in caller memory with
+// IIR_MD_init (same filter as IIR_MD_create). Returns 0 if the parameters are not
+// valid
+inline size_t IIR_MD_required_bytes(int n_coefs, int n_signals) {
+
+    return _IIR_M_required_bytes(n_coefs, n_signals, 1, IIR_M_LAYOUT_SIGNAL_MAJOR);
+}
+
+// Same as IIR_MD_required_bytes for the given layout (see IIR_MD_init_layout)
+inline size_t IIR_MD_required_bytes_layout(int n_coefs, int n_signals, int layout) {
+
+    return _IIR_M_required_bytes(n_coefs, n_signals, 1, layout);
+}
+
+// Same as IIR_MD_create, but the filter is built inside buffer
+// (IIR_MD_required_bytes bytes aligned to IIR_SIMD_ALIGNMENT), without
+// allocating memory nor printing anything. See _IIR_M_init.
+// Returns NULL upon error. Do not destroy the filter (see IIR_MD_deinit)
+inline IIR_MD_t *IIR_MD_init(void *buffer, int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs) {
+
+    return _IIR_M_init(buffer, n_coefs, n_signals, b_coefs, a_coefs, 1, IIR_M_LAYOUT_SIGNAL_MAJOR);
+}
+
+// Same as IIR_MD_init with the given layout (see IIR_MD_create_layout).
+// buffer must hold IIR_MD_required_bytes_layout bytes
+inline IIR_MD_t *IIR_MD_init_layout(void *buffer, int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs,
+	int layout) {
+
+    return _IIR_M_init(buffer, n_coefs, n_signals, b_coefs, a_coefs, 1, layout);
+}
+
+// Same as IIR_MD_create but with the given filter structure (see
+// _IIR_M_set_structure). Signal major layout.
+// Returns NULL upon error
+inline IIR_MD_t *IIR_MD_create_structure(int n_coefs, int n_signals,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs,
+	int structure) {
+
+    IIR_MD_t *filter = _IIR_M_create(n_coefs, n_signals, b_coefs, a_coefs, 1, IIR_M_LAYOUT_SIGNAL_MAJOR);
+
+    if ( filter && !IIR_MD_set_structure(filter, structure) ){
+	_IIR_M_destroy(filter);
+	return NULL;
+    }
+
+    return filter;
+}
+
+// Copy and normalize one set of a and b coefs to the coefs of one signal of
+// a coefficient major MD filter. Internal use.
+// The normalization is the same as in IIR_normalize_coefs (coefs are left
+// as they are if a[0] == 0)
+inline void _IIR_MD_coef_major_set_coefs(IIR_MD_t* filter,
+					 const IIR_signal_t *b_coefs,
+					 const IIR_signal_t *a_coefs,
+					 int signal_index) {
+    int i;
+    int stride = filter->_padded_signals;
+    IIR_signal_t a0 = a_coefs[0];
+
+    for (i = 0; i < filter->n_coefs; i++) {
+	if (a0 == 0) {
+	    filter->a[i*stride + signal_index] = a_coefs[i];
+	    filter->b[i*stride + signal_index] = b_coefs[i];
+	} else {
+	    filter->a[i*stride + signal_index] = a_coefs[i]/a0;
+	    filter->b[i*stride + signal_index] = b_coefs[i]/a0;
+	}
+    }
 }
 
 // Fills in the a and/or b coefficients of the filter but only for one given
@@ -336,6 +1520,11 @@ inline int IIR_MD_set_coefs_one_signal(IIR_MD_t* filter,
 	return 0;
     }
 
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	_IIR_MD_coef_major_set_coefs(filter, b_coefs, a_coefs, signal_index);
+	return 1;
+    }
+
     int n_bytes_coefs = n_coefs * sizeof (IIR_signal_t);
     
     IIR_signal_t *a_base = filter->a + n_coefs*signal_index;
@@ -346,6 +1535,10 @@ inline int IIR_MD_set_coefs_one_signal(IIR_MD_t* filter,
         
     IIR_normalize_coefs( n_coefs, b_base, a_base );
 
+    if (filter->_lattice) {
+	return _IIR_M_lattice_coefs(filter, filter->_lattice, signal_index, signal_index+1);
+    }
+
     return 1;
 }
 
@@ -372,6 +1565,21 @@ inline int IIR_MD_set_coefs_all_signals(IIR_MD_t* filter,
     int n_bytes_coefs = n_coefs * sizeof (IIR_signal_t);
     int n_signals = filter->n_signals;
 
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	// Set the first signal and copy each coef to the rest of its row
+	_IIR_MD_coef_major_set_coefs(filter, b_coefs, a_coefs, 0);
+	for ( i=0; i< n_coefs; i++){
+	    IIR_signal_t *a_row = filter->a + i*filter->_padded_signals;
+	    IIR_signal_t *b_row = filter->b + i*filter->_padded_signals;
+	    int k;
+	    for ( k=1; k< n_signals; k++){
+		a_row[k] = a_row[0];
+		b_row[k] = b_row[0];
+	    }
+	}
+	return 1;
+    }
+
     // Make pointers to the normalized coefs
     IIR_signal_t *a_norm = filter->a;
     IIR_signal_t *b_norm = filter->b;
@@ -391,18 +1599,177 @@ inline int IIR_MD_set_coefs_all_signals(IIR_MD_t* filter,
 	a_base += n_coefs;
 	b_base += n_coefs;
     }
+
+    if (filter->_lattice) {
+	return _IIR_M_lattice_coefs(filter, filter->_lattice, 0, n_signals);
+    }
     
     return 1;
 }
 
-// Add the next input (x) to the filter and return the corresponding output
-// x is an array of size n_signals.
-// HUGE gain by declaring this as inline!
-inline IIR_signal_t *IIR_MD_add_input(IIR_MD_t *filter, const IIR_signal_t x[]) {
-    
-    int j, k;
+// Fills in the a and b coefficients of all the signals of an MD filter from
+// a table with one set of coefs for each signal (a_table/b_table:
+// [n_signals][n_coefs], that is, contiguous for each signal as in
+// _IIR_M_create). The table can be any memory (i.e. an mmap'd file).
+// Each row is normalized (as in IIR_normalize_coefs: rows with a[0] == 0
+// are left as they are) while it is written in the filter layout, in one
+// pass over the table. Same coefficients as IIR_MD_set_coefs_one_signal
+// for each signal, without its per signal copies and normalizations.
+// Returns 0 on fail (given number of coefs does not agree with filters coefs
+// or any of the tables == NULL)
+inline int IIR_MD_set_coefs_table(IIR_MD_t* filter,
+				  int n_coefs,
+				  const IIR_signal_t *b_table,
+				  const IIR_signal_t *a_table) {
+
+    int i, k;
+
+    if ( (n_coefs != filter->n_coefs) || (!a_table) || (!b_table) ) {
+
+	return 0;
+    }
+
+    int n_signals = filter->n_signals;
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	// Transpose to [coef][signal], reading the table rows in order (one
+	// column of the filter arrays for each row)
+	int stride = filter->_padded_signals;
+	IIR_signal_t *IIR_RESTRICT a_col = filter->a;
+	IIR_signal_t *IIR_RESTRICT b_col = filter->b;
+	for (k = 0; k < n_signals; k++) {
+	    const IIR_signal_t *a_row = a_table + k*n_coefs;
+	    const IIR_signal_t *b_row = b_table + k*n_coefs;
+	    IIR_signal_t d = (a_row[0] == 0) ? 1 : a_row[0];
+	    for (i = 0; i < n_coefs; i++) {
+		a_col[i*stride + k] = a_row[i]/d;
+		b_col[i*stride + k] = b_row[i]/d;
+	    }
+	}
+	return 1;
+    }
+
+    IIR_signal_t *IIR_RESTRICT a_base = filter->a;
+    IIR_signal_t *IIR_RESTRICT b_base = filter->b;
+
+    for (k = 0; k < n_signals; k++) {
+	const IIR_signal_t *a_row = a_table + k*n_coefs;
+	const IIR_signal_t *b_row = b_table + k*n_coefs;
+	IIR_signal_t d = (a_row[0] == 0) ? 1 : a_row[0];
+	for (i = 0; i < n_coefs; i++) {
+	    a_base[i] = a_row[i]/d;
+	    b_base[i] = b_row[i]/d;
+	}
+	a_base += n_coefs;
+	b_base += n_coefs;
+    }
+
+    if (filter->_lattice) {
+	return _IIR_M_lattice_coefs(filter, filter->_lattice, 0, n_signals);
+    }
+
+    return 1;
+}
+
+// Create a bank of n_signals filters (an MD filter) from a coefficient
+// table (see IIR_MD_set_coefs_table), with the chosen layout. The filter
+// is allocated and its coefficients are written in their final layout at
+// once, instead of IIR_MD_create plus one IIR_MD_set_coefs_one_signal for
+// each signal.
+// Returns NULL upon error
+inline IIR_MD_t *IIR_MD_create_bank_layout(int n_coefs, int n_signals,
+	const IIR_signal_t *b_table,
+	const IIR_signal_t *a_table,
+	int layout) {
+
+    if ( (!a_table) || (!b_table) ) {
+	fprintf( stderr, "IIR ERROR: trying to create a filter bank without a coefficient table.\n" );
+	return NULL;
+    }
+
+    IIR_MD_t *filter = _IIR_M_create(n_coefs, n_signals, NULL, NULL, 1, layout);
+
+    if ( filter && !IIR_MD_set_coefs_table(filter, n_coefs, b_table, a_table) ){
+	fprintf( stderr, "IIR ERROR: unable to set the coefficients of the filter bank.\n" );
+	_IIR_M_destroy(filter);
+	return NULL;
+    }
+
+    return filter;
+}
+
+// Same as IIR_MD_create_bank_layout in signal major layout
+inline IIR_MD_t *IIR_MD_create_bank(int n_coefs, int n_signals,
+	const IIR_signal_t *b_table,
+	const IIR_signal_t *a_table) {
+
+    return IIR_MD_create_bank_layout(n_coefs, n_signals, b_table, a_table, IIR_M_LAYOUT_SIGNAL_MAJOR);
+}
+
+// Add one signal (the last one, index n_signals-1 after the call) to the
+// filter with the given coefs (n_coefs values each, normalized as in
+// IIR_MD_set_coefs_one_signal), keeping the state of the other signals.
+// The coefs can be NULL to leave them as 0s. See _IIR_M_add_signal.
+// Returns the filter (it moves if it had to grow) or NULL upon error
+// (wrong number of coefs, no lattice structure for the new coefs with
+// IIR_STRUCTURE_LATTICE (unstable filter), see _IIR_M_reserve); on error
+// the filter is left unchanged and valid
+inline IIR_MD_t *IIR_MD_add_signal(IIR_MD_t *filter, int n_coefs,
+	const IIR_signal_t *b_coefs,
+	const IIR_signal_t *a_coefs) {
+
+    if (n_coefs != filter->n_coefs) {
+	fprintf( stderr, "IIR ERROR: the new signal has %d coefs instead of %d.\n", n_coefs, filter->n_coefs );
+	return NULL;
+    }
+
+    // Check the lattice coefs before adding the signal: once added (and the
+    // filter maybe moved) setting its coefs must not fail
+    if ( filter->_lattice && a_coefs && b_coefs ) {
+	IIR_signal_t *lattice = (IIR_signal_t*) malloc( sizeof (IIR_signal_t) * _IIR_LATTICE_COEFS_SIZE(n_coefs) );
+	int ok = lattice && _IIR_lattice_coefs(n_coefs, b_coefs, a_coefs, lattice);
+	free( lattice );
+	if ( !ok ) {
+	    fprintf( stderr, "IIR ERROR: the new signal has no lattice structure (it is not stable).\n" );
+	    return NULL;
+	}
+    }
+
+    filter = _IIR_M_add_signal(filter, 1);
+
+    // Can not fail now (number of coefs and lattice coefs checked above)
+    if ( filter && a_coefs && b_coefs ) {
+	IIR_MD_set_coefs_one_signal(filter, n_coefs, b_coefs, a_coefs, filter->n_signals - 1);
+    }
+
+    return filter;
+}
+
+// Add the next input (x) to the filter and write the corresponding outputs
+// to y (caller array), without storing them as the last output of the
+// filter (see IIR_MS_add_input_to)
+inline void IIR_MD_add_input_to(IIR_MD_t *filter, const IIR_signal_t x[], IIR_signal_t y[]) {
     
-    IIR_signal_t *y = filter->last_output;
+    int k;
+
+    // Coefficient major layout: vectorized across signals, one chunk at a time
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	for (k=0; k<filter->n_signals; k+=IIR_M_COEF_MAJOR_CHUNK_SIGNALS){
+	    int m = filter->n_signals - k;
+	    if (m > IIR_M_COEF_MAJOR_CHUNK_SIGNALS){
+		m = IIR_M_COEF_MAJOR_CHUNK_SIGNALS;
+	    }
+	    _IIR_MD_coef_major_step(filter, k, m, x + k, y + k);
+	}
+	return;
+    }
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_M_structure_process(filter, x, filter->n_signals, 1, y, filter->n_signals, 1,
+				 NULL, NULL, 1, filter->n_coefs, 0);
+	return;
+    }
+
     IIR_signal_t *z = filter->z;
     IIR_signal_t *a = filter->a;
     IIR_signal_t *b = filter->b;
@@ -410,17 +1777,93 @@ inline IIR_signal_t *IIR_MD_add_input(IIR_MD_t *filter, const IIR_signal_t x[])
     int n_coefs = filter->n_coefs;
     int n_signals = filter->n_signals;
     
+    // Unrolled for order 1 to 4 filters (see _IIR_step_tdf2_fast)
     for (k=0; k<n_signals; k++){    
-	y[k] = z[k*n_coefs] + b[k*n_coefs] * x[k];
-
-	for (j = 1; j< n_coefs-1 ; j++){
-	    z[k*n_coefs+(j-1)] = z[k*n_coefs+j] + x[k] * b[k*n_coefs+j] - y[k] * a[k*n_coefs+j];
-	}
-	z[k*n_coefs+(j-1)] = x[k] * b[k*n_coefs+j] - y[k] * a[k*n_coefs+j];
+	y[k] = _IIR_step_tdf2_fast(n_coefs, a + k*n_coefs, b + k*n_coefs, z + k*n_coefs, x[k]);
     }    
+}
+
+// Add the next input (x) to the filter and return the corresponding output
+// x is an array of size n_signals.
+// HUGE gain by declaring this as inline!
+inline IIR_signal_t *IIR_MD_add_input(IIR_MD_t *filter, const IIR_signal_t x[]) {
     
-    return y;    
+    IIR_MD_add_input_to(filter, x, filter->last_output);
     
+    return filter->last_output;    
+}
+
+// Filter a block of n_frames frames (x) and store the outputs in y.
+// x and y are arrays of size n_frames*n_signals, with the frames stored
+// one after the other (x[frame*n_signals + signal]).
+// Returns 0 on fail (NULL arrays or negative n_frames), 1 otherwise
+inline int IIR_MD_process_block(IIR_MD_t *filter,
+				const IIR_signal_t *x,
+				IIR_signal_t *y,
+				int n_frames) {
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	return _IIR_M_coef_major_process(filter,
+					 x, filter->n_signals, 1,
+					 y, filter->n_signals, 1,
+					 NULL, NULL, n_frames, 1);
+    }
+
+    return _IIR_M_process_block(filter, x, y, n_frames, filter->n_coefs);
+}
+
+// Filter a block of n_frames frames in place: each value in xy (frames
+// stored one after the other) is replaced by the corresponding output.
+// Returns 0 on fail (NULL array or negative n_frames), 1 otherwise
+inline int IIR_MD_process_in_place(IIR_MD_t *filter, IIR_signal_t *xy, int n_frames) {
+
+    return IIR_MD_process_block(filter, xy, xy, n_frames);
+}
+
+// Filter a block of n inputs for each signal, with one input buffer and
+// one output buffer per signal (planar layout).
+// x and y are arrays of n_signals pointers to buffers of n values each.
+// Returns 0 on fail (NULL arrays or negative n), 1 otherwise
+inline int IIR_MD_process_planar(IIR_MD_t *filter,
+				 const IIR_signal_t *const x[],
+				 IIR_signal_t *const y[],
+				 int n) {
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	if ( (!x) || (!y) ) {
+	    return 0;
+	}
+	return _IIR_M_coef_major_process(filter, NULL, 0, 0, NULL, 0, 0, x, y, n, 1);
+    }
+
+    return _IIR_M_process_planar(filter, x, y, n, filter->n_coefs);
+}
+
+// Filter a block of n_frames frames with arbitrary input and output strides
+// (in number of values, not bytes). The input for signal k in frame i is
+// x[i*x_frame_stride + k*x_signal_stride] (same for y).
+// See _IIR_M_process_strided for details.
+// Returns 0 on fail (NULL arrays or negative n_frames), 1 otherwise
+inline int IIR_MD_process_strided(IIR_MD_t *filter,
+				  const IIR_signal_t *x,
+				  int x_frame_stride,
+				  int x_signal_stride,
+				  IIR_signal_t *y,
+				  int y_frame_stride,
+				  int y_signal_stride,
+				  int n_frames) {
+
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	return _IIR_M_coef_major_process(filter,
+					 x, x_frame_stride, x_signal_stride,
+					 y, y_frame_stride, y_signal_stride,
+					 NULL, NULL, n_frames, 1);
+    }
+
+    return _IIR_M_process_strided(filter,
+				  x, x_frame_stride, x_signal_stride,
+				  y, y_frame_stride, y_signal_stride,
+				  n_frames, filter->n_coefs);
 }
 
 // Reset the filter to the resting state
@@ -429,6 +1872,10 @@ inline IIR_signal_t *IIR_MD_add_input(IIR_MD_t *filter, const IIR_signal_t x[])
 // Free all the memory allocated by the MD filter.
 #define IIR_MD_destroy(filter) _IIR_M_destroy(filter)
 
+// Free the memory allocated apart from the filter block by an MD filter
+// built with IIR_MD_init (see _IIR_M_deinit). The caller owns the buffer.
+#define IIR_MD_deinit(filter) _IIR_M_deinit(filter)
+
 // This function normalizes all the coefficients in an MD filter
 // It cycles through all the a/b coefs sets and applies normalization
 // It operates directly in the arrays storing the actual filters so changes
@@ -445,6 +1892,28 @@ inline int IIR_MD_normalize_all_coefs(IIR_MD_t* filter) {
     IIR_signal_t *a_base = filter->a;
     IIR_signal_t *b_base = filter->b;
     
+    if (filter->layout == IIR_M_LAYOUT_COEF_MAJOR) {
+	// As above, signals are normalized up to the first one with a[0] == 0.
+	// Each coef row is normalized across those signals, from the last
+	// row to the first one so a[0] is still available
+	int k, n_valid = 0;
+	int stride = filter->_padded_signals;
+	while ( (n_valid < filter->n_signals) && (a_base[n_valid] != 0) ){
+	    n_valid++;
+	}
+	for ( i=n_coefs-1; i>=0; i-- ){
+	    IIR_signal_t *a_row = a_base + i*stride;
+	    IIR_signal_t *b_row = b_base + i*stride;
+	    for ( k=0; k<n_valid; k++ ){
+		b_row[k] = b_row[k]/a_base[k];
+	    }
+	    for ( k=0; k<n_valid; k++ ){
+		a_row[k] = a_row[k]/a_base[k];
+	    }
+	}
+	return n_valid == filter->n_signals;
+    }
+
     for ( i=0; i<filter->n_signals; i++ ){
 	// Return error if normalization fails!
 	if ( !IIR_normalize_coefs( n_coefs, b_base, a_base) ){
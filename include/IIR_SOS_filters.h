@@ -0,0 +1,1351 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 4:05 PM
+ */
+
+// Implementation of second order sections (SOS) filters: a cascade of
+// order 2 filters (biquads), the output of each section being the input of
+// the next one. High order filters are much less sensitive to rounding
+// errors in this form than as one transfer function (IIR_S_t, IIR_M_t), so
+// they usually work fine with float signals.
+//
+// Each section is a transposed direct form II filter with the same
+// operations as IIR_S_add_input for n_coefs = 3, so a cascade gives exactly
+// the same results as a chain of order 2 IIR_S_t filters. All the sections
+// are run for each input before going to the next one.
+//
+// Sections are given in the same format as scipy.signal.sosfilt: an array
+// of n_sections rows of IIR_SOS_INPUT_COEFS values
+//	b0, b1, b2, a0, a1, a2
+// and are normalized (a0 == 1) when set in the filter.
+
+#ifndef IIR_SOS_FILTERS_H
+#define IIR_SOS_FILTERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "IIR_filters.h"
+
+// Number of values of each section in the sos arrays given to the filters
+#define IIR_SOS_INPUT_COEFS 6
+
+// Number of coefficients stored by the filters for each section, once
+// normalized: b0, b1, b2, a1, a2
+#define IIR_SOS_SECTION_COEFS 5
+
+// Normalize one section (IIR_SOS_INPUT_COEFS values) and store its
+// IIR_SOS_SECTION_COEFS coefs in c, each one at c[i*stride]. Internal use.
+// Returns 0 if a0 is 0 (c is not modified), 1 otherwise
+inline int _IIR_SOS_set_section(const IIR_signal_t *sos, IIR_signal_t *c, int stride) {
+
+    IIR_signal_t a0 = sos[3];
+
+    // Can't normalize if a[0] is 0
+    if (a0 == 0) {
+	return 0;
+    }
+
+    c[0] = sos[0]/a0;
+    c[stride] = sos[1]/a0;
+    c[2*stride] = sos[2]/a0;
+    c[3*stride] = sos[4]/a0;
+    c[4*stride] = sos[5]/a0;
+
+    return 1;
+}
+
+/******************************************************
+ * One input signal SOS filter
+ ******************************************************/
+
+// Type for the structure holding the one input signal SOS filter state
+// coefs: IIR_SOS_SECTION_COEFS values per section (b0, b1, b2, a1, a2)
+// z: 2 states per section
+typedef struct {
+    int n_sections;
+    IIR_signal_t *coefs;
+    IIR_signal_t *z;
+    IIR_signal_t last_output;
+} IIR_SOS_t;
+
+// Fills in the sections of the filter (see the format above)
+// Returns 0 on fail (n_sections does not agree with the filter, NULL sos or
+// a section with a0 == 0), 1 otherwise
+inline int IIR_SOS_set_sos(IIR_SOS_t *filter, int n_sections, const IIR_signal_t *sos) {
+
+    int s;
+
+    if ( (n_sections != filter->n_sections) || (!sos) ) {
+	return 0;
+    }
+
+    for (s = 0; s < n_sections; s++){
+	if ( !_IIR_SOS_set_section(sos + s*IIR_SOS_INPUT_COEFS,
+				   filter->coefs + s*IIR_SOS_SECTION_COEFS, 1) ){
+	    return 0;
+	}
+    }
+
+    return 1;
+}
+
+// Create a single input signal SOS filter.
+// Parameters:
+//	n_sections: number of second order sections
+//	sos: n_sections*IIR_SOS_INPUT_COEFS values (see the format above). Can
+//	    be NULL for no initialization (leave as 0s)
+// Returns:
+//    A filter structure initialized to rest state or NULL upon error
+//    (memory allocation problem or wrong parameters)
+inline IIR_SOS_t *IIR_SOS_create(int n_sections, const IIR_signal_t *sos) {
+
+    if (n_sections <= 0) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a SOS filter without or negative number of sections: %d.\n",
+		n_sections
+		);
+	return NULL;
+    }
+
+    IIR_SOS_t *filter = (IIR_SOS_t*)malloc(sizeof (IIR_SOS_t));
+    if ( !filter ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	return NULL;
+    }
+
+    filter->n_sections = n_sections;
+    int coefs_byte_size = sizeof (IIR_signal_t) * n_sections * IIR_SOS_SECTION_COEFS;
+    int z_byte_size = sizeof (IIR_signal_t) * n_sections * 2;
+    filter->coefs = (IIR_signal_t*)malloc( coefs_byte_size );
+    filter->z = (IIR_signal_t*)malloc( z_byte_size );
+    if ( !filter->coefs || !filter->z ){
+	free( filter->coefs );
+	free( filter->z );
+	free( filter );
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter coefs or z arrays.\n" );
+	return NULL;
+    }
+
+    memset( filter->coefs, 0, coefs_byte_size );
+    memset( filter->z, 0, z_byte_size );
+
+    // Not valid yet, but initialize!
+    filter->last_output = 0;
+
+    if ( sos && !IIR_SOS_set_sos(filter, n_sections, sos) ){
+	fprintf( stderr, "IIR ERROR: trying to create a SOS filter with a0 == 0 in a section.\n" );
+	free( filter->coefs );
+	free( filter->z );
+	free( filter );
+	return NULL;
+    }
+
+    return filter;
+}
+
+// Returns the last output of the filter
+#define IIR_SOS_get_last_output(filter) (filter->last_output)
+
+// Add the next input (x) to the filter and return the corresponding output
+inline IIR_signal_t IIR_SOS_add_input(IIR_SOS_t *filter, IIR_signal_t x) {
+
+    int s;
+    IIR_signal_t y = x;
+    IIR_signal_t *z = filter->z;
+    const IIR_signal_t *c = filter->coefs;
+
+    for (s = 0; s < filter->n_sections; s++){
+	y = z[0] + c[0] * x;
+	z[0] = z[1] + x * c[1] - y * c[3];
+	z[1] = x * c[2] - y * c[4];
+	x = y;
+	z += 2;
+	c += IIR_SOS_SECTION_COEFS;
+    }
+
+    filter->last_output = y;
+
+    return y;
+}
+
+// Filter a block of n inputs (x) and store the corresponding outputs in y.
+// x and y can be the same array (in-place filtering).
+// Returns 0 on fail (NULL arrays or negative n), 1 otherwise
+inline int IIR_SOS_process_block(IIR_SOS_t *filter,
+				 const IIR_signal_t *x,
+				 IIR_signal_t *y,
+				 int n) {
+
+    int i, s;
+
+    if ( (!x) || (!y) || (n < 0) ) {
+	return 0;
+    }
+
+    int n_sections = filter->n_sections;
+    IIR_signal_t *z = filter->z;
+    const IIR_signal_t *c = filter->coefs;
+    IIR_signal_t x_i, y_i = filter->last_output;
+
+    for (i = 0; i < n; i++){
+	x_i = x[i];
+	for (s = 0; s < n_sections; s++){
+	    const IIR_signal_t *c_s = c + s*IIR_SOS_SECTION_COEFS;
+	    IIR_signal_t *z_s = z + 2*s;
+	    y_i = z_s[0] + c_s[0] * x_i;
+	    z_s[0] = z_s[1] + x_i * c_s[1] - y_i * c_s[3];
+	    z_s[1] = x_i * c_s[2] - y_i * c_s[4];
+	    x_i = y_i;
+	}
+	y[i] = y_i;
+    }
+
+    filter->last_output = y_i;
+
+    return 1;
+}
+
+// Filter a block of n inputs in place: each value in xy is replaced by the
+// corresponding output.
+// Returns 0 on fail (NULL array or negative n), 1 otherwise
+inline int IIR_SOS_process_in_place(IIR_SOS_t *filter, IIR_signal_t *xy, int n) {
+
+    return IIR_SOS_process_block(filter, xy, xy, n);
+}
+
+// Reset the filter to the resting state
+// Just return all previous states and last output to 0
+inline void IIR_SOS_reset(IIR_SOS_t *filter) {
+    memset( filter->z, 0, sizeof (IIR_signal_t) * filter->n_sections * 2 );
+    filter->last_output = 0;
+}
+
+// Free all the memory allocated by the filter
+inline void IIR_SOS_destroy(IIR_SOS_t *filter) {
+
+    free(filter->coefs);
+    free(filter->z);
+    free(filter);
+}
+
+/******************************************************
+ * Multiple input signal SOS filters
+ ******************************************************/
+
+// Type for the structure holding the multiple input signal SOS filter state
+// IIR_SOS_MS_t for Multiple input signals with Shared sections
+// IIR_SOS_MD_t for Multiple input signals with Different sections
+// Coefficient major layout (see IIR_M_filters.h), with the signals padded
+// to _padded_signals and each row aligned to IIR_SIMD_ALIGNMENT bytes:
+//	z[(2*section + i)*_padded_signals + signal], i = 0, 1
+//	coefs[(IIR_SOS_SECTION_COEFS*section + i)*_padded_signals + signal]
+//	    for MD filters, or coefs[IIR_SOS_SECTION_COEFS*section + i] for
+//	    MS filters
+// Each vector of signals runs through all the sections in registers, with
+// the kernel (see IIR_simd_kernels.h) selected for the CPU at creation.
+typedef struct {
+    int n_signals;
+    int n_sections;
+    IIR_signal_t *coefs;
+    IIR_signal_t *z;
+    IIR_signal_t *last_output;
+    int _padded_signals;
+    int _different_coefs;
+    int simd_level;
+    IIR_SOS_M_kernel_t _kernel;
+} IIR_SOS_M_t, IIR_SOS_MS_t, IIR_SOS_MD_t;
+
+// Forward declaration
+inline int IIR_SOS_MD_set_sos_all_signals(IIR_SOS_MD_t *filter, int n_sections, const IIR_signal_t *sos);
+inline int IIR_SOS_MS_set_sos(IIR_SOS_MS_t *filter, int n_sections, const IIR_signal_t *sos);
+
+// Create a multiple input signal SOS filter. Internal use, see
+// IIR_SOS_MS_create and IIR_SOS_MD_create.
+//	different_coefs: 0 for MS creation (shared sections) or 1 for MD
+//	    creation (different sections)
+inline IIR_SOS_M_t *_IIR_SOS_M_create(int n_sections, int n_signals,
+				      const IIR_signal_t *sos,
+				      int different_coefs) {
+
+    if (n_sections <= 0) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a SOS filter without or negative number of sections: %d.\n",
+		n_sections
+		);
+	return NULL;
+    }
+
+    if (n_signals <= 0) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a filter without or negative number of signals: %d.\n",
+		n_signals
+		);
+	return NULL;
+    }
+
+    IIR_SOS_M_t *filter = (IIR_SOS_M_t*) malloc(sizeof (IIR_SOS_M_t));
+    if ( !filter ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
+	return NULL;
+    }
+
+    filter->n_signals = n_signals;
+    filter->n_sections = n_sections;
+    filter->_different_coefs = different_coefs;
+    filter->_padded_signals = (n_signals + IIR_SIMD_SIGNALS - 1) / IIR_SIMD_SIGNALS * IIR_SIMD_SIGNALS;
+
+    // Bind the best kernel for this CPU
+    filter->simd_level = IIR_simd_detect_level();
+    filter->_kernel = _IIR_SOS_M_select_kernel(filter->simd_level, different_coefs);
+
+    size_t z_byte_size = sizeof (IIR_signal_t) * 2 * n_sections * filter->_padded_signals;
+    size_t coefs_byte_size = sizeof (IIR_signal_t) * IIR_SOS_SECTION_COEFS * n_sections;
+    if (different_coefs) {
+	coefs_byte_size *= filter->_padded_signals;
+    }
+    filter->z = (IIR_signal_t*) _IIR_aligned_malloc(z_byte_size);
+    filter->coefs = (IIR_signal_t*) _IIR_aligned_malloc(coefs_byte_size);
+    filter->last_output = (IIR_signal_t*) malloc(sizeof (IIR_signal_t) * n_signals);
+    if ( !filter->z || !filter->coefs || !filter->last_output ){
+	free( filter->z );
+	free( filter->coefs );
+	free( filter->last_output );
+	free( filter );
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter coefs, z or output arrays.\n" );
+	return NULL;
+    }
+
+    memset(filter->z, 0, z_byte_size);
+    memset(filter->coefs, 0, coefs_byte_size);
+    // Initialize the output (although not yet valid!)
+    memset(filter->last_output, 0, sizeof (IIR_signal_t) * n_signals);
+
+    // Fill the sections if provided
+    if (sos) {
+	int ok = different_coefs ? IIR_SOS_MD_set_sos_all_signals(filter, n_sections, sos)
+				 : IIR_SOS_MS_set_sos(filter, n_sections, sos);
+	if ( !ok ){
+	    fprintf( stderr, "IIR ERROR: trying to create a SOS filter with a0 == 0 in a section.\n" );
+	    free( filter->z );
+	    free( filter->coefs );
+	    free( filter->last_output );
+	    free( filter );
+	    return NULL;
+	}
+    }
+
+    return filter;
+}
+
+// Return the pointer to the filter output
+#define IIR_SOS_MS_get_last_output(filter) (filter->last_output)
+#define IIR_SOS_MD_get_last_output(filter) (filter->last_output)
+
+// Return a copy of the filter output (or NULL if memory allocation problem).
+// Internal use, aliased for MS and MD
+inline IIR_signal_t *_IIR_SOS_M_get_last_output_copy(IIR_SOS_M_t *filter) {
+
+    IIR_signal_t *result;
+    int nbytes = sizeof (IIR_signal_t) * filter->n_signals;
+
+    result = (IIR_signal_t *) malloc( nbytes );
+    if ( !result ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter output copy.\n" );
+	return NULL;
+    }
+
+    memcpy( result, filter->last_output, nbytes );
+
+    return result;
+}
+
+#define IIR_SOS_MS_get_last_output_copy(filter) _IIR_SOS_M_get_last_output_copy(filter)
+#define IIR_SOS_MD_get_last_output_copy(filter) _IIR_SOS_M_get_last_output_copy(filter)
+
+// Select the instruction set level (IIR_SIMD_LEVEL_*) of the kernel used by
+// the filter, overriding the one detected at creation. Intended for tests
+// and benchmarks. Internal use, aliased for MS and MD.
+// Returns 0 on fail (level not supported by the CPU or not compiled in), 1
+// otherwise
+inline int _IIR_SOS_M_set_simd_level(IIR_SOS_M_t *filter, int level) {
+
+    if ( (level < IIR_SIMD_LEVEL_SCALAR) || (level > IIR_simd_cpu_level()) ) {
+	return 0;
+    }
+
+    filter->simd_level = level;
+    filter->_kernel = _IIR_SOS_M_select_kernel(level, filter->_different_coefs);
+
+    return 1;
+}
+
+#define IIR_SOS_MS_set_simd_level(filter, level) _IIR_SOS_M_set_simd_level(filter, level)
+#define IIR_SOS_MD_set_simd_level(filter, level) _IIR_SOS_M_set_simd_level(filter, level)
+
+// Number of signals processed together through a whole block of frames, so
+// their states stay in cache. Must be a multiple of IIR_SIMD_SIGNALS
+#define IIR_SOS_M_CHUNK_SIGNALS (8*IIR_SIMD_SIGNALS)
+
+// Run all the sections for one frame of signals k0 to k0+m-1 with the
+// kernel of the filter. Internal use.
+// y holds the m inputs and receives the m outputs.
+inline void _IIR_SOS_M_step(IIR_SOS_M_t *filter, int k0, int m, IIR_signal_t *y) {
+
+    const IIR_signal_t *c = filter->coefs;
+
+    if (filter->_different_coefs) {
+	c += k0;
+    }
+
+    filter->_kernel(filter->n_sections, filter->_padded_signals, c,
+		    filter->z + k0, y, m);
+}
+
+// Filter n_frames frames. Internal use, aliased for MS and MD.
+// The value for signal k in frame i is read from
+//	x[i*x_frame_stride + k*x_signal_stride]
+// and its output is written to
+//	y[i*y_frame_stride + k*y_signal_stride]
+// or planar addressing (x[signal][frame], y[signal][frame]) is used if
+// x_planar and y_planar are given (then x and y are ignored), as in
+// _IIR_M_coef_major_process.
+// Signals are processed in chunks of IIR_SOS_M_CHUNK_SIGNALS through the
+// whole block. Frames with contiguous outputs are filtered directly in y,
+// the others in a buffer. In-place filtering (y == x) is supported when the
+// x and y strides match.
+// Returns 0 on fail (NULL arrays or negative n_frames), 1 otherwise
+inline int _IIR_SOS_M_process(IIR_SOS_M_t *filter,
+			      const IIR_signal_t *x,
+			      int x_frame_stride,
+			      int x_signal_stride,
+			      IIR_signal_t *y,
+			      int y_frame_stride,
+			      int y_signal_stride,
+			      const IIR_signal_t *const x_planar[],
+			      IIR_signal_t *const y_planar[],
+			      int n_frames) {
+
+    int i, k, k0, m;
+    int n_signals = filter->n_signals;
+    IIR_signal_t buf[IIR_SOS_M_CHUNK_SIGNALS];
+
+    if ( (n_frames < 0) || ((!x_planar || !y_planar) && (!x || !y)) ) {
+	return 0;
+    }
+
+    if ( n_frames == 0 ) {
+	return 1;
+    }
+
+    for (k0 = 0; k0 < n_signals; k0 += IIR_SOS_M_CHUNK_SIGNALS){
+	m = n_signals - k0;
+	if (m > IIR_SOS_M_CHUNK_SIGNALS){
+	    m = IIR_SOS_M_CHUNK_SIGNALS;
+	}
+	for (i = 0; i < n_frames; i++){
+	    IIR_signal_t *y_dest = buf;
+	    if ( !y_planar && (y_signal_stride == 1) ) {
+		y_dest = y + i*y_frame_stride + k0;
+	    }
+
+	    // Gather the inputs
+	    if (x_planar) {
+		for (k = 0; k < m; k++){
+		    y_dest[k] = x_planar[k0+k][i];
+		}
+	    } else if (x_signal_stride == 1) {
+		const IIR_signal_t *x_i = x + i*x_frame_stride + k0;
+		if (x_i != y_dest) {
+		    memcpy( y_dest, x_i, sizeof (IIR_signal_t) * m );
+		}
+	    } else {
+		const IIR_signal_t *x_i = x + i*x_frame_stride + k0*x_signal_stride;
+		for (k = 0; k < m; k++){
+		    y_dest[k] = x_i[k*x_signal_stride];
+		}
+	    }
+
+	    _IIR_SOS_M_step(filter, k0, m, y_dest);
+
+	    if (y_dest == buf) {
+		if (y_planar) {
+		    for (k = 0; k < m; k++){
+			y_planar[k0+k][i] = buf[k];
+		    }
+		} else {
+		    IIR_signal_t *y_i = y + i*y_frame_stride + k0*y_signal_stride;
+		    for (k = 0; k < m; k++){
+			y_i[k*y_signal_stride] = buf[k];
+		    }
+		}
+	    }
+	}
+    }
+
+    // Keep the last frame as last output (add_input filters directly there)
+    if (y_planar) {
+	for (k = 0; k < n_signals; k++){
+	    filter->last_output[k] = y_planar[k][n_frames-1];
+	}
+    } else if (y + (n_frames-1)*y_frame_stride != filter->last_output) {
+	for (k = 0; k < n_signals; k++){
+	    filter->last_output[k] = y[(n_frames-1)*y_frame_stride + k*y_signal_stride];
+	}
+    }
+
+    return 1;
+}
+
+// Filter a block of n_frames frames (x) and store the outputs in y.
+// x and y are arrays of size n_frames*n_signals, with the frames stored
+// one after the other (x[frame*n_signals + signal]). x and y can be the
+// same array (in-place filtering). Internal use, aliased for MS and MD.
+// Returns 0 on fail (NULL arrays or negative n_frames), 1 otherwise
+inline int _IIR_SOS_M_process_block(IIR_SOS_M_t *filter,
+				    const IIR_signal_t *x,
+				    IIR_signal_t *y,
+				    int n_frames) {
+
+    return _IIR_SOS_M_process(filter,
+			      x, filter->n_signals, 1,
+			      y, filter->n_signals, 1,
+			      NULL, NULL, n_frames);
+}
+
+// Add the next input (x, n_signals values) to the filter and return the
+// corresponding outputs (the last_output array of the filter). Internal
+// use, aliased for MS and MD.
+inline IIR_signal_t *_IIR_SOS_M_add_input(IIR_SOS_M_t *filter, const IIR_signal_t x[]) {
+
+    _IIR_SOS_M_process_block(filter, x, filter->last_output, 1);
+
+    return filter->last_output;
+}
+
+// Reset the filter to the resting state. Internal use, aliased for MS and MD
+inline void _IIR_SOS_M_reset(IIR_SOS_M_t *filter) {
+    memset( filter->z, 0, sizeof (IIR_signal_t) * 2 * filter->n_sections * filter->_padded_signals );
+    memset( filter->last_output, 0, sizeof (IIR_signal_t) * filter->n_signals );
+}
+
+// Free all the memory allocated by the filter. Internal use, aliased for
+// MS and MD
+inline void _IIR_SOS_M_destroy(IIR_SOS_M_t *filter) {
+
+    free(filter->coefs);
+    free(filter->z);
+    free(filter->last_output);
+    free(filter);
+}
+
+// Add the next input (x, n_signals values) and return the outputs
+#define IIR_SOS_MS_add_input(filter, x) _IIR_SOS_M_add_input(filter, x)
+#define IIR_SOS_MD_add_input(filter, x) _IIR_SOS_M_add_input(filter, x)
+
+// Filter a block of frames (see _IIR_SOS_M_process_block)
+#define IIR_SOS_MS_process_block(filter, x, y, n_frames) _IIR_SOS_M_process_block(filter, x, y, n_frames)
+#define IIR_SOS_MD_process_block(filter, x, y, n_frames) _IIR_SOS_M_process_block(filter, x, y, n_frames)
+
+// Filter a block of frames in place
+#define IIR_SOS_MS_process_in_place(filter, xy, n_frames) _IIR_SOS_M_process_block(filter, xy, xy, n_frames)
+#define IIR_SOS_MD_process_in_place(filter, xy, n_frames) _IIR_SOS_M_process_block(filter, xy, xy, n_frames)
+
+// Filter a block of n inputs for each signal, with one input buffer and one
+// output buffer per signal (x and y are arrays of n_signals pointers)
+#define IIR_SOS_MS_process_planar(filter, x, y, n) _IIR_SOS_M_process(filter, NULL, 0, 0, NULL, 0, 0, x, y, n)
+#define IIR_SOS_MD_process_planar(filter, x, y, n) _IIR_SOS_M_process(filter, NULL, 0, 0, NULL, 0, 0, x, y, n)
+
+// Filter a block of frames with arbitrary input and output strides (in
+// number of values, see _IIR_SOS_M_process)
+#define IIR_SOS_MS_process_strided(filter, x, x_frame_stride, x_signal_stride, y, y_frame_stride, y_signal_stride, n_frames) \
+    _IIR_SOS_M_process(filter, x, x_frame_stride, x_signal_stride, y, y_frame_stride, y_signal_stride, NULL, NULL, n_frames)
+#define IIR_SOS_MD_process_strided(filter, x, x_frame_stride, x_signal_stride, y, y_frame_stride, y_signal_stride, n_frames) \
+    _IIR_SOS_M_process(filter, x, x_frame_stride, x_signal_stride, y, y_frame_stride, y_signal_stride, NULL, NULL, n_frames)
+
+// Reset the filter to the resting state
+#define IIR_SOS_MS_reset(filter) _IIR_SOS_M_reset(filter)
+#define IIR_SOS_MD_reset(filter) _IIR_SOS_M_reset(filter)
+
+// Free all the memory allocated by the filter
+#define IIR_SOS_MS_destroy(filter) _IIR_SOS_M_destroy(filter)
+#define IIR_SOS_MD_destroy(filter) _IIR_SOS_M_destroy(filter)
+
+/******************************************************
+ * Functions specific to Shared sections Multi signal SOS filters
+ ******************************************************/
+
+// Create a multi signal SOS filter where all the signals share the same
+// sections (n_sections*IIR_SOS_INPUT_COEFS values, can be NULL for no
+// initialization)
+inline IIR_SOS_MS_t *IIR_SOS_MS_create(int n_sections, int n_signals, const IIR_signal_t *sos) {
+
+    return _IIR_SOS_M_create(n_sections, n_signals, sos, 0);
+}
+
+// Fills in the sections of the filter
+// Returns 0 on fail (n_sections does not agree with the filter, NULL sos or
+// a section with a0 == 0), 1 otherwise
+inline int IIR_SOS_MS_set_sos(IIR_SOS_MS_t *filter, int n_sections, const IIR_signal_t *sos) {
+
+    int s;
+
+    if ( (n_sections != filter->n_sections) || (!sos) ) {
+	return 0;
+    }
+
+    for (s = 0; s < n_sections; s++){
+	if ( !_IIR_SOS_set_section(sos + s*IIR_SOS_INPUT_COEFS,
+				   filter->coefs + s*IIR_SOS_SECTION_COEFS, 1) ){
+	    return 0;
+	}
+    }
+
+    return 1;
+}
+
+/******************************************************
+ * Functions specific to Different sections Multi signal SOS filters
+ ******************************************************/
+
+// Create a multi signal SOS filter with different sections for each signal
+// sos: n_sections*IIR_SOS_INPUT_COEFS values, copied to every signal (can
+// be NULL for no initialization). Then set the sections of each signal with
+// IIR_SOS_MD_set_sos_one_signal, or use IIR_SOS_MD_create_bank
+inline IIR_SOS_MD_t *IIR_SOS_MD_create(int n_sections, int n_signals, const IIR_signal_t *sos) {
+
+    return _IIR_SOS_M_create(n_sections, n_signals, sos, 1);
+}
+
+// Fills in the sections of one signal (n_sections*IIR_SOS_INPUT_COEFS values)
+// Returns 0 on fail (n_sections does not agree with the filter, NULL sos,
+// wrong signal or a section with a0 == 0), 1 otherwise
+inline int IIR_SOS_MD_set_sos_one_signal(IIR_SOS_MD_t *filter,
+					 int n_sections,
+					 const IIR_signal_t *sos,
+					 int signal) {
+
+    int s;
+    int stride = filter->_padded_signals;
+
+    if ( (n_sections != filter->n_sections) || (!sos)
+	    || (signal < 0) || (signal >= filter->n_signals) ) {
+	return 0;
+    }
+
+    for (s = 0; s < n_sections; s++){
+	if ( !_IIR_SOS_set_section(sos + s*IIR_SOS_INPUT_COEFS,
+				   filter->coefs + IIR_SOS_SECTION_COEFS*s*stride + signal,
+				   stride) ){
+	    return 0;
+	}
+    }
+
+    return 1;
+}
+
+// Fills in the sections of all the signals with the same sections
+// (n_sections*IIR_SOS_INPUT_COEFS values), as IIR_MD_set_coefs_all_signals
+// Returns 0 on fail (see IIR_SOS_MD_set_sos_one_signal), 1 otherwise
+inline int IIR_SOS_MD_set_sos_all_signals(IIR_SOS_MD_t *filter,
+					  int n_sections,
+					  const IIR_signal_t *sos) {
+
+    int j;
+
+    for (j = 0; j < filter->n_signals; j++){
+	if ( !IIR_SOS_MD_set_sos_one_signal(filter, n_sections, sos, j) ){
+	    return 0;
+	}
+    }
+
+    return 1;
+}
+
+// Fills in the sections of every signal from a table with one set of
+// sections for each signal (n_signals*n_sections*IIR_SOS_INPUT_COEFS values,
+// the sections of each signal one after the other), as
+// IIR_MD_set_coefs_table
+// Returns 0 on fail (see IIR_SOS_MD_set_sos_one_signal), 1 otherwise
+inline int IIR_SOS_MD_set_sos_table(IIR_SOS_MD_t *filter,
+				    int n_sections,
+				    const IIR_signal_t *sos_table) {
+
+    int j;
+
+    if (!sos_table) {
+	return 0;
+    }
+
+    for (j = 0; j < filter->n_signals; j++){
+	if ( !IIR_SOS_MD_set_sos_one_signal(filter, n_sections,
+					    sos_table + j*n_sections*IIR_SOS_INPUT_COEFS, j) ){
+	    return 0;
+	}
+    }
+
+    return 1;
+}
+
+// Create a multi signal SOS filter with the sections of each signal taken
+// from a table (see IIR_SOS_MD_set_sos_table), as IIR_MD_create_bank
+// Returns NULL upon error (memory, NULL table or a section with a0 == 0)
+inline IIR_SOS_MD_t *IIR_SOS_MD_create_bank(int n_sections, int n_signals, const IIR_signal_t *sos_table) {
+
+    IIR_SOS_MD_t *filter = _IIR_SOS_M_create(n_sections, n_signals, NULL, 1);
+
+    if ( filter && !IIR_SOS_MD_set_sos_table(filter, n_sections, sos_table) ){
+	fprintf( stderr, "IIR ERROR: trying to create a SOS filter bank without sections or with a0 == 0 in a section.\n" );
+	_IIR_SOS_M_destroy(filter);
+	return NULL;
+    }
+
+    return filter;
+}
+
+/******************************************************
+ * Conversion from transfer function (b, a) to sections
+ ******************************************************/
+
+// Number of sections of the SOS filter equivalent to a transfer function
+// with n_coefs coefficients (order n_coefs-1)
+#define IIR_SOS_N_SECTIONS(n_coefs) ((n_coefs)/2)
+
+// Minimal complex arithmetic for the root finder (internal use). Plain
+// structs instead of C99 complex so the header is still valid C++
+typedef struct {
+    double re;
+    double im;
+} _IIR_complex_t;
+
+inline _IIR_complex_t _IIR_c_make(double re, double im) {
+    _IIR_complex_t r;
+    r.re = re;
+    r.im = im;
+    return r;
+}
+
+inline _IIR_complex_t _IIR_c_sub(_IIR_complex_t x, _IIR_complex_t y) {
+    return _IIR_c_make(x.re - y.re, x.im - y.im);
+}
+
+inline _IIR_complex_t _IIR_c_mul(_IIR_complex_t x, _IIR_complex_t y) {
+    return _IIR_c_make(x.re*y.re - x.im*y.im, x.re*y.im + x.im*y.re);
+}
+
+inline _IIR_complex_t _IIR_c_div(_IIR_complex_t x, _IIR_complex_t y) {
+    double d = y.re*y.re + y.im*y.im;
+    return _IIR_c_make((x.re*y.re + x.im*y.im)/d, (x.im*y.re - x.re*y.im)/d);
+}
+
+// Squared modulus (no need for sqrt, and so for libm, anywhere)
+inline double _IIR_c_abs2(_IIR_complex_t x) {
+    return x.re*x.re + x.im*x.im;
+}
+
+// Evaluate the monic polynomial z^n + c[0] z^(n-1) + ... + c[n-1] and its
+// derivative at z (Horner). Internal use
+inline _IIR_complex_t _IIR_poly_eval(int n, const double *c, _IIR_complex_t z, _IIR_complex_t *dp) {
+
+    int i;
+    _IIR_complex_t p = _IIR_c_make(1.0, 0.0);
+    _IIR_complex_t d = _IIR_c_make(0.0, 0.0);
+
+    for (i = 0; i < n; i++){
+	d = _IIR_c_mul(d, z);
+	d.re += p.re;
+	d.im += p.im;
+	p = _IIR_c_mul(p, z);
+	p.re += c[i];
+    }
+    if (dp) {
+	*dp = d;
+    }
+
+    return p;
+}
+
+// Coefficients of the monic polynomial z^n + c[0] z^(n-1) + ... + c[n-1]
+// around m: t[j] is the coefficient of (z-m)^j, j = 0..n (repeated
+// synthetic division). If scale is not NULL, scale[j] gets the same with
+// the absolute values of c and m, which bounds the rounding errors of t[j].
+// q is a scratch array of n+1 values. Internal use
+inline void _IIR_poly_taylor(int n, const double *c, _IIR_complex_t m,
+			     _IIR_complex_t *t, double *scale, _IIR_complex_t *q) {
+
+    int i, j;
+    double abs_m = 0;
+
+    if (scale) {
+	// |m| without sqrt: first approximation good enough for a bound
+	abs_m = (m.re < 0 ? -m.re : m.re) + (m.im < 0 ? -m.im : m.im);
+    }
+
+    q[0] = _IIR_c_make(1.0, 0.0);
+    for (i = 0; i < n; i++){
+	q[i+1] = _IIR_c_make(c[i], 0.0);
+    }
+    for (j = 0; j <= n; j++){
+	// Divide q (degree n-j) by (z - m): the remainder is t[j]
+	for (i = 1; i <= n-j; i++){
+	    _IIR_complex_t v = _IIR_c_mul(q[i-1], m);
+	    q[i].re += v.re;
+	    q[i].im += v.im;
+	}
+	t[j] = q[n-j];
+    }
+
+    if (scale) {
+	for (i = 0; i <= n; i++){
+	    q[i].re = (i == 0) ? 1.0 : ((c[i-1] < 0) ? -c[i-1] : c[i-1]);
+	}
+	for (j = 0; j <= n; j++){
+	    for (i = 1; i <= n-j; i++){
+		q[i].re += q[i-1].re * abs_m;
+	    }
+	    scale[j] = q[n-j].re;
+	}
+    }
+}
+
+// Relative distance between the monic polynomial z^n + c[0] z^(n-1) + ...
+// + c[n-1] and the product of (z - r[j]): the biggest coefficient difference
+// relative to the same coefficient of the product of (z + |r[j]|), which
+// bounds the rounding errors of the product. q and s are scratch arrays of
+// n+1 values. Internal use
+inline double _IIR_poly_roots_error(int n, const double *c, const _IIR_complex_t *r,
+				    _IIR_complex_t *q, double *s) {
+
+    int i, j;
+    double err = 0;
+
+    q[0] = _IIR_c_make(1.0, 0.0);
+    s[0] = 1.0;
+    for (j = 0; j < n; j++){
+	double abs_r = (r[j].re < 0 ? -r[j].re : r[j].re) + (r[j].im < 0 ? -r[j].im : r[j].im);
+	q[j+1] = _IIR_c_make(0.0, 0.0);
+	s[j+1] = 0.0;
+	for (i = j+1; i > 0; i--){
+	    q[i] = _IIR_c_sub(q[i], _IIR_c_mul(q[i-1], r[j]));
+	    s[i] += s[i-1] * abs_r;
+	}
+    }
+    for (i = 1; i <= n; i++){
+	double d2 = _IIR_c_abs2(_IIR_c_sub(q[i], _IIR_c_make(c[i-1], 0.0)));
+	if (d2 > 0) {
+	    double e2 = (s[i] > 0) ? d2 / (s[i]*s[i]) : 1.0;
+	    err = (e2 > err) ? e2 : err;
+	}
+    }
+
+    // Squared, as everything else here
+    return err;
+}
+
+// Maximum number of iterations of the root finder
+#define _IIR_ROOTS_MAX_ITERATIONS 500
+
+// Find the n roots of the monic polynomial z^n + c[0] z^(n-1) + ... + c[n-1]
+// (real coefficients) and store them in r. Internal use.
+// Simultaneous iteration (Durand-Kerner) followed by a Newton polish.
+// A multiple root is found as a cluster of roots (about eps^(1/k) apart for
+// multiplicity k), as the (1 + z^-1)^n numerators of Butterworth filters.
+// If merge_multiple is set, each group of k roots around their mean is
+// tested: the center is refined with Newton on the (k-1)th derivative of the
+// polynomial (where the multiple root is a simple one) and the group is
+// replaced by k roots at the center if the polynomial and its first k-1
+// derivatives are 0 there, up to a few rounding errors of IIR_signal_t,
+// and the merged roots give the polynomial at least as well as before.
+// Finally, roots with a negligible imaginary part are made real and the
+// others exact conjugate pairs.
+// Returns 0 on fail (memory allocation problem), 1 otherwise
+inline int _IIR_poly_roots(int n, const double *c, _IIR_complex_t *r, int merge_multiple) {
+
+    int i, j, k, l, it;
+
+    // Exact zero roots for trailing zero coefficients
+    while ( (n > 0) && (c[n-1] == 0) ){
+	r[--n] = _IIR_c_make(0.0, 0.0);
+    }
+    if (n == 0) {
+	return 1;
+    }
+    if (n == 1) {
+	r[0] = _IIR_c_make(-c[0], 0.0);
+	return 1;
+    }
+
+    // Start on a circle with the radius of the Cauchy bound, with the usual
+    // (0.4 + 0.9i)^k non symmetric starting points
+    double bound = 0;
+    for (i = 0; i < n; i++){
+	double v = (c[i] < 0) ? -c[i] : c[i];
+	bound = (v > bound) ? v : bound;
+    }
+    bound += 1.0;
+    _IIR_complex_t w = _IIR_c_make(0.4, 0.9);
+    r[0] = _IIR_c_make(bound, 0.0);
+    for (i = 1; i < n; i++){
+	r[i] = _IIR_c_mul(r[i-1], w);
+    }
+
+    for (it = 0; it < _IIR_ROOTS_MAX_ITERATIONS; it++){
+	double max_step = 0;
+	for (i = 0; i < n; i++){
+	    _IIR_complex_t den = _IIR_c_make(1.0, 0.0);
+	    for (j = 0; j < n; j++){
+		if (j != i) {
+		    den = _IIR_c_mul(den, _IIR_c_sub(r[i], r[j]));
+		}
+	    }
+	    if (_IIR_c_abs2(den) == 0) {
+		// Two equal approximations: move one a bit
+		r[i].re += DBL_EPSILON * bound;
+		r[i].im += DBL_EPSILON * bound;
+		max_step = 1;
+		continue;
+	    }
+	    _IIR_complex_t step = _IIR_c_div(_IIR_poly_eval(n, c, r[i], NULL), den);
+	    r[i] = _IIR_c_sub(r[i], step);
+	    double rel = _IIR_c_abs2(step) / (1.0 + _IIR_c_abs2(r[i]));
+	    max_step = (rel > max_step) ? rel : max_step;
+	}
+	if (max_step < 16*DBL_EPSILON*DBL_EPSILON) {
+	    break;
+	}
+    }
+
+    // Newton polish, only while it reduces the residual
+    for (i = 0; i < n; i++){
+	for (it = 0; it < 3; it++){
+	    _IIR_complex_t d;
+	    _IIR_complex_t p = _IIR_poly_eval(n, c, r[i], &d);
+	    if (_IIR_c_abs2(d) == 0) {
+		break;
+	    }
+	    _IIR_complex_t next = _IIR_c_sub(r[i], _IIR_c_div(p, d));
+	    if ( !(_IIR_c_abs2(_IIR_poly_eval(n, c, next, NULL)) < _IIR_c_abs2(p)) ) {
+		break;
+	    }
+	    r[i] = next;
+	}
+    }
+
+    int *done = (int*) calloc(n, sizeof(int));
+    int *group = (int*) malloc(sizeof(int) * n);
+    _IIR_complex_t *t = (_IIR_complex_t*) malloc(sizeof(_IIR_complex_t) * (n+1));
+    _IIR_complex_t *q = (_IIR_complex_t*) malloc(sizeof(_IIR_complex_t) * (n+1));
+    double *scale = (double*) malloc(sizeof(double) * (n+1));
+    _IIR_complex_t *merged = (_IIR_complex_t*) malloc(sizeof(_IIR_complex_t) * n);
+    if ( !done || !group || !t || !q || !scale || !merged ){
+	free( done );
+	free( group );
+	free( t );
+	free( q );
+	free( scale );
+	free( merged );
+	return 0;
+    }
+
+    // Biggest multiplicities first, so a cluster is not taken by parts: for
+    // each m, groups of each root and its m-1 nearest ones
+    double err = 16 * IIR_SIGNAL_EPSILON;
+    err = err * err;
+    if (merge_multiple) {
+	double err_roots = _IIR_poly_roots_error(n, c, r, q, scale);
+	err = (err_roots > err) ? err_roots : err;
+    }
+    for (int m = n; merge_multiple && (m >= 2); m--){
+	for (i = 0; i < n; i++){
+	    if (done[i]) {
+		continue;
+	    }
+	    // The other roots sorted by distance to r[i]
+	    int n_group = 0;
+	    for (j = 0; j < n; j++){
+		if ( (j != i) && !done[j] ){
+		    double dj = _IIR_c_abs2(_IIR_c_sub(r[j], r[i]));
+		    for (k = n_group; (k > 0) && (_IIR_c_abs2(_IIR_c_sub(r[group[k-1]], r[i])) > dj); k--){
+			group[k] = group[k-1];
+		    }
+		    group[k] = j;
+		    n_group++;
+		}
+	    }
+	    if (n_group < m-1) {
+		continue;
+	    }
+	    _IIR_complex_t mean = r[i];
+	    for (k = 0; k < m-1; k++){
+		mean.re += r[group[k]].re;
+		mean.im += r[group[k]].im;
+	    }
+	    mean.re /= m;
+	    mean.im /= m;
+	    // Newton on the (m-1)th derivative: t[m-1] / (m t[m])
+	    for (it = 0; it < 8; it++){
+		_IIR_poly_taylor(n, c, mean, t, NULL, q);
+		if (_IIR_c_abs2(t[m]) == 0) {
+		    break;
+		}
+		_IIR_complex_t step = _IIR_c_div(t[m-1], _IIR_c_make(m * t[m].re, m * t[m].im));
+		mean = _IIR_c_sub(mean, step);
+		if (_IIR_c_abs2(step) <= DBL_EPSILON*DBL_EPSILON*(1.0 + _IIR_c_abs2(mean))) {
+		    break;
+		}
+	    }
+	    // Multiple root if |t[l]| <= 8 eps scale[l], l < m (compared squared)
+	    _IIR_poly_taylor(n, c, mean, t, scale, q);
+	    int multiple = 1;
+	    for (l = 0; (l < m) && multiple; l++){
+		double tol = 8 * IIR_SIGNAL_EPSILON * scale[l];
+		multiple = (_IIR_c_abs2(t[l]) <= tol*tol);
+	    }
+	    // Of multiplicity m, not more (a root of higher multiplicity is
+	    // also a root of the (m-1)th derivative, so Newton could have gone
+	    // to another cluster)
+	    double tol_m = 8 * IIR_SIGNAL_EPSILON * scale[m];
+	    multiple = multiple && (_IIR_c_abs2(t[m]) > tol_m*tol_m);
+	    if (!multiple) {
+		continue;
+	    }
+	    // Last check, the roots with the group merged must give the
+	    // polynomial at least as well as before: with a cluster of a higher
+	    // multiplicity nearby, Newton can converge there and every test
+	    // above pass with a small t[m]
+	    for (k = 0; k < n; k++){
+		merged[k] = r[k];
+	    }
+	    merged[i] = mean;
+	    for (k = 0; k < m-1; k++){
+		merged[group[k]] = mean;
+	    }
+	    double err_merged = _IIR_poly_roots_error(n, c, merged, q, scale);
+	    if (err_merged <= err) {
+		err = err_merged;
+		r[i] = mean;
+		done[i] = 1;
+		for (k = 0; k < m-1; k++){
+		    r[group[k]] = mean;
+		    done[group[k]] = 1;
+		}
+	    }
+	}
+    }
+
+    // Real roots and conjugate pairs
+    for (i = 0; i < n; i++){
+	if (r[i].im * r[i].im <= 1e-24 * (1.0 + _IIR_c_abs2(r[i]))) {
+	    r[i].im = 0;
+	}
+	done[i] = 0;
+    }
+    // Conjugate pairs, closest ones first (the roots of a multiple root not
+    // merged are not symmetric, so one of them can be closer to the
+    // conjugate of a different root than its own)
+    for (;;){
+	int best_i = -1, best_j = -1;
+	double best_d = 0;
+	for (i = 0; i < n; i++){
+	    if ( (r[i].im <= 0) || done[i] ) {
+		continue;
+	    }
+	    for (j = 0; j < n; j++){
+		if ( (r[j].im < 0) && !done[j] ) {
+		    double d = _IIR_c_abs2(_IIR_c_sub(r[j], _IIR_c_make(r[i].re, -r[i].im)));
+		    if ( (best_i < 0) || (d < best_d) ){
+			best_i = i;
+			best_j = j;
+			best_d = d;
+		    }
+		}
+	    }
+	}
+	if (best_i < 0) {
+	    break;
+	}
+	r[best_i] = _IIR_c_make(0.5 * (r[best_i].re + r[best_j].re),
+				0.5 * (r[best_i].im - r[best_j].im));
+	r[best_j] = _IIR_c_make(r[best_i].re, -r[best_i].im);
+	done[best_i] = 1;
+	done[best_j] = 1;
+    }
+    // Complex roots left without a pair
+    for (i = 0; i < n; i++){
+	if ( (r[i].im != 0) && !done[i] ) {
+	    r[i].im = 0;
+	}
+    }
+
+    free( done );
+    free( group );
+    free( t );
+    free( q );
+    free( scale );
+    free( merged );
+
+    return 1;
+}
+
+// Find the remaining root (used[i] == 0) with the biggest modulus (pole
+// closest to the unit circle, for stable filters) or closest to target if
+// target is not NULL. Only real roots if real_only. Internal use.
+// Returns its index or -1 if there is none
+inline int _IIR_sos_pick(int n, const _IIR_complex_t *r, const int *used,
+			 const _IIR_complex_t *target, int real_only) {
+
+    int i, best = -1;
+    double best_v = 0;
+
+    for (i = 0; i < n; i++){
+	if ( used[i] || (real_only && (r[i].im != 0)) ) {
+	    continue;
+	}
+	double v = target ? -_IIR_c_abs2(_IIR_c_sub(r[i], *target)) : _IIR_c_abs2(r[i]);
+	if ( (best < 0) || (v > best_v) ){
+	    best = i;
+	    best_v = v;
+	}
+    }
+
+    return best;
+}
+
+// Index of the conjugate of root i (the next unused root with the opposite
+// imaginary part, they are exact pairs). Internal use
+inline int _IIR_sos_conj(int n, const _IIR_complex_t *r, const int *used, int i) {
+
+    int j;
+
+    for (j = 0; j < n; j++){
+	if ( !used[j] && (j != i) && (r[j].re == r[i].re) && (r[j].im == -r[i].im) ) {
+	    return j;
+	}
+    }
+
+    return -1;
+}
+
+// Convert a transfer function (the b and a coefs of IIR_S_create, n_coefs
+// values each) to IIR_SOS_N_SECTIONS(n_coefs) second order sections, stored
+// in sos with the format of IIR_SOS_create (n_sections rows of b0, b1, b2,
+// a0, a1, a2, with a0 == 1).
+// The roots of both polynomials are found in double precision. Complex
+// poles and zeros go with their conjugates and real ones are paired between
+// them. Starting with the poles closest to the unit circle, each pair of
+// poles is matched with the nearest remaining zeros, and the sections are
+// ordered with those poles last (as scipy.signal.tf2sos does). The gain is
+// applied to the first section. An odd order filter has a first order
+// section (b2 == a2 == 0). Zeros "at infinity" (leading zeros in b, that is
+// delays) give sections with b0 == 0.
+// Returns the number of sections or 0 on fail (n_coefs < 2, NULL arrays,
+// a[0] == 0 or memory allocation problem)
+inline int IIR_tf2sos(int n_coefs,
+		      const IIR_signal_t *b_coefs,
+		      const IIR_signal_t *a_coefs,
+		      IIR_signal_t *sos) {
+
+    int i, s;
+    int N = n_coefs - 1;
+
+    if ( (n_coefs <= 1) || (!b_coefs) || (!a_coefs) || (!sos) || (a_coefs[0] == 0) ) {
+	return 0;
+    }
+
+    int n_sections = IIR_SOS_N_SECTIONS(n_coefs);
+
+    // Leading zeros of b: zeros at infinity
+    int d = 0;
+    while ( (d < N) && (b_coefs[d] == 0) ){
+	d++;
+    }
+    double gain = b_coefs[d] / (double)a_coefs[0];
+
+    double *c = (double*) malloc(sizeof(double) * N);
+    _IIR_complex_t *p = (_IIR_complex_t*) malloc(sizeof(_IIR_complex_t) * N);
+    _IIR_complex_t *z = (_IIR_complex_t*) malloc(sizeof(_IIR_complex_t) * N);
+    int *used_p = (int*) calloc(N, sizeof(int));
+    int *used_z = (int*) calloc(N, sizeof(int));
+    int ok = c && p && z && used_p && used_z;
+
+    // Poles: roots of a[0] z^N + ... + a[N]
+    for (i = 0; ok && (i < N); i++){
+	c[i] = a_coefs[i+1] / (double)a_coefs[0];
+    }
+    ok = ok && _IIR_poly_roots(N, c, p, 0);
+
+    // Finite zeros: roots of b[d] z^(N-d) + ... + b[N] (none if b is all 0s)
+    int n_finite = (b_coefs[d] == 0) ? 0 : N - d;
+    for (i = 0; ok && (i < n_finite); i++){
+	c[i] = b_coefs[d+i+1] / (double)b_coefs[d];
+    }
+    ok = ok && _IIR_poly_roots(n_finite, c, z, 1);
+
+    // Sections from the last one (poles closest to the unit circle) to the
+    // first one, which is the first order one for odd orders
+    int n_inf = d;
+    for (s = n_sections-1; ok && (s >= 0); s--){
+	IIR_signal_t *row = sos + s*IIR_SOS_INPUT_COEFS;
+	int n_poles = ( (s == 0) && (N % 2) ) ? 1 : 2;
+
+	// Poles: the one closest to the unit circle and its conjugate or the
+	// next real one. A real one with no real one left to pair with (odd
+	// orders) is kept for the first order section
+	int p1 = _IIR_sos_pick(N, p, used_p, NULL, n_poles == 1);
+	int p2 = -1;
+	used_p[p1] = 1;
+	if (n_poles == 2) {
+	    if (p[p1].im != 0) {
+		p2 = _IIR_sos_conj(N, p, used_p, p1);
+	    } else {
+		p2 = _IIR_sos_pick(N, p, used_p, NULL, 1);
+		if (p2 < 0) {
+		    used_p[p1] = 0;
+		    for (i = 0; i < N; i++){
+			used_p[i] += (p[i].im == 0);
+		    }
+		    p1 = _IIR_sos_pick(N, p, used_p, NULL, 0);
+		    for (i = 0; i < N; i++){
+			used_p[i] -= (p[i].im == 0);
+		    }
+		    used_p[p1] = 1;
+		    p2 = _IIR_sos_conj(N, p, used_p, p1);
+		}
+	    }
+	    used_p[p2] = 1;
+	}
+
+	// Zeros: as many as poles, the nearest ones to p1 (finite zeros before
+	// infinite ones). A complex pair, or two real (or infinite) ones
+	int n_real = n_inf;
+	for (i = 0; i < n_finite; i++){
+	    n_real += !used_z[i] && (z[i].im == 0);
+	}
+	int zc = -1;
+	if (n_poles == 2) {
+	    for (i = 0; i < n_finite; i++){
+		used_z[i] += (z[i].im == 0);
+	    }
+	    zc = _IIR_sos_pick(n_finite, z, used_z, &p[p1], 0);
+	    for (i = 0; i < n_finite; i++){
+		used_z[i] -= (z[i].im == 0);
+	    }
+	}
+	int zr = _IIR_sos_pick(n_finite, z, used_z, &p[p1], 1);
+	if ( (zc >= 0) && ( (n_real < 2)
+		|| (zr < 0) || (_IIR_c_abs2(_IIR_c_sub(z[zc], p[p1])) < _IIR_c_abs2(_IIR_c_sub(z[zr], p[p1]))) ) ) {
+	    // Complex pair
+	    used_z[zc] = 1;
+	    int zc2 = _IIR_sos_conj(n_finite, z, used_z, zc);
+	    used_z[zc2] = 1;
+	    row[0] = 1;
+	    row[1] = -2 * z[zc].re;
+	    row[2] = _IIR_c_abs2(z[zc]);
+	} else {
+	    // Real or infinite zeros: (1 - z1 x)(1 - z2 x), with x = z^-1 and
+	    // (0, 1) instead of (1, -z) for an infinite zero
+	    double q[3] = { 1, 0, 0 };
+	    for (i = 0; i < n_poles; i++){
+		int zi = _IIR_sos_pick(n_finite, z, used_z, &p[p1], 1);
+		double f0 = 1, f1;
+		if (zi >= 0) {
+		    used_z[zi] = 1;
+		    f1 = -z[zi].re;
+		} else {
+		    n_inf--;
+		    f0 = 0;
+		    f1 = 1;
+		}
+		q[2] = q[2]*f0 + q[1]*f1;
+		q[1] = q[1]*f0 + q[0]*f1;
+		q[0] = q[0]*f0;
+	    }
+	    row[0] = q[0];
+	    row[1] = q[1];
+	    row[2] = q[2];
+	}
+
+	row[3] = 1;
+	if (p2 >= 0) {
+	    row[4] = -(p[p1].re + p[p2].re);
+	    row[5] = p[p1].re*p[p2].re - p[p1].im*p[p2].im;
+	} else {
+	    row[4] = -p[p1].re;
+	    row[5] = 0;
+	}
+    }
+
+    // Gain in the first section
+    if (ok) {
+	sos[0] *= gain;
+	sos[1] *= gain;
+	sos[2] *= gain;
+    }
+
+    free( c );
+    free( p );
+    free( z );
+    free( used_p );
+    free( used_z );
+
+    return ok ? n_sections : 0;
+}
+
+// Create a single input signal SOS filter from a transfer function (the
+// same parameters as IIR_S_create), converted with IIR_tf2sos
+// Returns the filter or NULL upon error
+inline IIR_SOS_t *IIR_SOS_create_from_tf(int n_coefs,
+					 const IIR_signal_t *b_coefs,
+					 const IIR_signal_t *a_coefs) {
+
+    if (n_coefs <= 1) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a filter with not enough coefficients (%d). Min is 2.\n",
+		n_coefs
+		);
+	return NULL;
+    }
+
+    IIR_signal_t *sos = (IIR_signal_t*) malloc(sizeof (IIR_signal_t) * IIR_SOS_N_SECTIONS(n_coefs) * IIR_SOS_INPUT_COEFS);
+    if ( !sos ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for the sections.\n" );
+	return NULL;
+    }
+
+    IIR_SOS_t *filter = NULL;
+    int n_sections = IIR_tf2sos(n_coefs, b_coefs, a_coefs, sos);
+    if (n_sections) {
+	filter = IIR_SOS_create(n_sections, sos);
+    } else {
+	fprintf( stderr, "IIR ERROR: unable to convert the transfer function to sections.\n" );
+    }
+
+    free( sos );
+
+    return filter;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIR_SOS_FILTERS_H */
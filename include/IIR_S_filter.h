@@ -39,12 +39,106 @@ typedef struct {
     IIR_signal_t *b;
     IIR_signal_t *z;
     IIR_signal_t last_output;
+    int ss_block_size;
+    IIR_signal_t *_ss;
+    IIR_S_ss_kernel_t _ss_kernel;
+    int structure;
+    IIR_signal_t *_lattice;
+    IIR_step_kernel_t _step;
+    IIR_signal_t *_z_block;
 } IIR_S_t;
 
+// The filter is one block of memory aligned to IIR_SIMD_ALIGNMENT bytes:
+// the IIR_S_t structure followed by the a, b and z arrays, each one starting
+// at an aligned address. A small filter is then a few contiguous cache lines
+// and only one allocation. _z_block is the z array of the block: structures
+// needing a bigger state (IIR_STRUCTURE_DF1), the lattice coefs and the
+// block state-space matrices are allocated apart.
+// Offset (bytes) of the a array in the block
+#define _IIR_S_BLOCK_A_OFFSET _IIR_ALIGNED_SIZE(sizeof (IIR_S_t))
+// Size (bytes) of each one of the a, b and z arrays in the block
+#define _IIR_S_BLOCK_ARRAY_SIZE(n_coefs) _IIR_ALIGNED_SIZE(sizeof (IIR_signal_t) * (n_coefs))
+// Size (bytes) of the whole block
+#define _IIR_S_BLOCK_SIZE(n_coefs) (_IIR_S_BLOCK_A_OFFSET + 3 * _IIR_S_BLOCK_ARRAY_SIZE(n_coefs))
+
+// A couple of forward declarations are needed
+inline int IIR_S_set_state_space_block(IIR_S_t *filter, int block_size);
+inline void IIR_S_destroy(IIR_S_t *filter);
+
+// Number of bytes needed to build a filter with n_coefs coefficients in
+// caller memory (see IIR_S_init). Returns 0 if n_coefs < 2
+inline size_t IIR_S_required_bytes(int n_coefs) {
+
+    if (n_coefs <= 1) {
+	return 0;
+    }
+
+    return _IIR_S_BLOCK_SIZE(n_coefs);
+}
+
+// Build a single input signal IIR filter inside the caller memory (buffer),
+// without allocating memory nor printing anything. Same filter as
+// IIR_S_create, which uses it, so it can live in preallocated, shared or
+// stack memory.
+// Parameters:
+//	buffer: IIR_S_required_bytes(n_coefs) bytes, aligned to
+//	    IIR_SIMD_ALIGNMENT bytes. It holds the whole filter
+//	n_coefs: number of coefficients (order+1)
+//	b_coefs, a_coefs: a and b coefficients arrays. They must hold
+//	    n_coefs values each. They are normalized
+// Returns:
+//    The filter (at the start of buffer), initialized to rest state, or
+//    NULL upon error (not enough coefficients, NULL or misaligned buffer)
+// Do not call IIR_S_destroy for it, but IIR_S_deinit if other structures
+// than IIR_STRUCTURE_TDF2/IIR_STRUCTURE_DF2 or the block state-space mode
+// were used (they allocate memory apart from the buffer)
+inline IIR_S_t *IIR_S_init(void *buffer,
+			   int n_coefs,
+			   const IIR_signal_t *b_coefs,
+			   const IIR_signal_t *a_coefs) {
+
+    // Minimum is order 1, which means two coefs
+    if ( (n_coefs <= 1) || !buffer || ((size_t)buffer % IIR_SIMD_ALIGNMENT) ) {
+	return NULL;
+    }
+
+    char *block = (char*) buffer;
+    IIR_S_t *filter = (IIR_S_t*) block;
+    size_t array_size = _IIR_S_BLOCK_ARRAY_SIZE(n_coefs);
+    filter->n_coefs = n_coefs;
+    int coefs_byte_size = sizeof (IIR_signal_t) * n_coefs;
+    filter->a = (IIR_signal_t*) (block + _IIR_S_BLOCK_A_OFFSET);
+    filter->b = (IIR_signal_t*) (block + _IIR_S_BLOCK_A_OFFSET + array_size);
+    filter->z = (IIR_signal_t*) (block + _IIR_S_BLOCK_A_OFFSET + 2*array_size);
+    filter->_z_block = filter->z;
+
+    // Initialize the state vector
+    memset( filter->z, 0, coefs_byte_size );
+    
+    memcpy( filter->a, a_coefs, coefs_byte_size );
+    memcpy( filter->b, b_coefs, coefs_byte_size );
+    
+    IIR_normalize_coefs( n_coefs, filter->b, filter->a );
+        
+    // Not valid yet, but initialize!
+    filter->last_output = 0;
+
+    // Block state-space mode disabled
+    filter->ss_block_size = 0;
+    filter->_ss = NULL;
+    filter->_ss_kernel = NULL;
+
+    // Transposed direct form II (see IIR_S_set_structure)
+    filter->structure = IIR_STRUCTURE_TDF2;
+    filter->_lattice = NULL;
+    filter->_step = _IIR_step_tdf2_fast;
+    
+    return filter;
+}
+
 // Create a single input signal IIR filter.
 // Parameters:
 //	n_coefs: number of coefficients (order+1)
-//	n_signals: number of input signals
 //	b_coefs, a_coefs: a and b coefficients arrays. They must hold
 //	    n_coefs values each
 // Returns:
@@ -63,37 +157,124 @@ inline IIR_S_t *IIR_S_create(int n_coefs,
 	return NULL;
     }
 
-    IIR_S_t *filter = (IIR_S_t*)malloc(sizeof (IIR_S_t));
-    if ( !filter ){
+    // One block for the structure and the a, b and z arrays
+    void *block = _IIR_aligned_malloc( IIR_S_required_bytes(n_coefs) );
+    if ( !block ){
 	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter.\n" );
 	return NULL;
     }
 
-    filter->n_coefs = n_coefs;
-    int coefs_byte_size = sizeof (IIR_signal_t) * n_coefs;
-    filter->a = (IIR_signal_t*)malloc( coefs_byte_size );
-    filter->b = (IIR_signal_t*)malloc( coefs_byte_size );
-    filter->z = (IIR_signal_t*)malloc( coefs_byte_size );
-    if ( !filter->a || !filter->b || !filter->z ){
-	free( filter );
-	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter a, b or z arrays.\n" );
-	return NULL;
+    return IIR_S_init(block, n_coefs, b_coefs, a_coefs);
+}
+
+// Select the filter structure (IIR_STRUCTURE_*, see IIR_structures.h). The
+// state is reset (its size and meaning depend on the structure). The lattice
+// coefs are computed from the current a and b coefs, so call it again if
+// they are changed. Structures other than IIR_STRUCTURE_TDF2 disable the
+// block state-space mode, and IIR_S_process_scan filters them sequentially.
+// Returns 0 on fail (unknown structure, lattice structure of an unstable
+// filter or memory allocation problem; the filter is left unchanged), 1
+// otherwise
+inline int IIR_S_set_structure(IIR_S_t *filter, int structure) {
+
+    int n_coefs = filter->n_coefs;
+    IIR_step_kernel_t step = _IIR_select_step_kernel(structure);
+
+    if ( !step ){
+	fprintf( stderr, "IIR ERROR: trying to set an unsupported filter structure: %d.\n", structure );
+	return 0;
     }
 
-    // Initialize the state vector
-    memset( filter->z, 0, coefs_byte_size );
-    
-    memcpy( filter->a, a_coefs, coefs_byte_size );
-    memcpy( filter->b, b_coefs, coefs_byte_size );
-    
-    IIR_normalize_coefs( n_coefs, filter->b, filter->a );
-        
-    // Not valid yet, but initialize!
+    // The state is kept in the filter block if it fits
+    size_t state_size = sizeof (IIR_signal_t) * _IIR_STRUCTURE_STATE_SIZE(n_coefs, structure);
+    int z_in_block = _IIR_STRUCTURE_STATE_SIZE(n_coefs, structure) <= n_coefs;
+    IIR_signal_t *z = z_in_block ? filter->_z_block : (IIR_signal_t*) malloc( state_size );
+    IIR_signal_t *lattice = NULL;
+    if (structure == IIR_STRUCTURE_LATTICE) {
+	lattice = (IIR_signal_t*) malloc( sizeof (IIR_signal_t) * _IIR_LATTICE_COEFS_SIZE(n_coefs) );
+    }
+    if ( !z || ((structure == IIR_STRUCTURE_LATTICE) && !lattice) ){
+	if ( !z_in_block ){
+	    free( z );
+	}
+	free( lattice );
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for the filter structure.\n" );
+	return 0;
+    }
+    if ( lattice && !_IIR_lattice_coefs(n_coefs, filter->b, filter->a, lattice) ){
+	if ( !z_in_block ){
+	    free( z );
+	}
+	free( lattice );
+	fprintf( stderr, "IIR ERROR: the filter has no lattice structure (it is not stable).\n" );
+	return 0;
+    }
+
+    if (structure != IIR_STRUCTURE_TDF2) {
+	IIR_S_set_state_space_block(filter, 0);
+    }
+
+    memset( z, 0, state_size );
+    if ( filter->z != filter->_z_block ){
+	free( filter->z );
+    }
+    free( filter->_lattice );
+    filter->z = z;
+    filter->_lattice = lattice;
+    filter->_step = step;
+    filter->structure = structure;
     filter->last_output = 0;
-    
+
+    return 1;
+}
+
+// Same as IIR_S_create but with the given filter structure (see
+// IIR_S_set_structure)
+// Returns NULL upon error (see IIR_S_create and IIR_S_set_structure)
+inline IIR_S_t *IIR_S_create_structure(int n_coefs,
+				       const IIR_signal_t *b_coefs,
+				       const IIR_signal_t *a_coefs,
+				       int structure) {
+
+    IIR_S_t *filter = IIR_S_create(n_coefs, b_coefs, a_coefs);
+
+    if ( filter && (structure != IIR_STRUCTURE_TDF2)
+	 && !IIR_S_set_structure(filter, structure) ){
+	IIR_S_destroy(filter);
+	return NULL;
+    }
+
     return filter;
 }
 
+// Filter n inputs with the step kernel of a structure other than
+// IIR_STRUCTURE_TDF2, reading and writing with the given strides (as in
+// IIR_S_process_block_strided). Internal use.
+inline void _IIR_S_structure_process(IIR_S_t *filter,
+				     const IIR_signal_t *x,
+				     int x_stride,
+				     IIR_signal_t *y,
+				     int y_stride,
+				     int n) {
+
+    int i;
+    int n_coefs = filter->n_coefs;
+    IIR_step_kernel_t step = filter->_step;
+    IIR_signal_t *s = filter->z;
+    const IIR_signal_t *a = filter->_lattice ? filter->_lattice : filter->a;
+    const IIR_signal_t *b = filter->_lattice ? filter->_lattice + n_coefs : filter->b;
+    IIR_signal_t y_i = filter->last_output;
+
+    for (i = 0; i < n; i++){
+	y_i = step(n_coefs, a, b, s, *x);
+	*y = y_i;
+	x += x_stride;
+	y += y_stride;
+    }
+
+    filter->last_output = y_i;
+}
+
 // Returns the last output of the filter
 #define IIR_S_get_last_output(filter) (filter->last_output)
 
@@ -101,38 +282,576 @@ inline IIR_S_t *IIR_S_create(int n_coefs,
 // HUGE gain by declaring this as inline!
 inline IIR_signal_t IIR_S_add_input(IIR_S_t *filter, IIR_signal_t x) {
 
-    int j;
-    
     IIR_signal_t *y = &filter->last_output;
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_S_structure_process(filter, &x, 1, y, 1, 1);
+	return *y;
+    }
+
+    // Unrolled for order 1 to 4 filters (see _IIR_step_tdf2_fast)
+    *y = _IIR_step_tdf2_fast(filter->n_coefs, filter->a, filter->b, filter->z, x);
+    
+    return *y;
+
+}
+
+// Block state-space mode
+// The filter is the state-space system (N = n_coefs-1 states, z[0..N-1])
+//	z' = A z + B x		y = z[0] + b[0] x
+// with A[i][0] = -a[i+1], A[i][i+1] = 1 and B[i] = b[i+1] - a[i+1]*b[0].
+// Unrolling it L (block size) times gives the outputs and the final state of
+// a whole block as one matrix-vector product G [z; x[0..L-1]]:
+//	y[k] = (C A^k) z + sum_{m<=k} h[k-m] x[m]	(h: impulse response)
+//	z_L = A^L z + sum_m (A^(L-1-m) B) x[m]
+// That is more multiply-adds per output (about N+L/2, plus N*(N+L)/L for the
+// state) than the 2*N of IIR_S_add_input, but without the dependency of each
+// output on the previous one, so they are done with vector instructions and
+// long single signals are filtered faster (with AVX2 or AVX-512). Results
+// differ from IIR_S_add_input by rounding errors only (the matrices are
+// computed in double precision).
+
+// Suggested block size for IIR_S_set_state_space_block
+#define IIR_S_STATE_SPACE_BLOCK 32
+
+// Number of rows of G, padded to a multiple of IIR_SIMD_SIGNALS
+#define _IIR_S_SS_PADDED(n) (((n) + IIR_SIMD_SIGNALS - 1) / IIR_SIMD_SIGNALS * IIR_SIMD_SIGNALS)
+
+// G (first the L output rows, then the N state rows, each part padded) is
+// stored by groups of IIR_SIMD_SIGNALS rows, each group column by column:
+// G[r][c] is _ss[((r/IIR_SIMD_SIGNALS)*(N+L) + c)*IIR_SIMD_SIGNALS + r%IIR_SIMD_SIGNALS]
+// It is followed by the scratch arrays v (N+L values) and out (one value
+// per row of G)
+#define _IIR_S_SS_G_SIZE(N, L) ((_IIR_S_SS_PADDED(L) + _IIR_S_SS_PADDED(N)) * ((N)+(L)))
+#define _IIR_S_SS_SIZE(N, L) (_IIR_S_SS_G_SIZE(N, L) + ((N)+(L)) + _IIR_S_SS_PADDED(L) + _IIR_S_SS_PADDED(N))
+
+// Enable the block state-space mode in IIR_S_process_block (and
+// IIR_S_process_in_place) with blocks of block_size outputs, or disable it
+// with block_size 0. The filter state is shared with the other functions, so
+// they can be freely mixed. Call it again if the coefficients are changed.
+// The matrix-vector product uses the best vector kernel for the CPU (see
+// IIR_simd_kernels.h).
+// Only for the IIR_STRUCTURE_TDF2 structure (the default).
+// Returns 0 on fail (negative block_size, other filter structure or memory
+// allocation problem), 1 otherwise
+inline int IIR_S_set_state_space_block(IIR_S_t *filter, int block_size) {
+
+    int i, j, k;
+    int N = filter->n_coefs - 1;
+    int L = block_size;
+    int n_cols = N + L;
+    int Lp = _IIR_S_SS_PADDED(L);
+    const IIR_signal_t *a = filter->a;
+    const IIR_signal_t *b = filter->b;
+
+    if ( (block_size < 0) || ((block_size > 0) && (filter->structure != IIR_STRUCTURE_TDF2)) ) {
+	return 0;
+    }
+
+    free( filter->_ss );
+    filter->_ss = NULL;
+    filter->ss_block_size = 0;
+
+    if (block_size == 0) {
+	return 1;
+    }
+
+    size_t ss_size = sizeof(IIR_signal_t) * _IIR_S_SS_SIZE(N, L);
+    IIR_signal_t *ss = (IIR_signal_t*) _IIR_aligned_malloc( ss_size );
+    double *row = (double*) malloc( sizeof(double) * N );
+    double *col = (double*) malloc( sizeof(double) * (N+1) );
+    double *next = (double*) malloc( sizeof(double) * N );
+    double *h = (double*) malloc( sizeof(double) * L );
+    if ( !ss || !row || !col || !next || !h ){
+	free( ss );
+	free( row );
+	free( col );
+	free( next );
+	free( h );
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for the state-space matrices.\n" );
+	return 0;
+    }
+    memset( ss, 0, ss_size );
+
+    #define _IIR_S_SS_G(r, c) ss[( ((r)/IIR_SIMD_SIGNALS)*n_cols + (c) )*IIR_SIMD_SIGNALS + (r)%IIR_SIMD_SIGNALS]
+
+    // Output rows: C A^k (row' = row A) for the state and the impulse
+    // response h[k+1] = C A^k B for the inputs
+    for (i = 0; i < N; i++){
+	row[i] = (i == 0);
+    }
+    h[0] = b[0];
+    for (k = 0; k < L; k++){
+	double h_k = 0, row_0 = 0;
+	for (i = 0; i < N; i++){
+	    _IIR_S_SS_G(k, i) = (IIR_signal_t) row[i];
+	    h_k += row[i] * ((double)b[i+1] - (double)a[i+1] * b[0]);
+	    row_0 -= row[i] * a[i+1];
+	}
+	if (k+1 < L){
+	    h[k+1] = h_k;
+	}
+	for (i = N-1; i > 0; i--){
+	    row[i] = row[i-1];
+	}
+	row[0] = row_0;
+    }
+    for (k = 0; k < L; k++){
+	for (j = 0; j <= k; j++){
+	    _IIR_S_SS_G(k, N + j) = (IIR_signal_t) h[k-j];
+	}
+    }
+
+    // State rows, state columns: A^L e_j (col' = A col)
+    for (j = 0; j < N; j++){
+	for (i = 0; i <= N; i++){
+	    col[i] = (i == j);
+	}
+	for (k = 0; k < L; k++){
+	    for (i = 0; i < N; i++){
+		next[i] = col[i+1] - a[i+1] * col[0];
+	    }
+	    memcpy( col, next, sizeof(double) * N );
+	}
+	for (i = 0; i < N; i++){
+	    _IIR_S_SS_G(Lp + i, j) = (IIR_signal_t) col[i];
+	}
+    }
+
+    // State rows, input columns: A^(L-1-m) B, from the last input backwards
+    for (i = 0; i < N; i++){
+	col[i] = (double)b[i+1] - (double)a[i+1] * b[0];
+    }
+    col[N] = 0;
+    for (k = L-1; k >= 0; k--){
+	for (i = 0; i < N; i++){
+	    _IIR_S_SS_G(Lp + i, N + k) = (IIR_signal_t) col[i];
+	}
+	for (i = 0; i < N; i++){
+	    next[i] = col[i+1] - a[i+1] * col[0];
+	}
+	memcpy( col, next, sizeof(double) * N );
+    }
+
+    #undef _IIR_S_SS_G
+
+    free( row );
+    free( col );
+    free( next );
+    free( h );
+
+    filter->_ss = ss;
+    filter->_ss_kernel = _IIR_S_select_ss_kernel( IIR_simd_detect_level() );
+    filter->ss_block_size = block_size;
+
+    return 1;
+}
+
+// Filter one block of ss_block_size inputs with the state-space matrices.
+// Internal use. y can be the same array as x.
+inline void _IIR_S_state_space_block(IIR_S_t *filter,
+				     const IIR_signal_t *x,
+				     IIR_signal_t *y) {
+
+    int N = filter->n_coefs - 1;
+    int L = filter->ss_block_size;
+    int n_cols = N + L;
+    int Lp = _IIR_S_SS_PADDED(L);
+    IIR_signal_t *v = filter->_ss + _IIR_S_SS_G_SIZE(N, L);
+    IIR_signal_t *out = v + n_cols;
+
+    // out = G [z; x]
+    memcpy( v, filter->z, sizeof(IIR_signal_t) * N );
+    memcpy( v + N, x, sizeof(IIR_signal_t) * L );
+    filter->_ss_kernel( filter->_ss, v, out, Lp + _IIR_S_SS_PADDED(N), n_cols, L, N );
+
+    memcpy( filter->z, out + Lp, sizeof(IIR_signal_t) * N );
+    memcpy( y, out, sizeof(IIR_signal_t) * L );
+    filter->last_output = out[L-1];
+}
+
+// Max n_coefs for which IIR_S_process_block keeps the state in a local copy
+// (bigger filters update filter->z directly)
+#define IIR_S_BLOCK_LOCAL_COEFS 32
+
+// Filter a block of n inputs (x) and store the corresponding outputs in y.
+// Produces exactly the same outputs as calling IIR_S_add_input once for each
+// input, but the filter fields are read only once per block, and the state
+// (up to IIR_S_BLOCK_LOCAL_COEFS coefs) and the last output are only written
+// back at the end of the block.
+// Both x and y must hold n values each. y can be the same array as x
+// (in-place filtering): each input is read before its output is written.
+// If the block state-space mode is enabled (IIR_S_set_state_space_block),
+// whole blocks of ss_block_size inputs are filtered with it (outputs then
+// differ from IIR_S_add_input by rounding errors only).
+// Returns 0 on fail (NULL arrays or negative n), 1 otherwise
+inline int IIR_S_process_block(IIR_S_t *filter,
+			       const IIR_signal_t *x,
+			       IIR_signal_t *y,
+			       int n) {
+
+    int i;
+
+    if ( (!x) || (!y) || (n < 0) ) {
+	return 0;
+    }
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_S_structure_process(filter, x, 1, y, 1, n);
+	return 1;
+    }
+
+    if (filter->ss_block_size > 0) {
+	int L = filter->ss_block_size;
+	for ( ; n >= L; n -= L){
+	    _IIR_S_state_space_block(filter, x, y);
+	    x += L;
+	    y += L;
+	}
+    }
+
+    const IIR_signal_t *IIR_RESTRICT a = filter->a;
+    const IIR_signal_t *IIR_RESTRICT b = filter->b;
+    int n_coefs = filter->n_coefs;
+    IIR_signal_t y_i = filter->last_output;
+
+    if ( (n == 0) || (n_coefs > IIR_S_BLOCK_LOCAL_COEFS) ) {
+	for (i = 0; i < n; i++){
+	    y_i = _IIR_step_tdf2_fast(n_coefs, a, b, filter->z, x[i]);
+	    y[i] = y_i;
+	}
+    } else {
+	// Local copy of the state: y can not alias it, so it is not reloaded
+	// after each output is stored (and it is kept in registers for the
+	// unrolled orders). Written back once at the end of the block
+	IIR_signal_t z[IIR_S_BLOCK_LOCAL_COEFS];
+	memcpy( z, filter->z, sizeof (IIR_signal_t) * (n_coefs-1) );
+	switch (n_coefs) {
+	    case 2:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_2(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    case 3:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_3(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    case 4:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_4(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    case 5:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_5(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    case 6:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_6(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    case 7:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_7(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    case 8:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_8(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    case 9:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2_9(a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+		break;
+	    default:
+		for (i = 0; i < n; i++){
+		    y_i = _IIR_step_tdf2(n_coefs, a, b, z, x[i]);
+		    y[i] = y_i;
+		}
+	}
+	memcpy( filter->z, z, sizeof (IIR_signal_t) * (n_coefs-1) );
+    }
+
+    filter->last_output = y_i;
+
+    return 1;
+}
+
+// Filter a block of n inputs in place: each value in xy is replaced by the
+// corresponding output. No extra output buffer is needed, which halves the
+// memory used (and streamed through cache) when filtering big buffers.
+// Returns 0 on fail (NULL array or negative n), 1 otherwise
+inline int IIR_S_process_in_place(IIR_S_t *filter, IIR_signal_t *xy, int n) {
+
+    return IIR_S_process_block(filter, xy, xy, n);
+}
+
+// Filter a block of n inputs (x) and store the corresponding outputs in y,
+// reading and writing with the given strides (in number of values, not
+// bytes). That is, input i is x[i*x_stride] and output i is y[i*y_stride].
+// This allows filtering one channel of an interleaved buffer or writing to
+// a column of a matrix without copies. Unit strides use IIR_S_process_block.
+// In-place filtering (y == x) is supported when x_stride == y_stride.
+// Returns 0 on fail (NULL arrays or negative n), 1 otherwise
+inline int IIR_S_process_block_strided(IIR_S_t *filter,
+				       const IIR_signal_t *x,
+				       int x_stride,
+				       IIR_signal_t *y,
+				       int y_stride,
+				       int n) {
+
+    int i;
+
+    if ( (x_stride == 1) && (y_stride == 1) ) {
+	return IIR_S_process_block(filter, x, y, n);
+    }
+
+    if ( (!x) || (!y) || (n < 0) ) {
+	return 0;
+    }
+
+    if (filter->structure != IIR_STRUCTURE_TDF2) {
+	_IIR_S_structure_process(filter, x, x_stride, y, y_stride, n);
+	return 1;
+    }
+
     IIR_signal_t *z = filter->z;
-    IIR_signal_t *a = filter->a;
-    IIR_signal_t *b = filter->b;    
+    const IIR_signal_t *a = filter->a;
+    const IIR_signal_t *b = filter->b;
     int n_coefs = filter->n_coefs;
+    IIR_signal_t x_i, y_i = filter->last_output;
+
+    for (i = 0; i < n; i++){
+	x_i = *x;
+	y_i = _IIR_step_tdf2_fast(n_coefs, a, b, z, x_i);
+	*y = y_i;
+	x += x_stride;
+	y += y_stride;
+    }
+
+    filter->last_output = y_i;
+
+    return 1;
+}
+
+// Parallel-prefix (scan) filtering for order 1 and 2 filters
+// The signal is split in equal chunks that are first filtered independently
+// from a zero state (IIR_S_SCAN_LANES chunks at a time in lockstep, so the
+// loops across chunks use vector instructions, and each group of chunks on
+// a different thread with OpenMP). As the filter is linear, the output is
+// that plus the response to the true initial state of each chunk, which is
+// found by composing the chunk final states: S_{j+1} = A^len S_j + F_j
+// (A: state transition matrix, F_j: final state from zero). A last pass adds
+// those responses (again in parallel).
+
+// Chunks filtered together with vector instructions
+#define IIR_S_SCAN_LANES (4*IIR_SIMD_SIGNALS)
+
+// Samples of each chunk transposed at a time (so each lane is contiguous)
+#define IIR_S_SCAN_TILE 16
+
+// Minimum chunk length. Shorter signals are filtered sequentially
+#define IIR_S_SCAN_MIN_LEN 256
+
+// Filter lanes chunks of len samples in lockstep (order 1 or 2, a and b
+// with 3 coefs). Chunk l is x[l*len .. l*len+len-1] and its states are
+// z0[l], z1[l]. If x is NULL the inputs are 0 and the outputs are added to
+// y instead of stored (response to the initial states). Internal use.
+inline void _IIR_S_scan_lanes(const IIR_signal_t *a, const IIR_signal_t *b,
+			      const IIR_signal_t *x, IIR_signal_t *y,
+			      int len, int lanes,
+			      IIR_signal_t *IIR_RESTRICT z0,
+			      IIR_signal_t *IIR_RESTRICT z1) {
+
+    int i, i0, l, n_tile;
+    IIR_signal_t buf[IIR_S_SCAN_TILE][IIR_S_SCAN_LANES];
+    IIR_signal_t a1 = a[1], a2 = a[2], b0 = b[0], b1 = b[1], b2 = b[2];
 
-    *y = z[0] + b[0] * x;
+    for (i0 = 0; i0 < len; i0 += IIR_S_SCAN_TILE){
+	n_tile = (len - i0 < IIR_S_SCAN_TILE) ? len - i0 : IIR_S_SCAN_TILE;
 
-    for (j = 1; j< n_coefs-1 ; j++){
-	z[j-1] = z[j] + x * b[j] - (*y) * a[j];
+	for (l = 0; l < lanes; l++){
+	    for (i = 0; i < n_tile; i++){
+		buf[i][l] = x ? x[l*len + i0 + i] : 0;
+	    }
+	}
+
+	for (i = 0; i < n_tile; i++){
+	    IIR_signal_t *IIR_RESTRICT buf_i = buf[i];
+	    for (l = 0; l < lanes; l++){
+		IIR_signal_t x_l = buf_i[l];
+		IIR_signal_t y_l = z0[l] + b0 * x_l;
+		z0[l] = z1[l] + x_l * b1 - y_l * a1;
+		z1[l] = x_l * b2 - y_l * a2;
+		buf_i[l] = y_l;
+	    }
+	}
+
+	for (l = 0; l < lanes; l++){
+	    IIR_signal_t *y_l = y + l*len + i0;
+	    if (x) {
+		for (i = 0; i < n_tile; i++){
+		    y_l[i] = buf[i][l];
+		}
+	    } else {
+		for (i = 0; i < n_tile; i++){
+		    y_l[i] += buf[i][l];
+		}
+	    }
+	}
     }
-    z[j-1] = x * b[j] - (*y) * a[j];
-    
-    return *y;
-    
+}
+
+// Filter n inputs (x) of an order 1 or 2 filter (n_coefs 2 or 3) and store
+// the outputs in y, splitting the signal in chunks filtered in parallel
+// (see above). Intended for very long signals: it filters each sample twice
+// (once with input, once with only the initial state) but with vector
+// instructions and as many threads as OpenMP provides (when compiled with
+// -fopenmp). The last n % (chunks) inputs and signals shorter than
+// IIR_S_SCAN_LANES*IIR_S_SCAN_MIN_LEN are filtered sequentially, as are
+// the filters with a structure other than IIR_STRUCTURE_TDF2.
+// Outputs differ from IIR_S_add_input by rounding errors only. The filter
+// state and last output are updated, so it can be mixed with the other
+// functions. y can be the same array as x.
+// Returns 0 on fail (not an order 1 or 2 filter, NULL arrays, negative n or
+// memory allocation problem), 1 otherwise
+inline int IIR_S_process_scan(IIR_S_t *filter,
+			      const IIR_signal_t *x,
+			      IIR_signal_t *y,
+			      int n) {
+
+    int g, j;
+    int order = filter->n_coefs - 1;
+
+    if ( (order < 1) || (order > 2) || (!x) || (!y) || (n < 0) ) {
+	return 0;
+    }
+
+    int n_groups = 1;
+#ifdef _OPENMP
+    n_groups = omp_get_max_threads();
+#endif
+    while ( (n_groups > 1) && (n < n_groups * IIR_S_SCAN_LANES * IIR_S_SCAN_MIN_LEN) ){
+	n_groups--;
+    }
+    if ( (n < IIR_S_SCAN_LANES * IIR_S_SCAN_MIN_LEN) || (filter->structure != IIR_STRUCTURE_TDF2) ) {
+	return IIR_S_process_block(filter, x, y, n);
+    }
+
+    int n_chunks = n_groups * IIR_S_SCAN_LANES;
+    int len = n / n_chunks;
+
+    // Order 1 filters are order 2 filters with a[2] = b[2] = 0
+    IIR_signal_t a[3] = { 1, filter->a[1], (order == 2) ? filter->a[2] : 0 };
+    IIR_signal_t b[3] = { filter->b[0], filter->b[1], (order == 2) ? filter->b[2] : 0 };
+
+    IIR_signal_t *z = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * 2 * n_chunks );
+    if ( !z ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for the scan states.\n" );
+	return 0;
+    }
+    IIR_signal_t *z0 = z, *z1 = z + n_chunks;
+
+    // 1: every chunk from a zero state. Leaves its final state in z0, z1
+    memset( z, 0, sizeof(IIR_signal_t) * 2 * n_chunks );
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(n_groups)
+#endif
+    for (g = 0; g < n_groups; g++){
+	int c0 = g * IIR_S_SCAN_LANES;
+	_IIR_S_scan_lanes(a, b, x + c0*len, y + c0*len, len, IIR_S_SCAN_LANES,
+			  z0 + c0, z1 + c0);
+    }
+
+    // 2: initial state of every chunk, S_{j+1} = A^len S_j + F_j (double
+    // precision), with A = [-a1 1; -a2 0] and A^len found by squaring
+    double P[2][2] = { {1, 0}, {0, 1} }, Q[2][2] = { {-a[1], 1}, {-a[2], 0} }, T[2][2];
+    int e;
+    for (e = len; e > 0; e >>= 1){
+	if (e & 1) {
+	    T[0][0] = P[0][0]*Q[0][0] + P[0][1]*Q[1][0];
+	    T[0][1] = P[0][0]*Q[0][1] + P[0][1]*Q[1][1];
+	    T[1][0] = P[1][0]*Q[0][0] + P[1][1]*Q[1][0];
+	    T[1][1] = P[1][0]*Q[0][1] + P[1][1]*Q[1][1];
+	    memcpy( P, T, sizeof(T) );
+	}
+	T[0][0] = Q[0][0]*Q[0][0] + Q[0][1]*Q[1][0];
+	T[0][1] = Q[0][0]*Q[0][1] + Q[0][1]*Q[1][1];
+	T[1][0] = Q[1][0]*Q[0][0] + Q[1][1]*Q[1][0];
+	T[1][1] = Q[1][0]*Q[0][1] + Q[1][1]*Q[1][1];
+	memcpy( Q, T, sizeof(T) );
+    }
+    double s0 = filter->z[0], s1 = (order == 2) ? filter->z[1] : 0;
+    for (j = 0; j < n_chunks; j++){
+	double f0 = z0[j], f1 = z1[j];
+	z0[j] = (IIR_signal_t) s0;
+	z1[j] = (IIR_signal_t) s1;
+	double t0 = P[0][0]*s0 + P[0][1]*s1 + f0;
+	s1 = P[1][0]*s0 + P[1][1]*s1 + f1;
+	s0 = t0;
+    }
+
+    // 3: add the response to the initial state of every chunk
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(n_groups)
+#endif
+    for (g = 0; g < n_groups; g++){
+	int c0 = g * IIR_S_SCAN_LANES;
+	_IIR_S_scan_lanes(a, b, NULL, y + c0*len, len, IIR_S_SCAN_LANES,
+			  z0 + c0, z1 + c0);
+    }
+
+    free( z );
+
+    filter->z[0] = (IIR_signal_t) s0;
+    if (order == 2) {
+	filter->z[1] = (IIR_signal_t) s1;
+    }
+    filter->last_output = y[n_chunks*len - 1];
+
+    // Remaining inputs
+    return IIR_S_process_block(filter, x + n_chunks*len, y + n_chunks*len, n - n_chunks*len);
 }
 
 // Reset the filter to the resting state
 // Just return all previous states and last output to 0
 inline void IIR_S_reset(IIR_S_t *filter) {
-    memset( filter->z, 0, sizeof (IIR_signal_t) * filter->n_coefs );
+    memset( filter->z, 0, sizeof (IIR_signal_t) * _IIR_STRUCTURE_STATE_SIZE(filter->n_coefs, filter->structure) );
     filter->last_output = 0;
 }
 
+// Free the memory allocated by the filter apart from its block (state of
+// IIR_STRUCTURE_DF1, lattice coefs and block state-space matrices), but not
+// the block. For filters built with IIR_S_init: the caller owns the buffer
+inline void IIR_S_deinit(IIR_S_t *filter) {
+
+    if (filter->z != filter->_z_block) {
+	free(filter->z);
+    }
+    free(filter->_ss);
+    free(filter->_lattice);
+    filter->z = filter->_z_block;
+    filter->_ss = NULL;
+    filter->_lattice = NULL;
+}
+
 // Free all the memory allocated by the filter
 inline void IIR_S_destroy(IIR_S_t *filter) {
 
-    free(filter->a);
-    free(filter->b);
-    free(filter->z);
+    IIR_S_deinit(filter);
+    // The a, b and z arrays are in the same block
     free(filter);
 }
 
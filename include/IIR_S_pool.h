@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 1:10 AM
+ */
+
+// Pool of one input signal filters with the same number of coefficients.
+// Each filter is one slot of IIR_S_required_bytes(n_coefs) bytes (see
+// IIR_S_init) in big aligned slabs, so creating and destroying filters is
+// O(1) and does not call malloc (but when a new slab is needed): freed slots
+// are kept in a free list (linked through the slots themselves) and
+// reused, and never used slots are handed out in order from the last slab.
+// Each slot ends with an in-use flag, so that a reset or the destruction of
+// the pool can free the memory allocated apart from the slots by the live
+// filters (see IIR_S_deinit).
+
+#ifndef IIR_S_POOL_H
+#define IIR_S_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "IIR_filters.h"
+
+// Default number of filters of each slab
+#define IIR_S_POOL_SLAB_SLOTS 256
+
+// In-use flag of a slot (after the filter). Internal use
+#define _IIR_S_POOL_IN_USE(pool, slot) (*(int*) ((char*) (slot) + (pool)->_in_use_offset))
+
+// Type for the structure holding the pool
+typedef struct {
+    int n_coefs;
+    int slab_slots;
+    size_t slot_bytes;
+    size_t _in_use_offset;
+    int n_filters;
+    char **slabs;
+    int n_slabs;
+    int _slabs_capacity;
+    int _slab;
+    int _slot;
+    void *_free_list;
+} IIR_S_pool_t;
+
+// Create an empty pool of filters with n_coefs coefficients
+// Parameters:
+//	n_coefs: number of coefficients (order+1) of every filter of the pool
+//	slab_slots: number of filters of each slab (0 for
+//	    IIR_S_POOL_SLAB_SLOTS). Slabs are allocated when needed
+// Returns:
+//    The pool or NULL upon error (not enough coefficients or memory
+//    allocation problem)
+inline IIR_S_pool_t *IIR_S_pool_create(int n_coefs, int slab_slots) {
+
+    if (n_coefs <= 1) {
+	fprintf(stderr,
+		"IIR ERROR: trying to create a filter pool with not enough coefficients (%d). Min is 2.\n",
+		n_coefs
+		);
+	return NULL;
+    }
+
+    IIR_S_pool_t *pool = (IIR_S_pool_t*) malloc(sizeof (IIR_S_pool_t));
+    if ( !pool ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter pool.\n" );
+	return NULL;
+    }
+
+    pool->n_coefs = n_coefs;
+    pool->slab_slots = (slab_slots > 0) ? slab_slots : IIR_S_POOL_SLAB_SLOTS;
+    pool->_in_use_offset = IIR_S_required_bytes(n_coefs);
+    pool->slot_bytes = _IIR_ALIGNED_SIZE(pool->_in_use_offset + sizeof (int));
+    pool->n_filters = 0;
+    pool->slabs = NULL;
+    pool->n_slabs = 0;
+    pool->_slabs_capacity = 0;
+    pool->_slab = 0;
+    pool->_slot = 0;
+    pool->_free_list = NULL;
+
+    return pool;
+}
+
+// Take a free slot of the pool (a new slab is allocated if all of them are
+// in use). Internal use.
+// Returns NULL upon error (memory allocation problem)
+inline void *_IIR_S_pool_take_slot(IIR_S_pool_t *pool) {
+
+    // Slots freed by IIR_S_pool_destroy_filter first
+    if (pool->_free_list) {
+	void *slot = pool->_free_list;
+	pool->_free_list = *(void**) slot;
+	return slot;
+    }
+
+    // Next slab (kept from before a reset or a new one)
+    if ( (pool->n_slabs == 0) || (pool->_slot == pool->slab_slots) ) {
+	if ( (pool->n_slabs > 0) && (pool->_slab + 1 < pool->n_slabs) ) {
+	    pool->_slab++;
+	} else {
+	    if (pool->n_slabs == pool->_slabs_capacity) {
+		int capacity = pool->_slabs_capacity ? 2*pool->_slabs_capacity : 8;
+		char **slabs = (char**) realloc(pool->slabs, sizeof (char*) * capacity);
+		if ( !slabs ){
+		    return NULL;
+		}
+		pool->slabs = slabs;
+		pool->_slabs_capacity = capacity;
+	    }
+	    char *slab = (char*) _IIR_aligned_malloc(pool->slot_bytes * pool->slab_slots);
+	    if ( !slab ){
+		return NULL;
+	    }
+	    pool->slabs[pool->n_slabs] = slab;
+	    pool->_slab = pool->n_slabs;
+	    pool->n_slabs++;
+	}
+	pool->_slot = 0;
+    }
+
+    return pool->slabs[pool->_slab] + pool->slot_bytes * (pool->_slot++);
+}
+
+// Create a filter of the pool (same as IIR_S_create with the pool n_coefs).
+// O(1): no memory is allocated but when a new slab is needed.
+// Returns NULL upon error (memory allocation problem)
+inline IIR_S_t *IIR_S_pool_create_filter(IIR_S_pool_t *pool,
+					 const IIR_signal_t *b_coefs,
+					 const IIR_signal_t *a_coefs) {
+
+    void *slot = _IIR_S_pool_take_slot(pool);
+    if ( !slot ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for filter pool slab.\n" );
+	return NULL;
+    }
+
+    pool->n_filters++;
+    _IIR_S_POOL_IN_USE(pool, slot) = 1;
+
+    return IIR_S_init(slot, pool->n_coefs, b_coefs, a_coefs);
+}
+
+// Return a filter created by IIR_S_pool_create_filter to the pool. O(1).
+// The memory the filter allocated apart from its slot (see IIR_S_deinit)
+// is freed
+inline void IIR_S_pool_destroy_filter(IIR_S_pool_t *pool, IIR_S_t *filter) {
+
+    IIR_S_deinit(filter);
+    _IIR_S_POOL_IN_USE(pool, filter) = 0;
+    *(void**) filter = pool->_free_list;
+    pool->_free_list = filter;
+    pool->n_filters--;
+}
+
+// Deinit the live filters of the pool (see IIR_S_deinit). Slots are handed
+// out in order, so only the slots before the current one of the current
+// slab have been used. Internal use
+inline void _IIR_S_pool_deinit_filters(IIR_S_pool_t *pool) {
+
+    int i, j;
+
+    for (i = 0; (i <= pool->_slab) && (i < pool->n_slabs); i++) {
+	int n_slots = (i < pool->_slab) ? pool->slab_slots : pool->_slot;
+	for (j = 0; j < n_slots; j++) {
+	    IIR_S_t *filter = (IIR_S_t*) (pool->slabs[i] + pool->slot_bytes * j);
+	    if (_IIR_S_POOL_IN_USE(pool, filter)) {
+		IIR_S_deinit(filter);
+		_IIR_S_POOL_IN_USE(pool, filter) = 0;
+	    }
+	}
+    }
+}
+
+// Return all the filters to the pool at once (they are not valid any
+// more), freeing their memory apart from the slots (see IIR_S_deinit). The
+// slabs are kept for the next filters
+inline void IIR_S_pool_reset(IIR_S_pool_t *pool) {
+
+    _IIR_S_pool_deinit_filters(pool);
+    pool->n_filters = 0;
+    pool->_slab = 0;
+    pool->_slot = 0;
+    pool->_free_list = NULL;
+}
+
+// Free all the memory of the pool, including its filters (see
+// IIR_S_pool_reset)
+inline void IIR_S_pool_destroy(IIR_S_pool_t *pool) {
+
+    int i;
+
+    _IIR_S_pool_deinit_filters(pool);
+    for (i = 0; i < pool->n_slabs; i++) {
+	free(pool->slabs[i]);
+    }
+    free(pool->slabs);
+    free(pool);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIR_S_POOL_H */
@@ -33,9 +33,11 @@
 #ifdef IIR_USE_SIGNAL_TYPE_DOUBLE
     #define IIR_SIGNAL_TYPE double
     #define IIR_SIGNAL_FORMAT "lf"
+    #define IIR_SIGNAL_EPSILON DBL_EPSILON
 #else
     #define IIR_SIGNAL_TYPE float
     #define IIR_SIGNAL_FORMAT "f"
+    #define IIR_SIGNAL_EPSILON FLT_EPSILON
 #endif
 
 #ifdef __cplusplus
@@ -49,6 +51,13 @@ typedef IIR_SIGNAL_TYPE IIR_signal_t;
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <float.h>
+
+// OpenMP is optional: it is only used to run IIR_S_process_scan on several
+// threads when compiling with -fopenmp
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
 
 // Common operation to normalize coefficients a and b so a[0] == 1.0
 // Operates directly on the arrays passed as parameters
@@ -77,12 +86,61 @@ inline int IIR_normalize_coefs( int n_coefs, IIR_signal_t *b_coefs, IIR_signal_t
     return 1;
 }
 
+// Alignment (in bytes) of the arrays used by the vectorized code paths.
+// 64 bytes is both a cache line and the width of an AVX-512 register
+#define IIR_SIMD_ALIGNMENT 64
+
+// Number of signals that fit in IIR_SIMD_ALIGNMENT bytes. Signal counts are
+// padded to a multiple of this in the coefficient major layouts
+#define IIR_SIMD_SIGNALS ((int)(IIR_SIMD_ALIGNMENT / sizeof(IIR_signal_t)))
+
+// restrict qualifier for the internal kernels (also usable from C++)
+#ifdef __cplusplus
+    #define IIR_RESTRICT __restrict
+#else
+    #define IIR_RESTRICT restrict
+#endif
+
+// n_bytes rounded up to a multiple of IIR_SIMD_ALIGNMENT. Arrays placed one
+// after the other with these sizes in an aligned block stay aligned
+#define _IIR_ALIGNED_SIZE(n_bytes) \
+    (((size_t)(n_bytes) + IIR_SIMD_ALIGNMENT - 1) & ~((size_t)IIR_SIMD_ALIGNMENT - 1))
+
+// Allocate n_bytes aligned to IIR_SIMD_ALIGNMENT. The memory is released
+// with free(). Returns NULL upon error
+inline void *_IIR_aligned_malloc( size_t n_bytes ){
+
+    // aligned_alloc needs a size multiple of the alignment
+    n_bytes = _IIR_ALIGNED_SIZE(n_bytes);
+
+    return aligned_alloc( IIR_SIMD_ALIGNMENT, n_bytes );
+}
+
+// Vectorized kernels for the multiple input signal filters
+#include "IIR_simd_kernels.h"
+
+// Filter structures (direct forms I and II, transposed direct form II and
+// lattice-ladder) for the one signal and the multiple signal filters
+#include "IIR_structures.h"
+
 // One input signal filters
 #include "IIR_S_filter.h"
 
+// Pools of one input signal filters
+#include "IIR_S_pool.h"
+
 // Multiple input signal filters
 #include "IIR_M_filters.h"
 
+// Multiple input signal filters with grouped (deduplicated) coefficients
+#include "IIR_MG_filters.h"
+
+// Multiple input signal filters with a different order for each signal
+#include "IIR_MV_filters.h"
+
+// Second order sections (cascade of biquads) filters
+#include "IIR_SOS_filters.h"
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 9:40 PM
+ */
+
+// C++ filters with the number of coefficients known at compile time
+// (C++11). They are the same transposed direct form II filters as
+// IIR_S_t, IIR_MS_t and IIR_MD_t (same operations in the same order, so
+// outputs match the C filters bit by bit), but with the coefs and state in
+// std::array members instead of heap arrays of n_coefs values. The filter
+// step is expanded by templates into straight line code, so its loop is
+// always fully unrolled and the state can stay in registers.
+//	IIR::Filter<T, N>: one signal (as IIR_S_t)
+//	IIR::MSFilter<T, N, C>: C signals sharing the coefs (as IIR_MS_t)
+//	IIR::MDFilter<T, N, C>: C signals, each one with its coefs (as IIR_MD_t)
+// T is the signal type (float or double) and N the number of coefficients
+// (order+1, min 2). This header does not depend on the C headers.
+
+#ifndef IIR_FILTERS_HPP
+#define IIR_FILTERS_HPP
+
+#include <array>
+#include <type_traits>
+
+namespace IIR {
+
+// Normalize the coefficients so that a[0] == 1.0 (same operations as
+// IIR_normalize_coefs). Returns false (and leaves them as they are) if
+// a[0] == 0
+template<class T, int N>
+inline bool normalize_coefs(std::array<T, N> &b, std::array<T, N> &a) {
+
+    T a0 = a[0];
+
+    if (a0 == 0) {
+	return false;
+    }
+
+    for (int i = 0; i < N; i++) {
+	a[i] = a[i]/a0;
+	b[i] = b[i]/a0;
+    }
+
+    return true;
+}
+
+namespace detail {
+
+// State update of one filter step, for coef J (the last one, N-1)
+//	z[J-1] = x*b[J] - y*a[J]
+template<class T, int N, int J>
+inline void tdf2_update(T *z, const T *a, const T *b, T x, T y, std::true_type) {
+
+    z[J-1] = x * b[J] - y * a[J];
+}
+
+// Same for coefs J < N-1, followed by the update for coef J+1
+//	z[J-1] = z[J] + x*b[J] - y*a[J]
+template<class T, int N, int J>
+inline void tdf2_update(T *z, const T *a, const T *b, T x, T y, std::false_type) {
+
+    z[J-1] = z[J] + x * b[J] - y * a[J];
+    tdf2_update<T, N, J+1>(z, a, b, x, y, std::integral_constant<bool, J+1 == N-1>());
+}
+
+// One filter step (same operations as IIR_S_add_input). Returns the output
+template<class T, int N>
+inline T tdf2_step(T *z, const T *a, const T *b, T x) {
+
+    T y = z[0] + b[0] * x;
+    tdf2_update<T, N, 1>(z, a, b, x, y, std::integral_constant<bool, N == 2>());
+
+    return y;
+}
+
+} // namespace detail
+
+// One input signal filter
+template<class T, int N>
+class Filter {
+
+    static_assert(N >= 2, "IIR::Filter needs at least 2 coefficients (order 1)");
+
+public:
+
+    static const int n_coefs = N;
+
+    // Create the filter with the b_coefs and a_coefs arrays (N values each).
+    // Coefs are normalized (see IIR_S_create)
+    Filter(const T *b_coefs, const T *a_coefs) {
+	set_coefs(b_coefs, a_coefs);
+	reset();
+    }
+
+    // Set and normalize the coefs (N values each). The state is kept.
+    // Returns false if a_coefs[0] == 0 (coefs set but not normalized)
+    bool set_coefs(const T *b_coefs, const T *a_coefs) {
+	for (int i = 0; i < N; i++) {
+	    a_[i] = a_coefs[i];
+	    b_[i] = b_coefs[i];
+	}
+	return normalize_coefs<T, N>(b_, a_);
+    }
+
+    // Add the next input (x) and return the corresponding output
+    T add_input(T x) {
+	last_output_ = detail::tdf2_step<T, N>(z_.data(), a_.data(), b_.data(), x);
+	return last_output_;
+    }
+
+    // Filter a block of n inputs (x) and store the outputs in y (same
+    // outputs as add_input). y can be the same array as x
+    void process_block(const T *x, T *y, int n) {
+	for (int i = 0; i < n; i++) {
+	    y[i] = add_input(x[i]);
+	}
+    }
+
+    // Back to the resting state
+    void reset() {
+	z_.fill(0);
+	last_output_ = 0;
+    }
+
+    T last_output() const { return last_output_; }
+    const std::array<T, N> &a() const { return a_; }
+    const std::array<T, N> &b() const { return b_; }
+    // State (N-1 values), can be saved and restored
+    std::array<T, N-1> &z() { return z_; }
+
+private:
+
+    std::array<T, N> a_;
+    std::array<T, N> b_;
+    std::array<T, N-1> z_;
+    T last_output_;
+};
+
+// C input signals filter with shared coefficients
+template<class T, int N, int C>
+class MSFilter {
+
+    static_assert(N >= 2, "IIR::MSFilter needs at least 2 coefficients (order 1)");
+    static_assert(C >= 1, "IIR::MSFilter needs at least 1 signal");
+
+public:
+
+    static const int n_coefs = N;
+    static const int n_signals = C;
+
+    // Create the filter with the b_coefs and a_coefs arrays (N values each).
+    // Coefs are normalized (see IIR_MS_create)
+    MSFilter(const T *b_coefs, const T *a_coefs) {
+	set_coefs(b_coefs, a_coefs);
+	reset();
+    }
+
+    // Set and normalize the coefs (N values each). The state is kept.
+    // Returns false if a_coefs[0] == 0 (coefs set but not normalized)
+    bool set_coefs(const T *b_coefs, const T *a_coefs) {
+	for (int i = 0; i < N; i++) {
+	    a_[i] = a_coefs[i];
+	    b_[i] = b_coefs[i];
+	}
+	return normalize_coefs<T, N>(b_, a_);
+    }
+
+    // Add the next input of each signal (x, C values) and return the
+    // outputs (C values, see last_output)
+    const T *add_input(const T *x) {
+	for (int k = 0; k < C; k++) {
+	    last_output_[k] = detail::tdf2_step<T, N>(z_[k].data(), a_.data(), b_.data(), x[k]);
+	}
+	return last_output_.data();
+    }
+
+    // Filter a block of n_frames frames (C values each, stored one after
+    // the other) and store the outputs in y. y can be the same array as x
+    void process_block(const T *x, T *y, int n_frames) {
+	for (int i = 0; i < n_frames; i++) {
+	    for (int k = 0; k < C; k++) {
+		y[i*C + k] = detail::tdf2_step<T, N>(z_[k].data(), a_.data(), b_.data(), x[i*C + k]);
+	    }
+	}
+	for (int k = 0; (k < C) && (n_frames > 0); k++) {
+	    last_output_[k] = y[(n_frames-1)*C + k];
+	}
+    }
+
+    // Back to the resting state
+    void reset() {
+	for (int k = 0; k < C; k++) {
+	    z_[k].fill(0);
+	}
+	last_output_.fill(0);
+    }
+
+    // Last outputs (C values)
+    const T *last_output() const { return last_output_.data(); }
+    const std::array<T, N> &a() const { return a_; }
+    const std::array<T, N> &b() const { return b_; }
+    // State of signal k (N-1 values), can be saved and restored
+    std::array<T, N-1> &z(int k) { return z_[k]; }
+
+private:
+
+    std::array<T, N> a_;
+    std::array<T, N> b_;
+    std::array<std::array<T, N-1>, C> z_;
+    std::array<T, C> last_output_;
+};
+
+// C input signals filter with different coefficients for each signal
+template<class T, int N, int C>
+class MDFilter {
+
+    static_assert(N >= 2, "IIR::MDFilter needs at least 2 coefficients (order 1)");
+    static_assert(C >= 1, "IIR::MDFilter needs at least 1 signal");
+
+public:
+
+    static const int n_coefs = N;
+    static const int n_signals = C;
+
+    // Create the filter with the same b_coefs and a_coefs arrays (N values
+    // each) for all the signals (see IIR_MD_create). Coefs are normalized
+    MDFilter(const T *b_coefs, const T *a_coefs) {
+	for (int k = 0; k < C; k++) {
+	    set_coefs_one_signal(b_coefs, a_coefs, k);
+	}
+	reset();
+    }
+
+    // Set and normalize the coefs (N values each) of signal k. The state is
+    // kept. Returns false if k is out of bounds or a_coefs[0] == 0 (coefs
+    // set but not normalized)
+    bool set_coefs_one_signal(const T *b_coefs, const T *a_coefs, int k) {
+	if ( (k < 0) || (k >= C) ) {
+	    return false;
+	}
+	for (int i = 0; i < N; i++) {
+	    a_[k][i] = a_coefs[i];
+	    b_[k][i] = b_coefs[i];
+	}
+	return normalize_coefs<T, N>(b_[k], a_[k]);
+    }
+
+    // Add the next input of each signal (x, C values) and return the
+    // outputs (C values, see last_output)
+    const T *add_input(const T *x) {
+	for (int k = 0; k < C; k++) {
+	    last_output_[k] = detail::tdf2_step<T, N>(z_[k].data(), a_[k].data(), b_[k].data(), x[k]);
+	}
+	return last_output_.data();
+    }
+
+    // Filter a block of n_frames frames (C values each, stored one after
+    // the other) and store the outputs in y. y can be the same array as x
+    void process_block(const T *x, T *y, int n_frames) {
+	for (int i = 0; i < n_frames; i++) {
+	    for (int k = 0; k < C; k++) {
+		y[i*C + k] = detail::tdf2_step<T, N>(z_[k].data(), a_[k].data(), b_[k].data(), x[i*C + k]);
+	    }
+	}
+	for (int k = 0; (k < C) && (n_frames > 0); k++) {
+	    last_output_[k] = y[(n_frames-1)*C + k];
+	}
+    }
+
+    // Back to the resting state
+    void reset() {
+	for (int k = 0; k < C; k++) {
+	    z_[k].fill(0);
+	}
+	last_output_.fill(0);
+    }
+
+    // Last outputs (C values)
+    const T *last_output() const { return last_output_.data(); }
+    const std::array<T, N> &a(int k) const { return a_[k]; }
+    const std::array<T, N> &b(int k) const { return b_[k]; }
+    // State of signal k (N-1 values), can be saved and restored
+    std::array<T, N-1> &z(int k) { return z_[k]; }
+
+private:
+
+    std::array<std::array<T, N>, C> a_;
+    std::array<std::array<T, N>, C> b_;
+    std::array<std::array<T, N-1>, C> z_;
+    std::array<T, C> last_output_;
+};
+
+} // namespace IIR
+
+#endif /* IIR_FILTERS_HPP */
@@ -0,0 +1,944 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 11:40 AM
+ */
+
+// Vectorized (SSE2, AVX2 and AVX-512) kernels for the coefficient major
+// multiple input signal filters (and, further on, for the multiple signal
+// second order sections filters and the block state-space mode of the one
+// signal filters). Each kernel computes one filter step for m signals, 2/4/8
+// (double) or 4/8/16 (float) signals per instruction, and finishes the
+// signals that do not fill a whole vector with the scalar code.
+//
+// The kernels work on plain arrays, with the coefficient major layout
+// described in IIR_M_filters.h:
+//	n_coefs: number of coefficients
+//	stride: distance between two coef rows (_padded_signals)
+//	a, b: shared coefs (n_coefs values, MS kernels) or coef rows starting at
+//	    the first signal (MD kernels)
+//	z: state rows starting at the first signal
+//	x: m inputs, y: m outputs (x and y must not overlap)
+//
+// The x86 kernels are compiled with GCC/clang target attributes, so there is
+// no need to compile the whole program with -mavx2 or -mavx512f. They are
+// never inlined into code compiled for a lower instruction set: each filter
+// calls the one selected at creation through a function pointer.
+//
+// By default the operations are done in the same order as in the scalar
+// code (a multiplication followed by an addition or subtraction, never
+// contracted into FMA instructions by the compiler, see _IIR_TARGET_AVX2) so
+// all the kernels produce exactly the same results with any compiler
+// options (-std=gnu*, C++). Define IIR_USE_FMA to use fused
+// multiply-add instructions in the AVX2 and AVX-512 kernels (faster, but the
+// results differ in the last bits).
+
+#ifndef IIR_SIMD_KERNELS_H
+#define IIR_SIMD_KERNELS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "IIR_filters.h"
+
+// Instruction set levels for the kernels
+#define IIR_SIMD_LEVEL_SCALAR 0
+#define IIR_SIMD_LEVEL_SSE2 1
+#define IIR_SIMD_LEVEL_AVX2 2
+#define IIR_SIMD_LEVEL_AVX512 3
+
+// x86 kernels are only available with GCC compatible compilers
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) )
+    #define IIR_HAVE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+// Highest instruction set the filters may use. By default every kernel is
+// compiled in and the best one supported by the CPU running the program is
+// selected when each filter is created (see IIR_simd_detect_level), so one
+// binary runs everywhere. Define IIR_SIMD_LEVEL before including
+// IIR_filters.h to leave the higher kernels out.
+#ifndef IIR_SIMD_LEVEL
+    #ifdef IIR_HAVE_X86_KERNELS
+	#define IIR_SIMD_LEVEL IIR_SIMD_LEVEL_AVX512
+    #else
+	#define IIR_SIMD_LEVEL IIR_SIMD_LEVEL_SCALAR
+    #endif
+#endif
+
+// Environment variable limiting the instruction set selected for new
+// filters. Values: scalar, sse2, avx2, avx512 (or the level number)
+#define IIR_SIMD_LEVEL_ENV "IIR_SIMD_LEVEL"
+
+// Type of the coefficient major kernels (see above for the parameters)
+typedef void (*IIR_M_kernel_t)(int n_coefs, int stride,
+			       const IIR_signal_t *a,
+			       const IIR_signal_t *b,
+			       IIR_signal_t *z,
+			       const IIR_signal_t *x,
+			       IIR_signal_t *y,
+			       int m);
+
+/******************************************************
+ * Scalar kernels (also used for the remaining signals of the vector ones)
+ ******************************************************/
+
+inline void _IIR_MS_coef_major_kernel_scalar(int n_coefs, int stride,
+					     const IIR_signal_t *a,
+					     const IIR_signal_t *b,
+					     IIR_signal_t *z,
+					     const IIR_signal_t *IIR_RESTRICT x,
+					     IIR_signal_t *IIR_RESTRICT y,
+					     int m) {
+    int j, k;
+
+    IIR_signal_t b_j = b[0];
+    for (k=0; k<m; k++){
+	y[k] = z[k] + b_j * x[k];
+    }
+
+    for (j = 1; j< n_coefs-1 ; j++){
+	IIR_signal_t *IIR_RESTRICT z_prev = z + (j-1)*stride;
+	const IIR_signal_t *IIR_RESTRICT z_j = z + j*stride;
+	IIR_signal_t a_j = a[j];
+	b_j = b[j];
+	for (k=0; k<m; k++){
+	    z_prev[k] = z_j[k] + x[k] * b_j - y[k] * a_j;
+	}
+    }
+
+    IIR_signal_t *IIR_RESTRICT z_prev = z + (j-1)*stride;
+    IIR_signal_t a_j = a[j];
+    b_j = b[j];
+    for (k=0; k<m; k++){
+	z_prev[k] = x[k] * b_j - y[k] * a_j;
+    }
+}
+
+inline void _IIR_MD_coef_major_kernel_scalar(int n_coefs, int stride,
+					     const IIR_signal_t *IIR_RESTRICT a,
+					     const IIR_signal_t *IIR_RESTRICT b,
+					     IIR_signal_t *z,
+					     const IIR_signal_t *IIR_RESTRICT x,
+					     IIR_signal_t *IIR_RESTRICT y,
+					     int m) {
+    int j, k;
+
+    for (k=0; k<m; k++){
+	y[k] = z[k] + b[k] * x[k];
+    }
+
+    for (j = 1; j< n_coefs-1 ; j++){
+	IIR_signal_t *IIR_RESTRICT z_prev = z + (j-1)*stride;
+	const IIR_signal_t *IIR_RESTRICT z_j = z + j*stride;
+	const IIR_signal_t *IIR_RESTRICT a_j = a + j*stride;
+	const IIR_signal_t *IIR_RESTRICT b_j = b + j*stride;
+	for (k=0; k<m; k++){
+	    z_prev[k] = z_j[k] + x[k] * b_j[k] - y[k] * a_j[k];
+	}
+    }
+
+    IIR_signal_t *IIR_RESTRICT z_prev = z + (j-1)*stride;
+    const IIR_signal_t *IIR_RESTRICT a_j = a + j*stride;
+    const IIR_signal_t *IIR_RESTRICT b_j = b + j*stride;
+    for (k=0; k<m; k++){
+	z_prev[k] = x[k] * b_j[k] - y[k] * a_j[k];
+    }
+}
+
+#ifdef IIR_HAVE_X86_KERNELS
+
+/******************************************************
+ * Vector types and operations for each instruction set
+ ******************************************************/
+
+#ifdef IIR_USE_SIGNAL_TYPE_DOUBLE
+    #define _IIR_SSE2_VEC __m128d
+    #define _IIR_SSE2_LOAD _mm_loadu_pd
+    #define _IIR_SSE2_STORE _mm_storeu_pd
+    #define _IIR_SSE2_SET1 _mm_set1_pd
+    #define _IIR_SSE2_ADD _mm_add_pd
+    #define _IIR_SSE2_SUB _mm_sub_pd
+    #define _IIR_SSE2_MUL _mm_mul_pd
+
+    #define _IIR_AVX2_VEC __m256d
+    #define _IIR_AVX2_LOAD _mm256_loadu_pd
+    #define _IIR_AVX2_STORE _mm256_storeu_pd
+    #define _IIR_AVX2_SET1 _mm256_set1_pd
+    #define _IIR_AVX2_ADD _mm256_add_pd
+    #define _IIR_AVX2_SUB _mm256_sub_pd
+    #define _IIR_AVX2_MUL _mm256_mul_pd
+    #define _IIR_AVX2_FMADD _mm256_fmadd_pd
+    #define _IIR_AVX2_FNMADD _mm256_fnmadd_pd
+
+    #define _IIR_AVX512_VEC __m512d
+    #define _IIR_AVX512_LOAD _mm512_loadu_pd
+    #define _IIR_AVX512_STORE _mm512_storeu_pd
+    #define _IIR_AVX512_SET1 _mm512_set1_pd
+    #define _IIR_AVX512_ADD _mm512_add_pd
+    #define _IIR_AVX512_SUB _mm512_sub_pd
+    #define _IIR_AVX512_MUL _mm512_mul_pd
+    #define _IIR_AVX512_FMADD _mm512_fmadd_pd
+    #define _IIR_AVX512_FNMADD _mm512_fnmadd_pd
+#else
+    #define _IIR_SSE2_VEC __m128
+    #define _IIR_SSE2_LOAD _mm_loadu_ps
+    #define _IIR_SSE2_STORE _mm_storeu_ps
+    #define _IIR_SSE2_SET1 _mm_set1_ps
+    #define _IIR_SSE2_ADD _mm_add_ps
+    #define _IIR_SSE2_SUB _mm_sub_ps
+    #define _IIR_SSE2_MUL _mm_mul_ps
+
+    #define _IIR_AVX2_VEC __m256
+    #define _IIR_AVX2_LOAD _mm256_loadu_ps
+    #define _IIR_AVX2_STORE _mm256_storeu_ps
+    #define _IIR_AVX2_SET1 _mm256_set1_ps
+    #define _IIR_AVX2_ADD _mm256_add_ps
+    #define _IIR_AVX2_SUB _mm256_sub_ps
+    #define _IIR_AVX2_MUL _mm256_mul_ps
+    #define _IIR_AVX2_FMADD _mm256_fmadd_ps
+    #define _IIR_AVX2_FNMADD _mm256_fnmadd_ps
+
+    #define _IIR_AVX512_VEC __m512
+    #define _IIR_AVX512_LOAD _mm512_loadu_ps
+    #define _IIR_AVX512_STORE _mm512_storeu_ps
+    #define _IIR_AVX512_SET1 _mm512_set1_ps
+    #define _IIR_AVX512_ADD _mm512_add_ps
+    #define _IIR_AVX512_SUB _mm512_sub_ps
+    #define _IIR_AVX512_MUL _mm512_mul_ps
+    #define _IIR_AVX512_FMADD _mm512_fmadd_ps
+    #define _IIR_AVX512_FNMADD _mm512_fnmadd_ps
+#endif
+
+// Filter step operations for one vector of signals (ISA = SSE2, AVX2, AVX512)
+//	y = z_0 + b_0*x
+//	z_prev = z_j + x*b_j - y*a_j
+//	z_last = x*b_last - y*a_last
+#define _IIR_VEC_OUTPUT(ISA, z_0, b_0, x) \
+    _IIR_##ISA##_ADD( (z_0), _IIR_##ISA##_MUL( (b_0), (x) ) )
+#define _IIR_VEC_STATE(ISA, z_j, x, b_j, y, a_j) \
+    _IIR_##ISA##_SUB( _IIR_##ISA##_ADD( (z_j), _IIR_##ISA##_MUL( (x), (b_j) ) ), _IIR_##ISA##_MUL( (y), (a_j) ) )
+#define _IIR_VEC_LAST_STATE(ISA, x, b_j, y, a_j) \
+    _IIR_##ISA##_SUB( _IIR_##ISA##_MUL( (x), (b_j) ), _IIR_##ISA##_MUL( (y), (a_j) ) )
+
+#ifdef IIR_USE_FMA
+    #define _IIR_VEC_OUTPUT_FMA(ISA, z_0, b_0, x) \
+	_IIR_##ISA##_FMADD( (b_0), (x), (z_0) )
+    #define _IIR_VEC_STATE_FMA(ISA, z_j, x, b_j, y, a_j) \
+	_IIR_##ISA##_FNMADD( (y), (a_j), _IIR_##ISA##_FMADD( (x), (b_j), (z_j) ) )
+    #define _IIR_VEC_LAST_STATE_FMA(ISA, x, b_j, y, a_j) \
+	_IIR_##ISA##_FNMADD( (y), (a_j), _IIR_##ISA##_MUL( (x), (b_j) ) )
+#else
+    #define _IIR_VEC_OUTPUT_FMA _IIR_VEC_OUTPUT
+    #define _IIR_VEC_STATE_FMA _IIR_VEC_STATE
+    #define _IIR_VEC_LAST_STATE_FMA _IIR_VEC_LAST_STATE
+#endif
+
+// Target attributes of the AVX2 and AVX-512 kernels. Without IIR_USE_FMA,
+// FMA is not enabled for AVX2 and floating point contraction is turned off
+// (GCC contracts a multiplication followed by an addition into an FMA
+// instruction by default with -std=gnu* and in C++, even with intrinsics),
+// so the results are the same as the scalar code ones
+#ifdef IIR_USE_FMA
+    #define _IIR_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define _IIR_TARGET_AVX512 __attribute__((target("avx512f")))
+#elif defined(__clang__)
+    // clang only contracts within one source expression by default
+    #define _IIR_TARGET_AVX2 __attribute__((target("avx2")))
+    #define _IIR_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+    #define _IIR_TARGET_AVX2 __attribute__((target("avx2"), optimize("fp-contract=off")))
+    #define _IIR_TARGET_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#endif
+
+/******************************************************
+ * SSE2 kernels
+ ******************************************************/
+
+__attribute__((target("sse2")))
+inline void _IIR_MS_coef_major_kernel_sse2(int n_coefs, int stride,
+					   const IIR_signal_t *a,
+					   const IIR_signal_t *b,
+					   IIR_signal_t *z,
+					   const IIR_signal_t *x,
+					   IIR_signal_t *y,
+					   int m) {
+    int j, k;
+    const int width = sizeof(_IIR_SSE2_VEC)/sizeof(IIR_signal_t);
+
+    for (k=0; k+width<=m; k+=width){
+	_IIR_SSE2_VEC x_v = _IIR_SSE2_LOAD(x + k);
+	_IIR_SSE2_VEC y_v = _IIR_VEC_OUTPUT(SSE2, _IIR_SSE2_LOAD(z + k), _IIR_SSE2_SET1(b[0]), x_v);
+	_IIR_SSE2_STORE(y + k, y_v);
+
+	for (j = 1; j< n_coefs-1 ; j++){
+	    _IIR_SSE2_STORE(z + (j-1)*stride + k,
+		_IIR_VEC_STATE(SSE2, _IIR_SSE2_LOAD(z + j*stride + k),
+			       x_v, _IIR_SSE2_SET1(b[j]), y_v, _IIR_SSE2_SET1(a[j])));
+	}
+	_IIR_SSE2_STORE(z + (j-1)*stride + k,
+	    _IIR_VEC_LAST_STATE(SSE2, x_v, _IIR_SSE2_SET1(b[j]), y_v, _IIR_SSE2_SET1(a[j])));
+    }
+
+    if (k < m){
+	_IIR_MS_coef_major_kernel_scalar(n_coefs, stride, a, b, z + k, x + k, y + k, m - k);
+    }
+}
+
+__attribute__((target("sse2")))
+inline void _IIR_MD_coef_major_kernel_sse2(int n_coefs, int stride,
+					   const IIR_signal_t *a,
+					   const IIR_signal_t *b,
+					   IIR_signal_t *z,
+					   const IIR_signal_t *x,
+					   IIR_signal_t *y,
+					   int m) {
+    int j, k;
+    const int width = sizeof(_IIR_SSE2_VEC)/sizeof(IIR_signal_t);
+
+    for (k=0; k+width<=m; k+=width){
+	_IIR_SSE2_VEC x_v = _IIR_SSE2_LOAD(x + k);
+	_IIR_SSE2_VEC y_v = _IIR_VEC_OUTPUT(SSE2, _IIR_SSE2_LOAD(z + k), _IIR_SSE2_LOAD(b + k), x_v);
+	_IIR_SSE2_STORE(y + k, y_v);
+
+	for (j = 1; j< n_coefs-1 ; j++){
+	    _IIR_SSE2_STORE(z + (j-1)*stride + k,
+		_IIR_VEC_STATE(SSE2, _IIR_SSE2_LOAD(z + j*stride + k),
+			       x_v, _IIR_SSE2_LOAD(b + j*stride + k),
+			       y_v, _IIR_SSE2_LOAD(a + j*stride + k)));
+	}
+	_IIR_SSE2_STORE(z + (j-1)*stride + k,
+	    _IIR_VEC_LAST_STATE(SSE2, x_v, _IIR_SSE2_LOAD(b + j*stride + k),
+				y_v, _IIR_SSE2_LOAD(a + j*stride + k)));
+    }
+
+    if (k < m){
+	_IIR_MD_coef_major_kernel_scalar(n_coefs, stride, a + k, b + k, z + k, x + k, y + k, m - k);
+    }
+}
+
+/******************************************************
+ * AVX2 kernels
+ ******************************************************/
+
+_IIR_TARGET_AVX2
+inline void _IIR_MS_coef_major_kernel_avx2(int n_coefs, int stride,
+					   const IIR_signal_t *a,
+					   const IIR_signal_t *b,
+					   IIR_signal_t *z,
+					   const IIR_signal_t *x,
+					   IIR_signal_t *y,
+					   int m) {
+    int j, k;
+    const int width = sizeof(_IIR_AVX2_VEC)/sizeof(IIR_signal_t);
+
+    for (k=0; k+width<=m; k+=width){
+	_IIR_AVX2_VEC x_v = _IIR_AVX2_LOAD(x + k);
+	_IIR_AVX2_VEC y_v = _IIR_VEC_OUTPUT_FMA(AVX2, _IIR_AVX2_LOAD(z + k), _IIR_AVX2_SET1(b[0]), x_v);
+	_IIR_AVX2_STORE(y + k, y_v);
+
+	for (j = 1; j< n_coefs-1 ; j++){
+	    _IIR_AVX2_STORE(z + (j-1)*stride + k,
+		_IIR_VEC_STATE_FMA(AVX2, _IIR_AVX2_LOAD(z + j*stride + k),
+				   x_v, _IIR_AVX2_SET1(b[j]), y_v, _IIR_AVX2_SET1(a[j])));
+	}
+	_IIR_AVX2_STORE(z + (j-1)*stride + k,
+	    _IIR_VEC_LAST_STATE_FMA(AVX2, x_v, _IIR_AVX2_SET1(b[j]), y_v, _IIR_AVX2_SET1(a[j])));
+    }
+
+    if (k < m){
+	_IIR_MS_coef_major_kernel_sse2(n_coefs, stride, a, b, z + k, x + k, y + k, m - k);
+    }
+}
+
+_IIR_TARGET_AVX2
+inline void _IIR_MD_coef_major_kernel_avx2(int n_coefs, int stride,
+					   const IIR_signal_t *a,
+					   const IIR_signal_t *b,
+					   IIR_signal_t *z,
+					   const IIR_signal_t *x,
+					   IIR_signal_t *y,
+					   int m) {
+    int j, k;
+    const int width = sizeof(_IIR_AVX2_VEC)/sizeof(IIR_signal_t);
+
+    for (k=0; k+width<=m; k+=width){
+	_IIR_AVX2_VEC x_v = _IIR_AVX2_LOAD(x + k);
+	_IIR_AVX2_VEC y_v = _IIR_VEC_OUTPUT_FMA(AVX2, _IIR_AVX2_LOAD(z + k), _IIR_AVX2_LOAD(b + k), x_v);
+	_IIR_AVX2_STORE(y + k, y_v);
+
+	for (j = 1; j< n_coefs-1 ; j++){
+	    _IIR_AVX2_STORE(z + (j-1)*stride + k,
+		_IIR_VEC_STATE_FMA(AVX2, _IIR_AVX2_LOAD(z + j*stride + k),
+				   x_v, _IIR_AVX2_LOAD(b + j*stride + k),
+				   y_v, _IIR_AVX2_LOAD(a + j*stride + k)));
+	}
+	_IIR_AVX2_STORE(z + (j-1)*stride + k,
+	    _IIR_VEC_LAST_STATE_FMA(AVX2, x_v, _IIR_AVX2_LOAD(b + j*stride + k),
+				    y_v, _IIR_AVX2_LOAD(a + j*stride + k)));
+    }
+
+    if (k < m){
+	_IIR_MD_coef_major_kernel_sse2(n_coefs, stride, a + k, b + k, z + k, x + k, y + k, m - k);
+    }
+}
+
+/******************************************************
+ * AVX-512 kernels
+ ******************************************************/
+
+_IIR_TARGET_AVX512
+inline void _IIR_MS_coef_major_kernel_avx512(int n_coefs, int stride,
+					     const IIR_signal_t *a,
+					     const IIR_signal_t *b,
+					     IIR_signal_t *z,
+					     const IIR_signal_t *x,
+					     IIR_signal_t *y,
+					     int m) {
+    int j, k;
+    const int width = sizeof(_IIR_AVX512_VEC)/sizeof(IIR_signal_t);
+
+    for (k=0; k+width<=m; k+=width){
+	_IIR_AVX512_VEC x_v = _IIR_AVX512_LOAD(x + k);
+	_IIR_AVX512_VEC y_v = _IIR_VEC_OUTPUT_FMA(AVX512, _IIR_AVX512_LOAD(z + k), _IIR_AVX512_SET1(b[0]), x_v);
+	_IIR_AVX512_STORE(y + k, y_v);
+
+	for (j = 1; j< n_coefs-1 ; j++){
+	    _IIR_AVX512_STORE(z + (j-1)*stride + k,
+		_IIR_VEC_STATE_FMA(AVX512, _IIR_AVX512_LOAD(z + j*stride + k),
+				   x_v, _IIR_AVX512_SET1(b[j]), y_v, _IIR_AVX512_SET1(a[j])));
+	}
+	_IIR_AVX512_STORE(z + (j-1)*stride + k,
+	    _IIR_VEC_LAST_STATE_FMA(AVX512, x_v, _IIR_AVX512_SET1(b[j]), y_v, _IIR_AVX512_SET1(a[j])));
+    }
+
+    if (k < m){
+	_IIR_MS_coef_major_kernel_sse2(n_coefs, stride, a, b, z + k, x + k, y + k, m - k);
+    }
+}
+
+_IIR_TARGET_AVX512
+inline void _IIR_MD_coef_major_kernel_avx512(int n_coefs, int stride,
+					     const IIR_signal_t *a,
+					     const IIR_signal_t *b,
+					     IIR_signal_t *z,
+					     const IIR_signal_t *x,
+					     IIR_signal_t *y,
+					     int m) {
+    int j, k;
+    const int width = sizeof(_IIR_AVX512_VEC)/sizeof(IIR_signal_t);
+
+    for (k=0; k+width<=m; k+=width){
+	_IIR_AVX512_VEC x_v = _IIR_AVX512_LOAD(x + k);
+	_IIR_AVX512_VEC y_v = _IIR_VEC_OUTPUT_FMA(AVX512, _IIR_AVX512_LOAD(z + k), _IIR_AVX512_LOAD(b + k), x_v);
+	_IIR_AVX512_STORE(y + k, y_v);
+
+	for (j = 1; j< n_coefs-1 ; j++){
+	    _IIR_AVX512_STORE(z + (j-1)*stride + k,
+		_IIR_VEC_STATE_FMA(AVX512, _IIR_AVX512_LOAD(z + j*stride + k),
+				   x_v, _IIR_AVX512_LOAD(b + j*stride + k),
+				   y_v, _IIR_AVX512_LOAD(a + j*stride + k)));
+	}
+	_IIR_AVX512_STORE(z + (j-1)*stride + k,
+	    _IIR_VEC_LAST_STATE_FMA(AVX512, x_v, _IIR_AVX512_LOAD(b + j*stride + k),
+				    y_v, _IIR_AVX512_LOAD(a + j*stride + k)));
+    }
+
+    if (k < m){
+	_IIR_MD_coef_major_kernel_sse2(n_coefs, stride, a + k, b + k, z + k, x + k, y + k, m - k);
+    }
+}
+
+#endif /* IIR_HAVE_X86_KERNELS */
+
+/******************************************************
+ * Second order sections kernels
+ ******************************************************/
+
+// Cascade of second order sections for m signals of the multiple signal SOS
+// filters (see IIR_SOS_filters.h). Each vector of signals goes through all
+// the sections in registers before the next one is loaded.
+//	n_sections: number of sections
+//	stride: distance between two state (or MD coef) rows (_padded_signals)
+//	c: shared coefs (5 values b0, b1, b2, a1, a2 per section, MS kernels)
+//	    or the 5 coef rows of each section starting at the first signal (MD
+//	    kernels)
+//	z: state rows (2 per section) starting at the first signal
+//	y: holds the m inputs and receives the m outputs
+// Each section does the same operations as an order 2 filter step, so (as
+// for the other kernels) all of them produce exactly the same results
+// unless IIR_USE_FMA is defined.
+typedef void (*IIR_SOS_M_kernel_t)(int n_sections, int stride,
+				   const IIR_signal_t *c,
+				   IIR_signal_t *z,
+				   IIR_signal_t *y,
+				   int m);
+
+// One section of a MS filter for m signals (scalar). y holds the m inputs
+// and receives the m outputs, z0 and z1 are the two state rows of the
+// section and c its 5 coefs. Each section is a separate function with
+// restrict pointers so the compiler can vectorize its loop.
+inline void _IIR_SOS_MS_section(const IIR_signal_t *IIR_RESTRICT c,
+				IIR_signal_t *IIR_RESTRICT z0,
+				IIR_signal_t *IIR_RESTRICT z1,
+				IIR_signal_t *IIR_RESTRICT y,
+				int m) {
+
+    int k;
+    IIR_signal_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+
+    for (k = 0; k < m; k++){
+	IIR_signal_t x_k = y[k];
+	IIR_signal_t y_k = z0[k] + b0 * x_k;
+	z0[k] = z1[k] + x_k * b1 - y_k * a1;
+	z1[k] = x_k * b2 - y_k * a2;
+	y[k] = y_k;
+    }
+}
+
+// Same as _IIR_SOS_MS_section for a MD filter: c holds the coef rows of the
+// section, stride values apart
+inline void _IIR_SOS_MD_section(const IIR_signal_t *IIR_RESTRICT c,
+				int stride,
+				IIR_signal_t *IIR_RESTRICT z0,
+				IIR_signal_t *IIR_RESTRICT z1,
+				IIR_signal_t *IIR_RESTRICT y,
+				int m) {
+
+    int k;
+    const IIR_signal_t *IIR_RESTRICT b0 = c;
+    const IIR_signal_t *IIR_RESTRICT b1 = c + stride;
+    const IIR_signal_t *IIR_RESTRICT b2 = c + 2*stride;
+    const IIR_signal_t *IIR_RESTRICT a1 = c + 3*stride;
+    const IIR_signal_t *IIR_RESTRICT a2 = c + 4*stride;
+
+    for (k = 0; k < m; k++){
+	IIR_signal_t x_k = y[k];
+	IIR_signal_t y_k = z0[k] + b0[k] * x_k;
+	z0[k] = z1[k] + x_k * b1[k] - y_k * a1[k];
+	z1[k] = x_k * b2[k] - y_k * a2[k];
+	y[k] = y_k;
+    }
+}
+
+inline void _IIR_SOS_MS_kernel_scalar(int n_sections, int stride,
+				      const IIR_signal_t *c,
+				      IIR_signal_t *z,
+				      IIR_signal_t *y,
+				      int m) {
+    int s;
+
+    for (s = 0; s < n_sections; s++){
+	_IIR_SOS_MS_section(c + 5*s, z + 2*s*stride, z + (2*s + 1)*stride, y, m);
+    }
+}
+
+inline void _IIR_SOS_MD_kernel_scalar(int n_sections, int stride,
+				      const IIR_signal_t *c,
+				      IIR_signal_t *z,
+				      IIR_signal_t *y,
+				      int m) {
+    int s;
+
+    for (s = 0; s < n_sections; s++){
+	_IIR_SOS_MD_section(c + 5*s*stride, stride,
+			    z + 2*s*stride, z + (2*s + 1)*stride, y, m);
+    }
+}
+
+#ifdef IIR_HAVE_X86_KERNELS
+
+// Coefs of section s as vectors: broadcast (MS) or loaded for signals k to
+// k+width-1 (MD)
+#define _IIR_SOS_MS_VEC_COEF(ISA, s, i) _IIR_##ISA##_SET1( c[5*(s) + (i)] )
+#define _IIR_SOS_MD_VEC_COEF(ISA, s, i) _IIR_##ISA##_LOAD( c + (5*(s) + (i))*stride + k )
+
+// Body of the vector SOS kernels. FMA is empty or _FMA (see
+// _IIR_VEC_OUTPUT_FMA), LOWER the kernel used for the remaining signals
+#define _IIR_SOS_M_KERNEL_BODY(ISA, COEF, FMA, LOWER) \
+    int s, k; \
+    const int width = sizeof(_IIR_##ISA##_VEC)/sizeof(IIR_signal_t); \
+    for (k = 0; k + width <= m; k += width){ \
+	_IIR_##ISA##_VEC y_v = _IIR_##ISA##_LOAD(y + k); \
+	for (s = 0; s < n_sections; s++){ \
+	    IIR_signal_t *z0 = z + 2*s*stride + k; \
+	    _IIR_##ISA##_VEC x_v = y_v; \
+	    y_v = _IIR_VEC_OUTPUT##FMA(ISA, _IIR_##ISA##_LOAD(z0), COEF(ISA, s, 0), x_v); \
+	    _IIR_##ISA##_STORE(z0, \
+		_IIR_VEC_STATE##FMA(ISA, _IIR_##ISA##_LOAD(z0 + stride), \
+				    x_v, COEF(ISA, s, 1), y_v, COEF(ISA, s, 3))); \
+	    _IIR_##ISA##_STORE(z0 + stride, \
+		_IIR_VEC_LAST_STATE##FMA(ISA, x_v, COEF(ISA, s, 2), y_v, COEF(ISA, s, 4))); \
+	} \
+	_IIR_##ISA##_STORE(y + k, y_v); \
+    } \
+    if (k < m){ \
+	LOWER; \
+    }
+
+__attribute__((target("sse2")))
+inline void _IIR_SOS_MS_kernel_sse2(int n_sections, int stride,
+				    const IIR_signal_t *c,
+				    IIR_signal_t *z,
+				    IIR_signal_t *y,
+				    int m) {
+    _IIR_SOS_M_KERNEL_BODY(SSE2, _IIR_SOS_MS_VEC_COEF, ,
+	_IIR_SOS_MS_kernel_scalar(n_sections, stride, c, z + k, y + k, m - k))
+}
+
+__attribute__((target("sse2")))
+inline void _IIR_SOS_MD_kernel_sse2(int n_sections, int stride,
+				    const IIR_signal_t *c,
+				    IIR_signal_t *z,
+				    IIR_signal_t *y,
+				    int m) {
+    _IIR_SOS_M_KERNEL_BODY(SSE2, _IIR_SOS_MD_VEC_COEF, ,
+	_IIR_SOS_MD_kernel_scalar(n_sections, stride, c + k, z + k, y + k, m - k))
+}
+
+_IIR_TARGET_AVX2
+inline void _IIR_SOS_MS_kernel_avx2(int n_sections, int stride,
+				    const IIR_signal_t *c,
+				    IIR_signal_t *z,
+				    IIR_signal_t *y,
+				    int m) {
+    _IIR_SOS_M_KERNEL_BODY(AVX2, _IIR_SOS_MS_VEC_COEF, _FMA,
+	_IIR_SOS_MS_kernel_sse2(n_sections, stride, c, z + k, y + k, m - k))
+}
+
+_IIR_TARGET_AVX2
+inline void _IIR_SOS_MD_kernel_avx2(int n_sections, int stride,
+				    const IIR_signal_t *c,
+				    IIR_signal_t *z,
+				    IIR_signal_t *y,
+				    int m) {
+    _IIR_SOS_M_KERNEL_BODY(AVX2, _IIR_SOS_MD_VEC_COEF, _FMA,
+	_IIR_SOS_MD_kernel_sse2(n_sections, stride, c + k, z + k, y + k, m - k))
+}
+
+_IIR_TARGET_AVX512
+inline void _IIR_SOS_MS_kernel_avx512(int n_sections, int stride,
+				      const IIR_signal_t *c,
+				      IIR_signal_t *z,
+				      IIR_signal_t *y,
+				      int m) {
+    _IIR_SOS_M_KERNEL_BODY(AVX512, _IIR_SOS_MS_VEC_COEF, _FMA,
+	_IIR_SOS_MS_kernel_sse2(n_sections, stride, c, z + k, y + k, m - k))
+}
+
+_IIR_TARGET_AVX512
+inline void _IIR_SOS_MD_kernel_avx512(int n_sections, int stride,
+				      const IIR_signal_t *c,
+				      IIR_signal_t *z,
+				      IIR_signal_t *y,
+				      int m) {
+    _IIR_SOS_M_KERNEL_BODY(AVX512, _IIR_SOS_MD_VEC_COEF, _FMA,
+	_IIR_SOS_MD_kernel_sse2(n_sections, stride, c + k, z + k, y + k, m - k))
+}
+
+#endif /* IIR_HAVE_X86_KERNELS */
+
+/******************************************************
+ * Block state-space kernels for the one signal filters
+ ******************************************************/
+
+// Matrix-vector product out = G v used by the block state-space mode of the
+// IIR_S filters (see IIR_S_set_state_space_block):
+//	G: n_rows x n_cols matrix stored by groups of IIR_SIMD_SIGNALS rows, each
+//	    group column by column (n_rows is a multiple of IIR_SIMD_SIGNALS)
+//	v: n_cols values, the N states followed by the block inputs
+//	out: n_rows values
+// The first n_out_rows rows (the block outputs) are lower triangular in the
+// inputs part, so their groups skip the columns of later inputs.
+// The rounding differs between kernels (the sums are split in several
+// independent accumulators to avoid waiting for each addition).
+typedef void (*IIR_S_ss_kernel_t)(const IIR_signal_t *G,
+				  const IIR_signal_t *v,
+				  IIR_signal_t *out,
+				  int n_rows, int n_cols,
+				  int n_out_rows, int N);
+
+// Last column used by the rows of group g
+#define _IIR_S_SS_GROUP_COLS(g, n_cols, n_out_rows, N) \
+    ( ( ((g)*IIR_SIMD_SIGNALS < (n_out_rows)) && ((N) + ((g)+1)*IIR_SIMD_SIGNALS < (n_cols)) ) ? \
+	(N) + ((g)+1)*IIR_SIMD_SIGNALS : (n_cols) )
+
+inline void _IIR_S_ss_kernel_scalar(const IIR_signal_t *IIR_RESTRICT G,
+				    const IIR_signal_t *IIR_RESTRICT v,
+				    IIR_signal_t *IIR_RESTRICT out,
+				    int n_rows, int n_cols,
+				    int n_out_rows, int N) {
+    int g, c, k;
+
+    for (g = 0; g*IIR_SIMD_SIGNALS < n_rows; g++){
+	const IIR_signal_t *IIR_RESTRICT G_g = G + g*IIR_SIMD_SIGNALS*n_cols;
+	IIR_signal_t *IIR_RESTRICT out_g = out + g*IIR_SIMD_SIGNALS;
+	int c_end = _IIR_S_SS_GROUP_COLS(g, n_cols, n_out_rows, N);
+
+	for (k = 0; k < IIR_SIMD_SIGNALS; k++){
+	    out_g[k] = 0;
+	}
+	for (c = 0; c < c_end; c++){
+	    IIR_signal_t v_c = v[c];
+	    for (k = 0; k < IIR_SIMD_SIGNALS; k++){
+		out_g[k] += G_g[c*IIR_SIMD_SIGNALS + k] * v_c;
+	    }
+	}
+    }
+}
+
+#ifdef IIR_HAVE_X86_KERNELS
+
+// Body of the vector kernels, with GCC vector types of VEC_BYTES bytes. Each
+// group of rows is W vectors, and U columns are accumulated separately so
+// there are always 4 independent sums in flight
+#define _IIR_S_SS_KERNEL_BODY(VEC_BYTES) \
+    typedef IIR_signal_t vec_t __attribute__((vector_size(VEC_BYTES))); \
+    enum { W = IIR_SIMD_ALIGNMENT / (VEC_BYTES), U = (W >= 4) ? 1 : 4 / W, \
+	   VEC_VALUES = (VEC_BYTES) / sizeof(IIR_signal_t) }; \
+    int g, c, u, w; \
+    for (g = 0; g*IIR_SIMD_SIGNALS < n_rows; g++){ \
+	const IIR_signal_t *G_g = G + g*IIR_SIMD_SIGNALS*n_cols; \
+	int c_end = _IIR_S_SS_GROUP_COLS(g, n_cols, n_out_rows, N); \
+	vec_t acc[U][W], g_v; \
+	for (u = 0; u < U; u++){ \
+	    for (w = 0; w < W; w++){ \
+		acc[u][w] = (vec_t){ 0 }; \
+	    } \
+	} \
+	for (c = 0; c + U <= c_end; c += U){ \
+	    for (u = 0; u < U; u++){ \
+		IIR_signal_t v_c = v[c+u]; \
+		for (w = 0; w < W; w++){ \
+		    memcpy( &g_v, G_g + (c+u)*IIR_SIMD_SIGNALS + w*VEC_VALUES, VEC_BYTES ); \
+		    acc[u][w] += g_v * v_c; \
+		} \
+	    } \
+	} \
+	for ( ; c < c_end; c++){ \
+	    IIR_signal_t v_c = v[c]; \
+	    for (w = 0; w < W; w++){ \
+		memcpy( &g_v, G_g + c*IIR_SIMD_SIGNALS + w*VEC_VALUES, VEC_BYTES ); \
+		acc[0][w] += g_v * v_c; \
+	    } \
+	} \
+	for (u = 1; u < U; u++){ \
+	    for (w = 0; w < W; w++){ \
+		acc[0][w] += acc[u][w]; \
+	    } \
+	} \
+	memcpy( out + g*IIR_SIMD_SIGNALS, acc[0], IIR_SIMD_ALIGNMENT ); \
+    }
+
+__attribute__((target("sse2")))
+inline void _IIR_S_ss_kernel_sse2(const IIR_signal_t *IIR_RESTRICT G,
+				  const IIR_signal_t *IIR_RESTRICT v,
+				  IIR_signal_t *IIR_RESTRICT out,
+				  int n_rows, int n_cols,
+				  int n_out_rows, int N) {
+    _IIR_S_SS_KERNEL_BODY(16)
+}
+
+_IIR_TARGET_AVX2
+inline void _IIR_S_ss_kernel_avx2(const IIR_signal_t *IIR_RESTRICT G,
+				  const IIR_signal_t *IIR_RESTRICT v,
+				  IIR_signal_t *IIR_RESTRICT out,
+				  int n_rows, int n_cols,
+				  int n_out_rows, int N) {
+    _IIR_S_SS_KERNEL_BODY(32)
+}
+
+_IIR_TARGET_AVX512
+inline void _IIR_S_ss_kernel_avx512(const IIR_signal_t *IIR_RESTRICT G,
+				    const IIR_signal_t *IIR_RESTRICT v,
+				    IIR_signal_t *IIR_RESTRICT out,
+				    int n_rows, int n_cols,
+				    int n_out_rows, int N) {
+    _IIR_S_SS_KERNEL_BODY(64)
+}
+
+#endif /* IIR_HAVE_X86_KERNELS */
+
+/******************************************************
+ * Runtime dispatch
+ ******************************************************/
+
+// Returns the highest instruction set level supported by the CPU and
+// compiled in (IIR_SIMD_LEVEL). The CPU is checked (cpuid) on the first
+// call only. The AVX2 kernels need FMA only if IIR_USE_FMA is defined
+inline int IIR_simd_cpu_level(void) {
+
+    // Detected level (-1 until the first call)
+    static int cpu_level = -1;
+
+    if (cpu_level >= 0) {
+	return cpu_level;
+    }
+
+    int level = IIR_SIMD_LEVEL_SCALAR;
+#ifdef IIR_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if ( (IIR_SIMD_LEVEL >= IIR_SIMD_LEVEL_AVX512) && __builtin_cpu_supports("avx512f") ) {
+	level = IIR_SIMD_LEVEL_AVX512;
+    } else if ( (IIR_SIMD_LEVEL >= IIR_SIMD_LEVEL_AVX2) && __builtin_cpu_supports("avx2")
+#ifdef IIR_USE_FMA
+		&& __builtin_cpu_supports("fma")
+#endif
+		) {
+	level = IIR_SIMD_LEVEL_AVX2;
+    } else if ( (IIR_SIMD_LEVEL >= IIR_SIMD_LEVEL_SSE2) && __builtin_cpu_supports("sse2") ) {
+	level = IIR_SIMD_LEVEL_SSE2;
+    }
+#endif
+    cpu_level = level;
+
+    return level;
+}
+
+// Returns the instruction set level given in the IIR_SIMD_LEVEL_ENV
+// environment variable or -1 if it is not set (or not valid)
+inline int _IIR_simd_env_level(void) {
+
+    static const char *const names[] = { "scalar", "sse2", "avx2", "avx512" };
+    int level;
+
+    const char *env = getenv( IIR_SIMD_LEVEL_ENV );
+    if ( (!env) || (!env[0]) ) {
+	return -1;
+    }
+
+    for (level = IIR_SIMD_LEVEL_SCALAR; level <= IIR_SIMD_LEVEL_AVX512; level++){
+	if ( !strcmp( env, names[level] ) || ( (env[0] == '0' + level) && !env[1] ) ) {
+	    return level;
+	}
+    }
+
+    fprintf( stderr, "IIR ERROR: unknown %s value '%s', ignored.\n", IIR_SIMD_LEVEL_ENV, env );
+    return -1;
+}
+
+// Level used by new filters (-1 until detected). Internal use: see
+// IIR_simd_detect_level and IIR_simd_refresh_level
+inline int *_IIR_simd_level_cache(void) {
+
+    static int level = -1;
+
+    return &level;
+}
+
+// Detect again the instruction set level used by new filters (the best one
+// supported by the CPU, limited by the IIR_SIMD_LEVEL_ENV environment
+// variable if it is set), for example after changing the variable.
+// Returns the new level
+inline int IIR_simd_refresh_level(void) {
+
+    int level = IIR_simd_cpu_level();
+    int env_level = _IIR_simd_env_level();
+
+    if ( (env_level >= 0) && (env_level < level) ) {
+	level = env_level;
+    }
+    *_IIR_simd_level_cache() = level;
+
+    return level;
+}
+
+// Returns the instruction set level used by new filters. It is detected
+// (see IIR_simd_refresh_level) on the first call only
+inline int IIR_simd_detect_level(void) {
+
+    int level = *_IIR_simd_level_cache();
+
+    return (level >= 0) ? level : IIR_simd_refresh_level();
+}
+
+// Returns the instruction set level of the filters built in caller memory,
+// without reading the environment nor printing (real-time safe): the one
+// of IIR_simd_detect_level if it was already detected, the CPU one
+// otherwise. Internal use
+inline int _IIR_simd_init_level(void) {
+
+    int level = *_IIR_simd_level_cache();
+
+    return (level >= 0) ? level : IIR_simd_cpu_level();
+}
+
+// Returns the coefficient major kernel for the given level
+// different_coefs: 0 for MS filters or 1 for MD filters
+inline IIR_M_kernel_t _IIR_M_select_kernel(int level, int different_coefs) {
+
+#ifdef IIR_HAVE_X86_KERNELS
+    if (level >= IIR_SIMD_LEVEL_AVX512) {
+	return different_coefs ? _IIR_MD_coef_major_kernel_avx512 : _IIR_MS_coef_major_kernel_avx512;
+    }
+    if (level == IIR_SIMD_LEVEL_AVX2) {
+	return different_coefs ? _IIR_MD_coef_major_kernel_avx2 : _IIR_MS_coef_major_kernel_avx2;
+    }
+    if (level == IIR_SIMD_LEVEL_SSE2) {
+	return different_coefs ? _IIR_MD_coef_major_kernel_sse2 : _IIR_MS_coef_major_kernel_sse2;
+    }
+#endif
+
+    return different_coefs ? _IIR_MD_coef_major_kernel_scalar : _IIR_MS_coef_major_kernel_scalar;
+}
+
+// Returns the second order sections kernel for the given level
+// different_coefs: 0 for MS filters or 1 for MD filters
+inline IIR_SOS_M_kernel_t _IIR_SOS_M_select_kernel(int level, int different_coefs) {
+
+#ifdef IIR_HAVE_X86_KERNELS
+    if (level >= IIR_SIMD_LEVEL_AVX512) {
+	return different_coefs ? _IIR_SOS_MD_kernel_avx512 : _IIR_SOS_MS_kernel_avx512;
+    }
+    if (level == IIR_SIMD_LEVEL_AVX2) {
+	return different_coefs ? _IIR_SOS_MD_kernel_avx2 : _IIR_SOS_MS_kernel_avx2;
+    }
+    if (level == IIR_SIMD_LEVEL_SSE2) {
+	return different_coefs ? _IIR_SOS_MD_kernel_sse2 : _IIR_SOS_MS_kernel_sse2;
+    }
+#endif
+
+    return different_coefs ? _IIR_SOS_MD_kernel_scalar : _IIR_SOS_MS_kernel_scalar;
+}
+
+// Returns the block state-space kernel for the given level
+inline IIR_S_ss_kernel_t _IIR_S_select_ss_kernel(int level) {
+
+#ifdef IIR_HAVE_X86_KERNELS
+    if (level >= IIR_SIMD_LEVEL_AVX512) {
+	return _IIR_S_ss_kernel_avx512;
+    }
+    if (level == IIR_SIMD_LEVEL_AVX2) {
+	return _IIR_S_ss_kernel_avx2;
+    }
+    if (level == IIR_SIMD_LEVEL_SSE2) {
+	return _IIR_S_ss_kernel_sse2;
+    }
+#endif
+
+    return _IIR_S_ss_kernel_scalar;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIR_SIMD_KERNELS_H */
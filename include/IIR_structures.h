@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 8:10 PM
+ */
+
+// Filter structures for the one signal filters and the signal major
+// multiple signal filters. All of them compute the same transfer function
+// b(z)/a(z) (a[0] == 1), with N = n_coefs-1, but keep different states:
+//	IIR_STRUCTURE_TDF2: transposed direct form II, the default (see
+//	    IIR_S_add_input). N states, each one a partial sum of the next
+//	    outputs. Shortest chain of dependent operations per sample.
+//	IIR_STRUCTURE_DF1: direct form I. The last N inputs and the last N
+//	    outputs (2N states). The states do not depend on the coefs, so they
+//	    can be switched between two samples without transients, and the
+//	    only sum of products of each output suits fixed point arithmetic.
+//	IIR_STRUCTURE_DF2: direct form II. The last N values of the internal
+//	    signal w = x - sum(a[j] w[-j]), y = sum(b[j] w[-j]) (N states).
+//	IIR_STRUCTURE_LATTICE: lattice-ladder (Gray-Markel). N reflection
+//	    coefs k and N+1 ladder coefs v are computed from a and b when the
+//	    structure is set (or the coefs change through the API). Less
+//	    sensitive to coefficient quantization, and the filter is stable if
+//	    and only if |k| < 1 for all the stages, so unstable filters are
+//	    refused.
+// Each structure has a one signal step kernel with the same signature.
+// Results differ between structures by rounding errors only.
+
+#ifndef IIR_STRUCTURES_H
+#define IIR_STRUCTURES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IIR_STRUCTURE_TDF2 0
+#define IIR_STRUCTURE_DF1 1
+#define IIR_STRUCTURE_DF2 2
+#define IIR_STRUCTURE_LATTICE 3
+
+// Number of state values of one signal for a structure
+#define _IIR_STRUCTURE_STATE_SIZE(n_coefs, structure) \
+    ( ((structure) == IIR_STRUCTURE_DF1) ? 2*(n_coefs) : (n_coefs) )
+
+// Number of lattice coefs of one signal: k[0..N-1] (stage m uses k[m-1])
+// and, from index n_coefs, v[0..N]
+#define _IIR_LATTICE_COEFS_SIZE(n_coefs) (2*(n_coefs))
+
+// Type of the step kernels: filter one input x of one signal and return the
+// output. a and b are the filter coefs (the k and v parts of the lattice
+// coefs for IIR_STRUCTURE_LATTICE) and s the state of the signal
+typedef IIR_signal_t (*IIR_step_kernel_t)(int n_coefs,
+					  const IIR_signal_t *a,
+					  const IIR_signal_t *b,
+					  IIR_signal_t *s,
+					  IIR_signal_t x);
+
+// Transposed direct form II (same operations as IIR_S_add_input)
+inline IIR_signal_t _IIR_step_tdf2(int n_coefs,
+				   const IIR_signal_t *a,
+				   const IIR_signal_t *b,
+				   IIR_signal_t *z,
+				   IIR_signal_t x) {
+    int j;
+    IIR_signal_t y = z[0] + b[0] * x;
+
+    for (j = 1; j< n_coefs-1 ; j++){
+	z[j-1] = z[j] + x * b[j] - y * a[j];
+    }
+    z[j-1] = x * b[j] - y * a[j];
+
+    return y;
+}
+
+// Transposed direct form II fully unrolled for order 1 to 8 filters
+// (n_coefs 2 to 9), without the loop overhead and with the state in
+// registers. Same operations as _IIR_step_tdf2 (same outputs bit by bit).
+// Orders 5 to 8 are only used by IIR_S_process_block, where the state is a
+// local copy that the compiler keeps in registers through the whole block
+inline IIR_signal_t _IIR_step_tdf2_2(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = x * b[1] - y * a[1];
+    return y;
+}
+
+inline IIR_signal_t _IIR_step_tdf2_3(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = z[1] + x * b[1] - y * a[1];
+    z[1] = x * b[2] - y * a[2];
+    return y;
+}
+
+inline IIR_signal_t _IIR_step_tdf2_4(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = z[1] + x * b[1] - y * a[1];
+    z[1] = z[2] + x * b[2] - y * a[2];
+    z[2] = x * b[3] - y * a[3];
+    return y;
+}
+
+inline IIR_signal_t _IIR_step_tdf2_5(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = z[1] + x * b[1] - y * a[1];
+    z[1] = z[2] + x * b[2] - y * a[2];
+    z[2] = z[3] + x * b[3] - y * a[3];
+    z[3] = x * b[4] - y * a[4];
+    return y;
+}
+
+inline IIR_signal_t _IIR_step_tdf2_6(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = z[1] + x * b[1] - y * a[1];
+    z[1] = z[2] + x * b[2] - y * a[2];
+    z[2] = z[3] + x * b[3] - y * a[3];
+    z[3] = z[4] + x * b[4] - y * a[4];
+    z[4] = x * b[5] - y * a[5];
+    return y;
+}
+
+inline IIR_signal_t _IIR_step_tdf2_7(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = z[1] + x * b[1] - y * a[1];
+    z[1] = z[2] + x * b[2] - y * a[2];
+    z[2] = z[3] + x * b[3] - y * a[3];
+    z[3] = z[4] + x * b[4] - y * a[4];
+    z[4] = z[5] + x * b[5] - y * a[5];
+    z[5] = x * b[6] - y * a[6];
+    return y;
+}
+
+inline IIR_signal_t _IIR_step_tdf2_8(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = z[1] + x * b[1] - y * a[1];
+    z[1] = z[2] + x * b[2] - y * a[2];
+    z[2] = z[3] + x * b[3] - y * a[3];
+    z[3] = z[4] + x * b[4] - y * a[4];
+    z[4] = z[5] + x * b[5] - y * a[5];
+    z[5] = z[6] + x * b[6] - y * a[6];
+    z[6] = x * b[7] - y * a[7];
+    return y;
+}
+
+inline IIR_signal_t _IIR_step_tdf2_9(const IIR_signal_t *a,
+				     const IIR_signal_t *b,
+				     IIR_signal_t *z,
+				     IIR_signal_t x) {
+    IIR_signal_t y = z[0] + b[0] * x;
+    z[0] = z[1] + x * b[1] - y * a[1];
+    z[1] = z[2] + x * b[2] - y * a[2];
+    z[2] = z[3] + x * b[3] - y * a[3];
+    z[3] = z[4] + x * b[4] - y * a[4];
+    z[4] = z[5] + x * b[5] - y * a[5];
+    z[5] = z[6] + x * b[6] - y * a[6];
+    z[6] = z[7] + x * b[7] - y * a[7];
+    z[7] = x * b[8] - y * a[8];
+    return y;
+}
+
+// Transposed direct form II step used by the S, MS and MD filters: the
+// unrolled kernels above for n_coefs 2 to 5, _IIR_step_tdf2 otherwise.
+// Being inline, the switch on n_coefs is taken out of the loops over
+// samples and signals by the compiler (loop unswitching), so each loop runs
+// straight line code for the filter order.
+inline IIR_signal_t _IIR_step_tdf2_fast(int n_coefs,
+					const IIR_signal_t *a,
+					const IIR_signal_t *b,
+					IIR_signal_t *z,
+					IIR_signal_t x) {
+
+    switch (n_coefs) {
+	case 2:
+	    return _IIR_step_tdf2_2(a, b, z, x);
+	case 3:
+	    return _IIR_step_tdf2_3(a, b, z, x);
+	case 4:
+	    return _IIR_step_tdf2_4(a, b, z, x);
+	case 5:
+	    return _IIR_step_tdf2_5(a, b, z, x);
+    }
+
+    return _IIR_step_tdf2(n_coefs, a, b, z, x);
+}
+
+// Direct form I: s[0..N-1] are the last inputs (s[0] the previous one) and
+// s[n_coefs..n_coefs+N-1] the last outputs
+inline IIR_signal_t _IIR_step_df1(int n_coefs,
+				  const IIR_signal_t *a,
+				  const IIR_signal_t *b,
+				  IIR_signal_t *s,
+				  IIR_signal_t x) {
+    int j;
+    IIR_signal_t *x_old = s;
+    IIR_signal_t *y_old = s + n_coefs;
+    IIR_signal_t y = b[0] * x;
+
+    for (j = 1; j < n_coefs; j++){
+	y += b[j] * x_old[j-1] - a[j] * y_old[j-1];
+    }
+    for (j = n_coefs-2; j > 0; j--){
+	x_old[j] = x_old[j-1];
+	y_old[j] = y_old[j-1];
+    }
+    x_old[0] = x;
+    y_old[0] = y;
+
+    return y;
+}
+
+// Direct form II: s[0..N-1] are the last values of w (s[0] the previous one)
+inline IIR_signal_t _IIR_step_df2(int n_coefs,
+				  const IIR_signal_t *a,
+				  const IIR_signal_t *b,
+				  IIR_signal_t *s,
+				  IIR_signal_t x) {
+    int j;
+    IIR_signal_t w = x;
+    IIR_signal_t y = 0;
+
+    for (j = 1; j < n_coefs; j++){
+	w -= a[j] * s[j-1];
+	y += b[j] * s[j-1];
+    }
+    y += b[0] * w;
+    for (j = n_coefs-2; j > 0; j--){
+	s[j] = s[j-1];
+    }
+    s[0] = w;
+
+    return y;
+}
+
+// Lattice-ladder: k = a (reflection coefs), v = b (ladder coefs) and
+// s[m] = g_m[n-1], the backward signal of stage m in the previous sample
+//	f_(m-1) = f_m - k_m g_(m-1)[n-1]	(f_N = x)
+//	g_m = k_m f_(m-1) + g_(m-1)[n-1]	(g_0 = f_0)
+//	y = sum(v_m g_m)
+inline IIR_signal_t _IIR_step_lattice(int n_coefs,
+				      const IIR_signal_t *k,
+				      const IIR_signal_t *v,
+				      IIR_signal_t *s,
+				      IIR_signal_t x) {
+    int m;
+    IIR_signal_t f = x;
+    IIR_signal_t y = 0;
+
+    for (m = n_coefs-1; m > 0; m--){
+	f -= k[m-1] * s[m-1];
+	IIR_signal_t g = k[m-1] * f + s[m-1];
+	y += v[m] * g;
+	s[m] = g;
+    }
+    s[0] = f;
+    y += v[0] * f;
+
+    return y;
+}
+
+// Returns the step kernel of a structure (NULL if it is not valid)
+inline IIR_step_kernel_t _IIR_select_step_kernel(int structure) {
+
+    switch (structure) {
+	case IIR_STRUCTURE_TDF2:
+	    return _IIR_step_tdf2_fast;
+	case IIR_STRUCTURE_DF1:
+	    return _IIR_step_df1;
+	case IIR_STRUCTURE_DF2:
+	    return _IIR_step_df2;
+	case IIR_STRUCTURE_LATTICE:
+	    return _IIR_step_lattice;
+    }
+
+    return NULL;
+}
+
+// Compute the lattice coefs (k and v, see _IIR_LATTICE_COEFS_SIZE) of a
+// filter with the step-down recursion (in double precision):
+//	k_m = A_m[m]
+//	A_(m-1)[i] = (A_m[i] - k_m A_m[m-i]) / (1 - k_m^2)
+//	v_m = C_m[m],	C_(m-1)[i] = C_m[i] - v_m A_m[m-i]
+// from A_N = a/a[0] and C_N = b/a[0].
+// Returns 0 on fail (less than 2 coefs, a[0] == 0, |k| >= 1 (unstable
+// filter) or memory allocation problem), 1 otherwise
+inline int _IIR_lattice_coefs(int n_coefs,
+			      const IIR_signal_t *b,
+			      const IIR_signal_t *a,
+			      IIR_signal_t *kv) {
+    int i, m;
+    int ok = 1;
+
+    // The check on n_coefs also shows the compiler that C is written
+    if ( (n_coefs < 2) || (a[0] == 0) ) {
+	return 0;
+    }
+
+    double *A = (double*) malloc(sizeof (double) * 2 * n_coefs);
+    if ( !A ){
+	fprintf( stderr, "IIR ERROR: Unable allocate memory for lattice coefs computation.\n" );
+	return 0;
+    }
+    double *C = A + n_coefs;
+    for (i = 0; i < n_coefs; i++){
+	A[i] = (double)a[i] / a[0];
+	C[i] = (double)b[i] / a[0];
+    }
+
+    for (m = n_coefs-1; (m > 0) && ok; m--){
+	double k = A[m];
+	double v = C[m];
+	ok = (k < 1.0) && (k > -1.0);
+	kv[m-1] = (IIR_signal_t) k;
+	kv[n_coefs + m] = (IIR_signal_t) v;
+	for (i = 0; i < m; i++){
+	    C[i] -= v * A[m-i];
+	}
+	for (i = 0; 2*i <= m; i++){
+	    double a_i = A[i];
+	    double a_mi = A[m-i];
+	    A[i] = (a_i - k * a_mi) / (1.0 - k*k);
+	    A[m-i] = (a_mi - k * a_i) / (1.0 - k*k);
+	}
+    }
+    kv[n_coefs] = (IIR_signal_t) C[0];
+
+    free( A );
+
+    return ok;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIR_STRUCTURES_H */
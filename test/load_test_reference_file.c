@@ -31,6 +31,18 @@
 #define STR_VALUE(name) STR_VALUE2(name)
 #define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
 
+const IIR_signal_t test_low_order_a[TEST_LOW_ORDERS][TEST_LOW_ORDERS_MAX_COEFS] = {
+    {1.0000, -0.5095},
+    {1.0000, -1.1430, 0.4128},
+    {1.0000, -1.7600, 1.1829, -0.2781},
+    {1.0000, -2.3695, 2.3140, -1.0547, 0.1874}
+};
+const IIR_signal_t test_low_order_b[TEST_LOW_ORDERS][TEST_LOW_ORDERS_MAX_COEFS] = {
+    {0.2452, 0.2452},
+    {0.0675, 0.1349, 0.0675},
+    {0.0181, 0.0543, 0.0543, 0.0181},
+    {0.0048, 0.0193, 0.0289, 0.0193, 0.0048}
+};
 
 int read_comma_line( FILE *file, int read_size, IIR_signal_t *read_dest ){
     
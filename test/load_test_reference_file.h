@@ -40,6 +40,13 @@
 extern "C" {
 #endif
 
+// Butterworth low pass filters of order 1 to TEST_LOW_ORDERS (n_coefs 2 to
+// TEST_LOW_ORDERS+1, rows padded with 0s), for the low order kernels tests
+#define TEST_LOW_ORDERS 4
+#define TEST_LOW_ORDERS_MAX_COEFS (TEST_LOW_ORDERS + 1)
+extern const IIR_signal_t test_low_order_a[TEST_LOW_ORDERS][TEST_LOW_ORDERS_MAX_COEFS];
+extern const IIR_signal_t test_low_order_b[TEST_LOW_ORDERS][TEST_LOW_ORDERS_MAX_COEFS];
+
 typedef struct test_data_t {
     int n_coefs;
     int n_inputs;
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 2:15 AM
+ */
+
+// Checks IIR_MS_add_input_to/IIR_MD_add_input_to against
+// IIR_MS_add_input/IIR_MD_add_input (bit by bit) in both layouts and with
+// the DF2 structure, that they leave the last output of the filter as it
+// is, and IIR_MS_copy_last_output/IIR_MD_copy_last_output.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 19
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+// Last output value that add_input_to must not change
+#define UNTOUCHED 12345.0
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + k] = inputs[i] + noise;
+            }
+        }
+
+        // Coef major, signal major and signal major with the DF2 structure
+        for ( int mode=0; (mode < 3) && !error; mode++ ){
+            int layout = (mode == 0) ? IIR_M_LAYOUT_COEF_MAJOR : IIR_M_LAYOUT_SIGNAL_MAJOR;
+            for ( int md=0; (md < 2) && !error; md++ ){
+                const char *name = md ? "IIR_MD" : "IIR_MS";
+                IIR_M_t *filter = md ? IIR_MD_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, layout )
+                                     : IIR_MS_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, layout );
+                IIR_M_t *ref_filter = md ? IIR_MD_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, layout )
+                                         : IIR_MS_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, layout );
+                for ( int k=0; md && (k < N_SIGNALS); k++ ){
+                    IIR_signal_t b_k[n_coefs];
+                    for ( int c=0; c < n_coefs; c++ ){
+                        b_k[c] = b_coefs[c] + ((c%2) ? COEF_STEP_RANGE * k : 0);
+                    }
+                    IIR_MD_set_coefs_one_signal( filter, n_coefs, b_k, a_coefs, k );
+                    IIR_MD_set_coefs_one_signal( ref_filter, n_coefs, b_k, a_coefs, k );
+                }
+                if ( mode == 2 ){
+                    _IIR_M_set_structure( filter, IIR_STRUCTURE_DF2, md );
+                    _IIR_M_set_structure( ref_filter, IIR_STRUCTURE_DF2, md );
+                }
+                for ( int k=0; k < N_SIGNALS; k++ ){
+                    filter->last_output[k] = UNTOUCHED;
+                }
+
+                IIR_signal_t y[N_SIGNALS];
+                for ( int i=0; (i < n_inputs) && !error; i++ ){
+                    IIR_signal_t *ref_y;
+                    if ( md ){
+                        IIR_MD_add_input_to( filter, &frames[i*N_SIGNALS], y );
+                        ref_y = IIR_MD_add_input( ref_filter, &frames[i*N_SIGNALS] );
+                    }else{
+                        IIR_MS_add_input_to( filter, &frames[i*N_SIGNALS], y );
+                        ref_y = IIR_MS_add_input( ref_filter, &frames[i*N_SIGNALS] );
+                    }
+                    for ( int k=0; k < N_SIGNALS; k++ ){
+                        if ( y[k] != ref_y[k] ){
+                            printf( "ERROR: %s add_input_to (mode %d, i=%d, signal %d) %f != %f\n", name, mode, i, k, y[k], ref_y[k] );
+                            error = 1;
+                            break;
+                        }
+                        if ( filter->last_output[k] != UNTOUCHED ){
+                            printf( "ERROR: %s add_input_to (mode %d) changed the last output\n", name, mode );
+                            error = 1;
+                            break;
+                        }
+                    }
+                }
+
+                // Copy of the last output
+                IIR_MD_copy_last_output( ref_filter, y );
+                for ( int k=0; (k < N_SIGNALS) && !error; k++ ){
+                    if ( y[k] != IIR_MD_get_last_output( ref_filter )[k] ){
+                        printf( "ERROR: %s copy_last_output (signal %d)\n", name, k );
+                        error = 1;
+                    }
+                }
+
+                _IIR_M_destroy( filter );
+                _IIR_M_destroy( ref_filter );
+            }
+        }
+
+        free( frames );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_MS/IIR_MD: add_input_to outputs do not match the add_input ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MS/IIR_MD: add_input_to outputs match the add_input ones\n" );
+    return EXIT_SUCCESS;
+}
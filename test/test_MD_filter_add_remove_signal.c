@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 9:30 AM
+ */
+
+// Checks MS and MD filters (both layouts, DF1 and lattice structures) while
+// signals are added (growing the filter) and removed (swap-remove) during
+// the filtering, against one S filter per signal (bit by bit), and the
+// add/remove limits of filters built in caller memory.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Number of different noisy inputs (and MD coefs), used in turns by the
+// added signals
+#define N_SOURCES 50
+#define FIRST_SIGNALS 3
+#define MAX_SIGNALS 45
+// Frames between two signal additions or removals
+#define SEGMENT_FRAMES 9
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+#define N_MODES 4
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+    const char *names[N_MODES] = { "coef major", "TDF2", "DF1", "LATTICE" };
+    const int structures[N_MODES] = { IIR_STRUCTURE_TDF2, IIR_STRUCTURE_TDF2, IIR_STRUCTURE_DF1, IIR_STRUCTURE_LATTICE };
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // N_SOURCES noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SOURCES );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SOURCES; j++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SOURCES + j] = inputs[i] + noise;
+            }
+        }
+
+        // Slightly different b coefs for each source
+        IIR_signal_t *all_a = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SOURCES );
+        IIR_signal_t *all_b = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SOURCES );
+        for ( int j=0; j < N_SOURCES; j++ ){
+            for ( int c=0; c < n_coefs; c++ ){
+                all_a[j*n_coefs + c] = a_coefs[c];
+                all_b[j*n_coefs + c] = b_coefs[c] + ((c%2) ? COEF_STEP_RANGE * j : 0);
+            }
+        }
+
+        for ( int mode=0; (mode < N_MODES) && !error; mode++ ){
+            for ( int md=0; (md < 2) && !error; md++ ){
+                const char *name = md ? "IIR_MD" : "IIR_MS";
+                int s = structures[mode];
+                IIR_M_t *filter;
+                if ( mode == 0 ){
+                    filter = md ? IIR_MD_create_layout( n_coefs, FIRST_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR )
+                                : IIR_MS_create_layout( n_coefs, FIRST_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR );
+                }else{
+                    filter = md ? IIR_MD_create_structure( n_coefs, FIRST_SIGNALS, b_coefs, a_coefs, s )
+                                : IIR_MS_create_structure( n_coefs, FIRST_SIGNALS, b_coefs, a_coefs, s );
+                }
+                if ( !filter ){
+                    printf( "ERROR: unable to create the %s %s filter\n", name, names[mode] );
+                    error = 1;
+                    break;
+                }
+
+                // Source and reference S filter of each signal, kept in the
+                // same order as the filter signals
+                int sources[MAX_SIGNALS];
+                IIR_S_t *refs[MAX_SIGNALS];
+                int n_signals = FIRST_SIGNALS;
+                int next_source = 0;
+                for ( int k=0; k < FIRST_SIGNALS; k++ ){
+                    sources[k] = next_source++;
+                    if ( md ){
+                        IIR_MD_set_coefs_one_signal( filter, n_coefs, &all_b[sources[k]*n_coefs], &all_a[sources[k]*n_coefs], k );
+                    }
+                    refs[k] = IIR_S_create_structure( n_coefs, md ? &all_b[sources[k]*n_coefs] : b_coefs,
+                                                      md ? &all_a[sources[k]*n_coefs] : a_coefs, s );
+                }
+
+                IIR_signal_t x[MAX_SIGNALS * SEGMENT_FRAMES];
+                IIR_signal_t y[MAX_SIGNALS * SEGMENT_FRAMES];
+                for ( int i0=0, seg=0; (i0 < n_inputs) && !error; i0 += SEGMENT_FRAMES, seg++ ){
+                    // Two additions for each removal (while there is room)
+                    if ( (seg % 3 == 2) || (n_signals == MAX_SIGNALS) ){
+                        int k = (seg * 7) % n_signals;
+                        if ( !_IIR_M_remove_signal( filter, k, md ) ){
+                            printf( "ERROR: %s %s: unable to remove signal %d\n", name, names[mode], k );
+                            error = 1;
+                            break;
+                        }
+                        IIR_S_destroy( refs[k] );
+                        n_signals--;
+                        refs[k] = refs[n_signals];
+                        sources[k] = sources[n_signals];
+                    }else{
+                        int j = next_source;
+                        next_source = (next_source + 1) % N_SOURCES;
+                        filter = md ? IIR_MD_add_signal( filter, n_coefs, &all_b[j*n_coefs], &all_a[j*n_coefs] )
+                                    : IIR_MS_add_signal( filter );
+                        if ( !filter ){
+                            printf( "ERROR: %s %s: unable to add a signal\n", name, names[mode] );
+                            error = 1;
+                            break;
+                        }
+                        sources[n_signals] = j;
+                        refs[n_signals] = IIR_S_create_structure( n_coefs, md ? &all_b[j*n_coefs] : b_coefs,
+                                                                  md ? &all_a[j*n_coefs] : a_coefs, s );
+                        n_signals++;
+                    }
+                    if ( (filter->n_signals != n_signals) || (filter->_capacity < n_signals) ){
+                        printf( "ERROR: %s %s: wrong number of signals\n", name, names[mode] );
+                        error = 1;
+                        break;
+                    }
+
+                    // One segment, frame by frame or in one block
+                    int n_frames = (n_inputs - i0 < SEGMENT_FRAMES) ? n_inputs - i0 : SEGMENT_FRAMES;
+                    for ( int i=0; i < n_frames; i++ ){
+                        for ( int k=0; k < n_signals; k++ ){
+                            x[i*n_signals + k] = frames[(i0 + i)*N_SOURCES + sources[k]];
+                        }
+                    }
+                    if ( seg % 2 ){
+                        if ( md ){
+                            IIR_MD_process_block( filter, x, y, n_frames );
+                        }else{
+                            IIR_MS_process_block( filter, x, y, n_frames );
+                        }
+                    }else{
+                        for ( int i=0; i < n_frames; i++ ){
+                            IIR_signal_t *y_i = md ? IIR_MD_add_input( filter, &x[i*n_signals] )
+                                                   : IIR_MS_add_input( filter, &x[i*n_signals] );
+                            for ( int k=0; k < n_signals; k++ ){
+                                y[i*n_signals + k] = y_i[k];
+                            }
+                        }
+                    }
+                    for ( int i=0; (i < n_frames) && !error; i++ ){
+                        for ( int k=0; k < n_signals; k++ ){
+                            IIR_signal_t ref = IIR_S_add_input( refs[k], x[i*n_signals + k] );
+                            if ( y[i*n_signals + k] != ref ){
+                                printf( "ERROR: %s %s (i=%d, signal %d of %d) %f != %f\n", name, names[mode], i0 + i, k, n_signals, y[i*n_signals + k], ref );
+                                error = 1;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                for ( int k=0; k < n_signals; k++ ){
+                    IIR_S_destroy( refs[k] );
+                }
+                _IIR_M_destroy( filter );
+            }
+        }
+
+        // Filters built in caller memory can not grow, but can add signals
+        // again after removing them. Not valid removals and additions.
+        IIR_MD_t *filter = NULL;
+        void *buffer = _IIR_aligned_malloc( IIR_MD_required_bytes( n_coefs, 2 ) );
+        if ( !error ){
+            filter = IIR_MD_init( buffer, n_coefs, 2, b_coefs, a_coefs );
+            if ( !filter || IIR_MD_add_signal( filter, n_coefs, b_coefs, a_coefs )
+                    || !IIR_MD_remove_signal( filter, 1 )
+                    || (IIR_MD_add_signal( filter, n_coefs, b_coefs, a_coefs ) != filter)
+                    || IIR_MD_add_signal( filter, n_coefs + 1, b_coefs, a_coefs )
+                    || IIR_MD_remove_signal( filter, 2 ) || IIR_MD_remove_signal( filter, -1 )
+                    || !IIR_MD_remove_signal( filter, 0 ) || IIR_MD_remove_signal( filter, 0 )
+                    || (filter->n_signals != 1) ){
+                printf( "ERROR: IIR_MD: wrong additions/removals in caller memory\n" );
+                error = 1;
+            }
+        }
+        free( buffer );
+
+        // Reserved capacity: adding signals does not move the filter
+        IIR_MS_t *ms_filter = IIR_MS_create( n_coefs, 1, b_coefs, a_coefs );
+        IIR_MS_t *reserved = IIR_MS_reserve( ms_filter, MAX_SIGNALS );
+        for ( int k=1; (k < MAX_SIGNALS) && !error; k++ ){
+            if ( !reserved || (IIR_MS_add_signal( reserved ) != reserved) ){
+                printf( "ERROR: IIR_MS: the filter moved while adding reserved signals\n" );
+                error = 1;
+            }
+        }
+        _IIR_M_destroy( reserved ? reserved : ms_filter );
+
+        // The padding signals of the coefficient major layout are used by
+        // the first additions, without moving the filter
+        IIR_MD_t *cm_filter = IIR_MD_create_layout( n_coefs, FIRST_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR );
+        if ( !error && cm_filter ){
+            if ( (cm_filter->_capacity != cm_filter->_padded_signals)
+                    || ((cm_filter->_capacity > FIRST_SIGNALS)
+                        && (IIR_MD_add_signal( cm_filter, n_coefs, b_coefs, a_coefs ) != cm_filter)) ){
+                printf( "ERROR: IIR_MD: the coef major filter moved while adding a padding signal\n" );
+                error = 1;
+            }
+        }
+        if ( cm_filter ){
+            IIR_MD_destroy( cm_filter );
+        }
+
+        // A signal without lattice structure (unstable) is not added
+        IIR_signal_t *unstable_a = (IIR_signal_t*) calloc( n_coefs, sizeof(IIR_signal_t) );
+        unstable_a[0] = 1;
+        unstable_a[n_coefs - 1] = 2;
+        IIR_MD_t *lattice_filter = IIR_MD_create_structure( n_coefs, FIRST_SIGNALS, b_coefs, a_coefs, IIR_STRUCTURE_LATTICE );
+        if ( !error && lattice_filter ){
+            if ( IIR_MD_add_signal( lattice_filter, n_coefs, b_coefs, unstable_a )
+                    || (lattice_filter->n_signals != FIRST_SIGNALS) ){
+                printf( "ERROR: IIR_MD: an unstable signal was added to a lattice filter\n" );
+                error = 1;
+            }
+        }
+        if ( lattice_filter ){
+            _IIR_M_destroy( lattice_filter );
+        }
+        free( unstable_a );
+
+        free( frames );
+        free( all_a );
+        free( all_b );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_MS/IIR_MD: outputs with signals added and removed do not match the IIR_S ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MS/IIR_MD: outputs with signals added and removed match the IIR_S ones\n" );
+    return EXIT_SUCCESS;
+}
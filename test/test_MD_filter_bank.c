@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 3:05 AM
+ */
+
+// Checks MD filter banks created from a coefficient table
+// (IIR_MD_create_bank_layout) against MD filters with the coefs of each
+// signal set one by one (IIR_MD_set_coefs_one_signal): same normalized
+// coefficients and same outputs, bit by bit, in both layouts.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 37
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // Coefficient table: slightly different b coefs for each signal
+        // and a and b scaled by a different value (so normalization
+        // changes them) for every other signal
+        IIR_signal_t *a_table = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SIGNALS );
+        IIR_signal_t *b_table = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SIGNALS );
+        for ( int k=0; k < N_SIGNALS; k++ ){
+            IIR_signal_t scale = (k%2) ? 1 + 0.25*k : 1;
+            for ( int c=0; c < n_coefs; c++ ){
+                a_table[k*n_coefs + c] = a_coefs[c] * scale;
+                b_table[k*n_coefs + c] = (b_coefs[c] + ((c%2) ? COEF_STEP_RANGE * k : 0)) * scale;
+            }
+        }
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *y = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *ref_y = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + k] = inputs[i] + noise;
+            }
+        }
+
+        for ( int layout=0; (layout < 2) && !error; layout++ ){
+            IIR_MD_t *filter = IIR_MD_create_bank_layout( n_coefs, N_SIGNALS, b_table, a_table, layout );
+            IIR_MD_t *ref_filter = IIR_MD_create_layout( n_coefs, N_SIGNALS, NULL, NULL, layout );
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                IIR_MD_set_coefs_one_signal( ref_filter, n_coefs, &b_table[k*n_coefs], &a_table[k*n_coefs], k );
+            }
+
+            for ( int k=0; (k < N_SIGNALS) && !error; k++ ){
+                for ( int c=0; c < n_coefs; c++ ){
+                    if ( (IIR_MD_COEFS_A_INDEX( filter, c, k ) != IIR_MD_COEFS_A_INDEX( ref_filter, c, k ))
+                            || (IIR_MD_COEFS_B_INDEX( filter, c, k ) != IIR_MD_COEFS_B_INDEX( ref_filter, c, k )) ){
+                        printf( "ERROR: IIR_MD bank coefs (layout %d, coef %d, signal %d) differ\n", layout, c, k );
+                        error = 1;
+                        break;
+                    }
+                }
+            }
+
+            IIR_MD_process_block( filter, frames, y, n_inputs );
+            IIR_MD_process_block( ref_filter, frames, ref_y, n_inputs );
+            for ( int i=0; (i < n_inputs * N_SIGNALS) && !error; i++ ){
+                if ( y[i] != ref_y[i] ){
+                    printf( "ERROR: IIR_MD bank output (layout %d, i=%d, signal %d) %f != %f\n", layout, i / N_SIGNALS, i % N_SIGNALS, y[i], ref_y[i] );
+                    error = 1;
+                }
+            }
+
+            // Not valid: wrong number of coefs, no table
+            if ( IIR_MD_set_coefs_table( filter, n_coefs + 1, b_table, a_table )
+                    || IIR_MD_set_coefs_table( filter, n_coefs, NULL, a_table ) ){
+                printf( "ERROR: IIR_MD_set_coefs_table accepted invalid parameters\n" );
+                error = 1;
+            }
+
+            IIR_MD_destroy( filter );
+            IIR_MD_destroy( ref_filter );
+        }
+
+        free( frames );
+        free( y );
+        free( ref_y );
+        free( a_table );
+        free( b_table );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_MD: filter banks from a coefficient table do not match the per signal ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MD: filter banks from a coefficient table match the per signal ones\n" );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Not a multiple of the SIMD width and more than one chunk of signals
+#define N_SIGNALS 150
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.01
+// Odd block size so the last block is a partial one
+#define BLOCK_SIZE 37
+
+// Compare the outputs of both filters for one frame
+static int compare_frame(const IIR_signal_t *ref, const IIR_signal_t *out, int i, const char *what){
+    for ( int j=0; j < N_SIGNALS; j++ ){
+        if ( ref[j] != out[j] ){
+            printf( "ERROR: %s (i=%d, j=%d) %f != %f\n", what, i, j, ref[j], out[j] );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // Build N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *ref_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + j] = inputs[i] + noise;
+            }
+        }
+
+        // Reference: signal major filter fed frame by frame
+        IIR_MD_t *ref_filter = IIR_MD_create( n_coefs, N_SIGNALS, b_coefs, a_coefs );
+        IIR_MD_t *filter = IIR_MD_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR );
+        if ( !filter || (filter->_padded_signals % IIR_SIMD_SIGNALS) ){
+            printf( "ERROR: unable to create the coefficient major filter\n" );
+            return EXIT_FAILURE;
+        }
+
+        // Use slightly different coefs for each signal
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            for ( int i=1; i < n_coefs; i++ ){
+                b_coefs[i] += (i%2) * COEF_STEP_RANGE * i/200;
+                a_coefs[i] -= (i%2) * COEF_STEP_RANGE * i/200;
+            }
+            // Force small changes in a[0] to force normalization
+            if ( !(j%2) ){
+                a_coefs[0] += COEF_STEP_RANGE;
+            }
+            IIR_MD_set_coefs_one_signal( ref_filter, n_coefs, b_coefs, a_coefs, j );
+            IIR_MD_set_coefs_one_signal( filter, n_coefs, b_coefs, a_coefs, j );
+        }
+
+        // The coefs must be the same with both layouts
+        for ( int j=0; (j < N_SIGNALS) && !error; j++ ){
+            for ( int i=0; i < n_coefs; i++ ){
+                if ( (IIR_MD_COEFS_A_INDEX(ref_filter, i, j) != IIR_MD_COEFS_A_INDEX(filter, i, j))
+                        || (IIR_MD_COEFS_B_INDEX(ref_filter, i, j) != IIR_MD_COEFS_B_INDEX(filter, i, j)) ){
+                    printf( "ERROR: coefs (i=%d, j=%d) do not match\n", i, j );
+                    error = 1;
+                    break;
+                }
+            }
+        }
+
+        for ( int i=0; i < n_inputs; i++ ){
+            memcpy( &ref_outputs[i*N_SIGNALS], IIR_MD_add_input( ref_filter, &frames[i*N_SIGNALS] ),
+                    sizeof(IIR_signal_t) * N_SIGNALS );
+        }
+
+        
+        // Frame by frame
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            error = compare_frame( &ref_outputs[i*N_SIGNALS], IIR_MD_add_input( filter, &frames[i*N_SIGNALS] ), i, "add_input" );
+        }
+        
+        // Blocks (in place)
+        IIR_MD_reset( filter );
+        memcpy( outputs, frames, sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_MD_process_in_place( filter, &outputs[i*N_SIGNALS], n );
+        }
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            error = compare_frame( &ref_outputs[i*N_SIGNALS], &outputs[i*N_SIGNALS], i, "block" );
+        }
+        if ( !error ){
+            error = compare_frame( &ref_outputs[(n_inputs-1)*N_SIGNALS], IIR_MD_get_last_output(filter), n_inputs-1, "last output" );
+        }
+
+        // Strided: planar layout in one buffer (frame stride 1, signal stride n_inputs)
+        IIR_signal_t *planar = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                planar[j*n_inputs + i] = frames[i*N_SIGNALS + j];
+            }
+        }
+        IIR_MD_reset( filter );
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_MD_process_strided( filter, &planar[i], 1, n_inputs, &outputs[i*N_SIGNALS], N_SIGNALS, 1, n );
+        }
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            error = compare_frame( &ref_outputs[i*N_SIGNALS], &outputs[i*N_SIGNALS], i, "strided" );
+        }
+
+        // Planar (one pointer per signal, in place)
+        IIR_MD_reset( filter );
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_signal_t *xy[N_SIGNALS];
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                xy[j] = &planar[j*n_inputs + i];
+            }
+            IIR_MD_process_planar( filter, (const IIR_signal_t *const *)xy, xy, n );
+        }
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                if ( planar[j*n_inputs + i] != ref_outputs[i*N_SIGNALS + j] ){
+                    printf( "ERROR: planar (i=%d, j=%d)\n", i, j );
+                    error = 1;
+                    break;
+                }
+            }
+        }
+
+        // Write non normalized coefs through the macros and normalize all
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            for ( int i=0; i < n_coefs; i++ ){
+                IIR_MD_COEFS_A_INDEX(ref_filter, i, j) *= (j+2);
+                IIR_MD_COEFS_B_INDEX(ref_filter, i, j) *= (j+2);
+                IIR_MD_COEFS_A_INDEX(filter, i, j) *= (j+2);
+                IIR_MD_COEFS_B_INDEX(filter, i, j) *= (j+2);
+            }
+        }
+        if ( !IIR_MD_normalize_all_coefs(ref_filter) || !IIR_MD_normalize_all_coefs(filter) ){
+            printf( "ERROR: normalization failed\n" );
+            error = 1;
+        }
+        for ( int j=0; (j < N_SIGNALS) && !error; j++ ){
+            for ( int i=0; i < n_coefs; i++ ){
+                if ( (IIR_MD_COEFS_A_INDEX(ref_filter, i, j) != IIR_MD_COEFS_A_INDEX(filter, i, j))
+                        || (IIR_MD_COEFS_B_INDEX(ref_filter, i, j) != IIR_MD_COEFS_B_INDEX(filter, i, j)) ){
+                    printf( "ERROR: normalized coefs (i=%d, j=%d) do not match\n", i, j );
+                    error = 1;
+                    break;
+                }
+            }
+        }
+
+        IIR_MD_destroy(ref_filter);
+        IIR_MD_destroy(filter);
+        free(frames);
+        free(ref_outputs);
+        free(outputs);
+        free(planar);
+        
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_MD: coefficient major layout outputs do not match the signal major ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MD: coefficient major layout outputs match the signal major ones\n" );
+    return EXIT_SUCCESS;
+}
@@ -30,8 +30,8 @@
 
 int main(int argc, char** argv) {
     
-    IIR_signal_t a_coefs[20];
-    IIR_signal_t b_coefs[20];
+    IIR_signal_t a_coefs[20*40] = {1.0};
+    IIR_signal_t b_coefs[20*40] = {1.0};
     
     int error = EXIT_SUCCESS;
     if ( IIR_MD_create( 20, 0, b_coefs, a_coefs ) ){
@@ -69,6 +69,26 @@ int main(int argc, char** argv) {
         printf( "SUCCESS: IIR_MS: Filter with negative number of coefficients is invalid\n" );
     }
     
+    // One aligned block: z, a, b and last_output aligned and inside the block
+    for ( int layout=0; layout < 2; layout++ ){
+        for ( int n_signals=1; n_signals <= 40; n_signals+=13 ){
+            IIR_MD_t *filter = IIR_MD_create_layout( 20, n_signals, b_coefs, a_coefs, layout );
+            int padded = filter->_padded_signals;
+            char *block = (char*) filter;
+            char *end = block + _IIR_M_BLOCK_SIZE(20, filter->_capacity, padded, 1);
+            IIR_signal_t *arrays[4] = { filter->z, filter->a, filter->b, filter->last_output };
+            int sizes[4] = { 20*padded, 20*padded, 20*padded, filter->_capacity };
+            for ( int i=0; i < 4; i++ ){
+                if ( ((size_t)arrays[i] % IIR_SIMD_ALIGNMENT) || ((char*)arrays[i] < block)
+                        || ((char*)(arrays[i] + sizes[i]) > end) ){
+                    error = EXIT_FAILURE;
+                    printf( "ERROR: IIR_MD: array %d (layout %d, %d signals) not aligned or out of the filter block\n", i, layout, n_signals );
+                }
+            }
+            IIR_MD_destroy( filter );
+        }
+    }
+
     if ( error == EXIT_SUCCESS ){
         printf( "SUCCESS: IIR_MS: all tests passed\n" );
     }else{
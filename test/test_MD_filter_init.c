@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 12:35 AM
+ */
+
+// Checks MS and MD filters built in caller memory (IIR_MS_init_layout,
+// IIR_MD_init_layout), in both layouts, against the created ones, bit by
+// bit, and the parameters refused by the init functions.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 11
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + k] = inputs[i] + noise;
+            }
+        }
+
+        // Not valid parameters
+        char *buffer = (char*) _IIR_aligned_malloc( IIR_MD_required_bytes_layout( n_coefs, N_SIGNALS, IIR_M_LAYOUT_COEF_MAJOR ) );
+        if ( IIR_MS_required_bytes( 1, N_SIGNALS ) || IIR_MD_required_bytes( n_coefs, 0 )
+                || IIR_MS_required_bytes_layout( n_coefs, N_SIGNALS, 5 )
+                || IIR_MD_init( buffer, n_coefs, -1, b_coefs, a_coefs )
+                || IIR_MS_init( NULL, n_coefs, N_SIGNALS, b_coefs, a_coefs )
+                || IIR_MD_init( buffer + sizeof(IIR_signal_t), n_coefs, N_SIGNALS, b_coefs, a_coefs ) ){
+            printf( "ERROR: IIR_MS_init/IIR_MD_init accepted invalid parameters\n" );
+            error = 1;
+        }
+        free( buffer );
+
+        for ( int layout=0; (layout < 2) && !error; layout++ ){
+            for ( int md=0; (md < 2) && !error; md++ ){
+                const char *name = md ? "IIR_MD" : "IIR_MS";
+                size_t n_bytes = md ? IIR_MD_required_bytes_layout( n_coefs, N_SIGNALS, layout )
+                                    : IIR_MS_required_bytes_layout( n_coefs, N_SIGNALS, layout );
+                buffer = (char*) _IIR_aligned_malloc( n_bytes );
+                IIR_M_t *filter = md ? IIR_MD_init_layout( buffer, n_coefs, N_SIGNALS, b_coefs, a_coefs, layout )
+                                     : IIR_MS_init_layout( buffer, n_coefs, N_SIGNALS, b_coefs, a_coefs, layout );
+                IIR_M_t *ref_filter = md ? IIR_MD_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, layout )
+                                         : IIR_MS_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, layout );
+                if ( !filter || ((void*)filter != (void*)buffer) ){
+                    printf( "ERROR: %s init failed (layout %d)\n", name, layout );
+                    error = 1;
+                    break;
+                }
+
+                // Slightly different b coefs for each signal of the MD filters
+                for ( int k=0; md && (k < N_SIGNALS); k++ ){
+                    IIR_signal_t b_k[n_coefs];
+                    for ( int c=0; c < n_coefs; c++ ){
+                        b_k[c] = b_coefs[c] + ((c%2) ? COEF_STEP_RANGE * k : 0);
+                    }
+                    IIR_MD_set_coefs_one_signal( filter, n_coefs, b_k, a_coefs, k );
+                    IIR_MD_set_coefs_one_signal( ref_filter, n_coefs, b_k, a_coefs, k );
+                }
+
+                for ( int i=0; (i < n_inputs) && !error; i++ ){
+                    IIR_signal_t *y = md ? IIR_MD_add_input( filter, &frames[i*N_SIGNALS] )
+                                         : IIR_MS_add_input( filter, &frames[i*N_SIGNALS] );
+                    IIR_signal_t *ref_y = md ? IIR_MD_add_input( ref_filter, &frames[i*N_SIGNALS] )
+                                             : IIR_MS_add_input( ref_filter, &frames[i*N_SIGNALS] );
+                    for ( int k=0; k < N_SIGNALS; k++ ){
+                        if ( y[k] != ref_y[k] ){
+                            printf( "ERROR: %s init filter output (layout %d, i=%d, signal %d) %f != %f\n", name, layout, i, k, y[k], ref_y[k] );
+                            error = 1;
+                            break;
+                        }
+                    }
+                }
+
+                // Everything inside the buffer
+                if ( ((char*)filter->last_output < buffer)
+                        || ((char*)(filter->last_output + N_SIGNALS) > buffer + n_bytes) ){
+                    printf( "ERROR: %s init filter arrays out of the buffer (layout %d)\n", name, layout );
+                    error = 1;
+                }
+
+                _IIR_M_deinit( filter );
+                free( buffer );
+                _IIR_M_destroy( ref_filter );
+            }
+        }
+
+        free( frames );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_MS/IIR_MD: filters built in caller memory do not match the created ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MS/IIR_MD: filters built in caller memory match the created ones\n" );
+    return EXIT_SUCCESS;
+}
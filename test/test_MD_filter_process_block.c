@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 5
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.01
+// Odd block size so the last block is a partial one
+#define BLOCK_SIZE 37
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // Build N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *block_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + j] = inputs[i] + noise;
+            }
+        }
+
+        // Create two filters: one fed frame by frame, one fed by blocks
+        IIR_MD_t *filter1 = IIR_MD_create( n_coefs, N_SIGNALS, b_coefs, a_coefs );
+        IIR_MD_t *filter2 = IIR_MD_create( n_coefs, N_SIGNALS, b_coefs, a_coefs );
+        // And a third one fed by blocks with one buffer per signal
+        IIR_MD_t *filter3 = IIR_MD_create( n_coefs, N_SIGNALS, b_coefs, a_coefs );
+        // And a fourth one fed with strided inputs/outputs (base + channel stride)
+        IIR_MD_t *filter4 = IIR_MD_create( n_coefs, N_SIGNALS, b_coefs, a_coefs );
+
+        // Use slightly different coefs for each signal
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            for ( int i=1; i < n_coefs; i++ ){
+                b_coefs[i] += (i%2) * COEF_STEP_RANGE * i/2;
+                a_coefs[i] -= (i%2) * COEF_STEP_RANGE * i/2;
+            }
+            IIR_MD_set_coefs_one_signal( filter1, n_coefs, b_coefs, a_coefs, j );
+            IIR_MD_set_coefs_one_signal( filter2, n_coefs, b_coefs, a_coefs, j );
+            IIR_MD_set_coefs_one_signal( filter3, n_coefs, b_coefs, a_coefs, j );
+            IIR_MD_set_coefs_one_signal( filter4, n_coefs, b_coefs, a_coefs, j );
+        }
+        
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_MD_process_block( filter2, &frames[i*N_SIGNALS], &block_outputs[i*N_SIGNALS], n );
+        }
+        
+        // Planar copy of the inputs
+        IIR_signal_t *planar_inputs[N_SIGNALS];
+        IIR_signal_t *planar_outputs[N_SIGNALS];
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            planar_inputs[j] = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+            planar_outputs[j] = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+            for ( int i=0; i < n_inputs; i++ ){
+                planar_inputs[j][i] = frames[i*N_SIGNALS + j];
+            }
+        }
+
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            const IIR_signal_t *x[N_SIGNALS];
+            IIR_signal_t *y[N_SIGNALS];
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                x[j] = planar_inputs[j] + i;
+                y[j] = planar_outputs[j] + i;
+            }
+            IIR_MD_process_planar( filter3, x, y, n );
+        }
+
+        // Planar layout in one buffer: frame stride 1, signal stride n_inputs
+        IIR_signal_t *strided_inputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *strided_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                strided_inputs[j*n_inputs + i] = frames[i*N_SIGNALS + j];
+            }
+        }
+
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_MD_process_strided( filter4, &strided_inputs[i], 1, n_inputs,
+                                    &strided_outputs[i], 1, n_inputs, n );
+        }
+
+        // Outputs must match bit by bit
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            IIR_signal_t *this_output = IIR_MD_add_input( filter1, &frames[i*N_SIGNALS] );
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                if ( this_output[j] != block_outputs[i*N_SIGNALS + j] ){
+                    printf( "ERROR: (i=%d, j=%d) %f != %f\n", i, j, this_output[j], block_outputs[i*N_SIGNALS + j] );
+                    error = 1;
+                    break;
+                }
+                if ( planar_outputs[j][i] != block_outputs[i*N_SIGNALS + j] ){
+                    printf( "ERROR: planar (i=%d, j=%d) %f != %f\n", i, j, planar_outputs[j][i], block_outputs[i*N_SIGNALS + j] );
+                    error = 1;
+                    break;
+                }
+                if ( strided_outputs[j*n_inputs + i] != block_outputs[i*N_SIGNALS + j] ){
+                    printf( "ERROR: strided (i=%d, j=%d) %f != %f\n", i, j, strided_outputs[j*n_inputs + i], block_outputs[i*N_SIGNALS + j] );
+                    error = 1;
+                    break;
+                }
+            }
+        }
+        
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            if ( (IIR_MD_get_last_output(filter1)[j] != IIR_MD_get_last_output(filter2)[j])
+                    || (IIR_MD_get_last_output(filter1)[j] != IIR_MD_get_last_output(filter3)[j])
+                    || (IIR_MD_get_last_output(filter1)[j] != IIR_MD_get_last_output(filter4)[j]) ){
+                printf( "ERROR: last outputs do not match after block processing (j=%d)\n", j );
+                error = 1;
+            }
+        }
+
+        IIR_MD_destroy(filter1);
+        IIR_MD_destroy(filter2);
+        IIR_MD_destroy(filter3);
+        IIR_MD_destroy(filter4);
+        free(strided_inputs);
+        free(strided_outputs);
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            free(planar_inputs[j]);
+            free(planar_outputs[j]);
+        }
+        free(frames);
+        free(block_outputs);
+        
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_MD: Block processing outputs do not match the frame by frame outputs\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MD: Block processing outputs match the frame by frame outputs\n" );
+    return EXIT_SUCCESS;
+}
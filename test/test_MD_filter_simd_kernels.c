@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 11:40 AM
+ */
+
+// Checks every vectorized coefficient major kernel (MS and MD) supported by
+// this CPU against the scalar kernel. Outputs and states must match bit by
+// bit (unless IIR_USE_FMA is defined, then they are not checked).
+// Also checks the runtime selection of the kernels (API and environment
+// variable) with complete coefficient major MD filters.
+
+// setenv/unsetenv are POSIX (not declared with -std=c11 otherwise)
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Not a multiple of any vector width
+#define N_SIGNALS 150
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.01
+
+typedef void (*kernel_t)(int, int, const IIR_signal_t *, const IIR_signal_t *,
+			 IIR_signal_t *, const IIR_signal_t *, IIR_signal_t *, int);
+
+typedef struct {
+    const char *name;
+    kernel_t ms_kernel;
+    kernel_t md_kernel;
+    int supported;
+} kernel_desc_t;
+
+// Run all the frames through a kernel, starting at signal k0, and compare
+// outputs and final states with the scalar kernel
+static int check_kernel(const char *name, kernel_t kernel, kernel_t scalar_kernel,
+			int n_coefs, int stride, int k0,
+			const IIR_signal_t *a, const IIR_signal_t *b,
+			const IIR_signal_t *frames, int n_inputs){
+
+    int error = 0;
+    int m = N_SIGNALS - k0;
+    size_t z_size = sizeof(IIR_signal_t) * n_coefs * stride;
+    IIR_signal_t *ref_z = (IIR_signal_t*) _IIR_aligned_malloc( z_size );
+    IIR_signal_t *z = (IIR_signal_t*) _IIR_aligned_malloc( z_size );
+    IIR_signal_t ref_y[N_SIGNALS], y[N_SIGNALS];
+
+    memset( ref_z, 0, z_size );
+    memset( z, 0, z_size );
+
+    for ( int i=0; (i < n_inputs) && !error; i++ ){
+        const IIR_signal_t *x = &frames[i*N_SIGNALS + k0];
+        scalar_kernel( n_coefs, stride, a, b, ref_z + k0, x, ref_y, m );
+        kernel( n_coefs, stride, a, b, z + k0, x, y, m );
+#ifndef IIR_USE_FMA
+        for ( int k=0; k < m; k++ ){
+            if ( ref_y[k] != y[k] ){
+                printf( "ERROR: %s output (k0=%d, i=%d, k=%d) %f != %f\n", name, k0, i, k, ref_y[k], y[k] );
+                error = 1;
+                break;
+            }
+        }
+#endif
+    }
+
+#ifndef IIR_USE_FMA
+    for ( int j=0; (j < n_coefs-1) && !error; j++ ){
+        for ( int k=k0; k < N_SIGNALS; k++ ){
+            if ( ref_z[j*stride + k] != z[j*stride + k] ){
+                printf( "ERROR: %s state (k0=%d, j=%d, k=%d)\n", name, k0, j, k );
+                error = 1;
+                break;
+            }
+        }
+    }
+#endif
+
+    free( ref_z );
+    free( z );
+
+    return error;
+}
+
+// Filter all the frames with a coefficient major MD filter using the kernel
+// for the given level and store the outputs
+static int filter_with_level(int level, int n_coefs, const IIR_signal_t *b_coefs, const IIR_signal_t *a_coefs,
+                             const IIR_signal_t *frames, int n_inputs, IIR_signal_t *outputs){
+
+    IIR_MD_t *filter = IIR_MD_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR );
+    if ( !filter ){
+        printf( "ERROR: unable to create the filter\n" );
+        return 0;
+    }
+
+    int supported = IIR_MD_set_simd_level( filter, level );
+    if ( supported != (level <= IIR_simd_cpu_level()) ){
+        printf( "ERROR: level %d support (%d) does not match the CPU level %d\n", level, supported, IIR_simd_cpu_level() );
+        IIR_MD_destroy( filter );
+        return -1;
+    }
+
+    if ( supported ){
+        IIR_MD_process_block( filter, frames, outputs, n_inputs );
+    }
+    IIR_MD_destroy( filter );
+
+    return supported;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+        int stride = ((N_SIGNALS + IIR_SIMD_SIGNALS - 1) / IIR_SIMD_SIGNALS) * IIR_SIMD_SIGNALS;
+
+        IIR_normalize_coefs( n_coefs, b_coefs, a_coefs );
+
+        // Coef rows for the MD kernels, slightly different for each signal
+        IIR_signal_t *a_rows = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * stride );
+        IIR_signal_t *b_rows = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * stride );
+        for ( int i=0; i < n_coefs; i++ ){
+            for ( int k=0; k < stride; k++ ){
+                a_rows[i*stride + k] = a_coefs[i] - (i ? (i%2) * COEF_STEP_RANGE * k/1000 : 0);
+                b_rows[i*stride + k] = b_coefs[i] + (i%2) * COEF_STEP_RANGE * k/1000;
+            }
+        }
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + k] = inputs[i] + noise;
+            }
+        }
+
+        kernel_desc_t kernels[] = {
+#ifdef IIR_HAVE_X86_KERNELS
+            { "sse2", _IIR_MS_coef_major_kernel_sse2, _IIR_MD_coef_major_kernel_sse2,
+              __builtin_cpu_supports("sse2") },
+            { "avx2", _IIR_MS_coef_major_kernel_avx2, _IIR_MD_coef_major_kernel_avx2,
+              __builtin_cpu_supports("avx2")
+#ifdef IIR_USE_FMA
+              && __builtin_cpu_supports("fma")
+#endif
+            },
+            { "avx512", _IIR_MS_coef_major_kernel_avx512, _IIR_MD_coef_major_kernel_avx512,
+              __builtin_cpu_supports("avx512f") },
+#endif
+            { "scalar", _IIR_MS_coef_major_kernel_scalar, _IIR_MD_coef_major_kernel_scalar, 1 }
+        };
+        int n_kernels = sizeof(kernels)/sizeof(kernels[0]);
+
+        for ( int t=0; (t < n_kernels) && !error; t++ ){
+            if ( !kernels[t].supported ){
+                printf( "Kernel %s not supported by this CPU, skipped\n", kernels[t].name );
+                continue;
+            }
+            // Aligned start and a misaligned start with an odd number of signals
+            for ( int k0=0; (k0 < 2) && !error; k0++ ){
+                error = check_kernel( kernels[t].name, kernels[t].ms_kernel, _IIR_MS_coef_major_kernel_scalar,
+                                      n_coefs, stride, k0, a_coefs, b_coefs, frames, n_inputs )
+                     || check_kernel( kernels[t].name, kernels[t].md_kernel, _IIR_MD_coef_major_kernel_scalar,
+                                      n_coefs, stride, k0, a_rows + k0, b_rows + k0, frames, n_inputs );
+            }
+        }
+
+        // Runtime selection through the API: all levels give the same outputs
+        IIR_signal_t *ref_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        if ( filter_with_level( IIR_SIMD_LEVEL_SCALAR, n_coefs, b_coefs, a_coefs, frames, n_inputs, ref_outputs ) != 1 ){
+            error = 1;
+        }
+        for ( int level=IIR_SIMD_LEVEL_SSE2; (level <= IIR_SIMD_LEVEL_AVX512) && !error; level++ ){
+            int result = filter_with_level( level, n_coefs, b_coefs, a_coefs, frames, n_inputs, outputs );
+            if ( result < 0 ){
+                error = 1;
+            }
+#ifndef IIR_USE_FMA
+            for ( int i=0; (result == 1) && (i < n_inputs*N_SIGNALS); i++ ){
+                if ( ref_outputs[i] != outputs[i] ){
+                    printf( "ERROR: level %d output %d %f != %f\n", level, i, ref_outputs[i], outputs[i] );
+                    error = 1;
+                    break;
+                }
+            }
+#endif
+        }
+
+        // Runtime selection through the environment variable
+        const char *env_values[] = { "scalar", "1", "avx2", "avx512" };
+        for ( int level=IIR_SIMD_LEVEL_SCALAR; (level <= IIR_SIMD_LEVEL_AVX512) && !error; level++ ){
+            setenv( IIR_SIMD_LEVEL_ENV, env_values[level], 1 );
+            IIR_simd_refresh_level();
+            IIR_MS_t *filter = IIR_MS_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR );
+            int expected = (level < IIR_simd_cpu_level()) ? level : IIR_simd_cpu_level();
+            if ( filter->simd_level != expected ){
+                printf( "ERROR: %s=%s selected level %d (expected %d)\n", IIR_SIMD_LEVEL_ENV, env_values[level], filter->simd_level, expected );
+                error = 1;
+            }
+            IIR_MS_destroy( filter );
+        }
+
+        // Filters built in caller memory use the detected level, without
+        // reading the environment again
+        setenv( IIR_SIMD_LEVEL_ENV, "scalar", 1 );
+        IIR_simd_refresh_level();
+        setenv( IIR_SIMD_LEVEL_ENV, "not a level", 1 );
+        void *buffer = _IIR_aligned_malloc( IIR_MS_required_bytes_layout( n_coefs, N_SIGNALS, IIR_M_LAYOUT_COEF_MAJOR ) );
+        IIR_MS_t *init_filter = IIR_MS_init_layout( buffer, n_coefs, N_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR );
+        if ( !error && (!init_filter || (init_filter->simd_level != IIR_SIMD_LEVEL_SCALAR)) ){
+            printf( "ERROR: the filter built in caller memory does not use the detected level\n" );
+            error = 1;
+        }
+        free( buffer );
+        unsetenv( IIR_SIMD_LEVEL_ENV );
+        IIR_simd_refresh_level();
+
+        free( a_rows );
+        free( b_rows );
+        free( frames );
+        free( ref_outputs );
+        free( outputs );
+        
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_MS/IIR_MD: vectorized kernels outputs do not match the scalar ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MS/IIR_MD: vectorized kernels outputs match the scalar ones\n" );
+    return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include <time.h>
 
 #include "IIR_filters.h"
+#include "load_test_reference_file.h"
 
 #define STR_VALUE2(arg) #arg
 #define STR_VALUE(name) STR_VALUE2(name)
@@ -33,6 +34,20 @@
 
 #define DEFAULT_CYCLES 2000000
 #define DEFAULT_SIGNALS 300
+#define BLOCK_FRAMES 256
+// Filter structures (IIR_STRUCTURE_*) compared
+#define N_STRUCTURES 4
+// Low order filters (n_coefs 2 to 5) compared with the generic loop
+// Filters of the bank built from a coefficient table (and times it is built)
+#define BANK_SIGNALS 10000
+#define BANK_REPEATS 20
+// Signals and different coef sets of the grouped coefs filter
+#define GROUPED_SIGNALS 2000
+#define GROUPED_SETS 10
+// Signals of the variable orders filter (n_coefs 3, 5 and n_coefs, mixed)
+#define VARIABLE_SIGNALS 2000
+// Signals added one by one to a filter
+#define GROWING_SIGNALS 2000
 
 int main(int argc, char** argv) {
     
@@ -89,6 +104,258 @@ int main(int argc, char** argv) {
         printf( "\n" );
     }
     
+    // Same number of inputs, but processed in blocks of BLOCK_FRAMES frames
+    IIR_signal_t *block_input = (IIR_signal_t*) malloc( BLOCK_FRAMES * n_signals * sizeof(IIR_signal_t) );
+    IIR_signal_t *block_output = (IIR_signal_t*) malloc( BLOCK_FRAMES * n_signals * sizeof(IIR_signal_t) );
+    for ( int i=0; i<BLOCK_FRAMES*n_signals; i++ ){
+        block_input[i] = 1.5;
+    }
+    IIR_MD_reset( filter );
+
+    clock_t c3 = clock();
+
+    for ( long int i=0; i<n_cycles; i+=BLOCK_FRAMES ){
+        int n = (n_cycles-i < BLOCK_FRAMES) ? (int)(n_cycles-i) : BLOCK_FRAMES;
+        IIR_MD_process_block(filter, block_input, block_output, n);
+    }
+
+    clock_t c4 = clock();
+
+    // Same frame by frame test with the coefficient major layout
+    IIR_MD_t *cm_filter = IIR_MD_create_layout( n_coefs, n_signals, b, a, IIR_M_LAYOUT_COEF_MAJOR );
+
+    clock_t c5 = clock();
+
+    for ( int i=0; i<n_cycles; i++ ){
+        IIR_MD_add_input(cm_filter, input);
+    }
+
+    clock_t c6 = clock();
+
+    // Frame by frame, copying the outputs to the caller: a copy allocated
+    // on every call against add_input_to writing them straight to y
+    IIR_signal_t *frame_output = (IIR_signal_t*) malloc( n_signals * sizeof(IIR_signal_t) );
+    IIR_MD_reset( filter );
+
+    clock_t c7 = clock();
+
+    for ( int i=0; i<n_cycles; i++ ){
+        IIR_MD_add_input(filter, input);
+        IIR_signal_t *copy = IIR_MD_get_last_output_copy(filter);
+        free( copy );
+    }
+
+    clock_t c8 = clock();
+
+    IIR_MD_reset( filter );
+
+    clock_t c9 = clock();
+
+    for ( int i=0; i<n_cycles; i++ ){
+        IIR_MD_add_input_to(filter, input, frame_output);
+    }
+
+    clock_t c10 = clock();
+
+    // Building a bank of BANK_SIGNALS filters from a coefficient table: one
+    // IIR_MD_set_coefs_one_signal for each signal against IIR_MD_create_bank
+    IIR_signal_t *a_table = (IIR_signal_t*) malloc( BANK_SIGNALS * n_coefs * sizeof(IIR_signal_t) );
+    IIR_signal_t *b_table = (IIR_signal_t*) malloc( BANK_SIGNALS * n_coefs * sizeof(IIR_signal_t) );
+    for ( int k=0; k<BANK_SIGNALS; k++ ){
+        for ( int c=0; c<n_coefs; c++ ){
+            a_table[k*n_coefs + c] = a[c] * (1 + k % 3);
+            b_table[k*n_coefs + c] = b[c] * (1 + k % 3);
+        }
+    }
+    double bank_times[2], per_signal_times[2];
+    for ( int layout=0; layout<2; layout++ ){
+        clock_t cb1 = clock();
+        for ( int r=0; r<BANK_REPEATS; r++ ){
+            IIR_MD_t *bank = IIR_MD_create_layout( n_coefs, BANK_SIGNALS, NULL, NULL, layout );
+            for ( int k=0; k<BANK_SIGNALS; k++ ){
+                IIR_MD_set_coefs_one_signal( bank, n_coefs, &b_table[k*n_coefs], &a_table[k*n_coefs], k );
+            }
+            IIR_MD_destroy( bank );
+        }
+        clock_t cb2 = clock();
+        for ( int r=0; r<BANK_REPEATS; r++ ){
+            IIR_MD_t *bank = IIR_MD_create_bank_layout( n_coefs, BANK_SIGNALS, b_table, a_table, layout );
+            IIR_MD_destroy( bank );
+        }
+        clock_t cb3 = clock();
+        per_signal_times[layout] = (double)(cb2-cb1)/CLOCKS_PER_SEC;
+        bank_times[layout] = (double)(cb3-cb2)/CLOCKS_PER_SEC;
+    }
+    // Adding GROWING_SIGNALS signals one by one: IIR_MD_add_signal against
+    // creating a filter with one more signal and copying the state
+    clock_t ca1 = clock();
+    IIR_MD_t *growing = IIR_MD_create( n_coefs, 1, b, a );
+    for ( int k=1; k<GROWING_SIGNALS; k++ ){
+        growing = IIR_MD_add_signal( growing, n_coefs, &b_table[k*n_coefs], &a_table[k*n_coefs] );
+    }
+    IIR_MD_destroy( growing );
+    clock_t ca2 = clock();
+    growing = IIR_MD_create( n_coefs, 1, b, a );
+    for ( int k=1; k<GROWING_SIGNALS; k++ ){
+        IIR_MD_t *recreated = IIR_MD_create_bank( n_coefs, k+1, b_table, a_table );
+        memcpy( recreated->z, growing->z, sizeof(IIR_signal_t) * n_coefs * k );
+        memcpy( recreated->last_output, growing->last_output, sizeof(IIR_signal_t) * k );
+        IIR_MD_destroy( growing );
+        growing = recreated;
+    }
+    IIR_MD_destroy( growing );
+    clock_t ca3 = clock();
+
+    // Grouped coefs: GROUPED_SIGNALS signals sharing GROUPED_SETS coef sets
+    // (the signals of each set one after the other), IIR_MG against a
+    // coefficient major IIR_MD with the same coefs
+    for ( int k=0; k<GROUPED_SIGNALS; k++ ){
+        for ( int c=0; c<n_coefs; c++ ){
+            a_table[k*n_coefs + c] = a[c];
+            b_table[k*n_coefs + c] = b[c] * (1 + 0.01 * (k * GROUPED_SETS / GROUPED_SIGNALS));
+        }
+    }
+    IIR_MG_t *mg_filter = IIR_MG_create_table( n_coefs, GROUPED_SIGNALS, b_table, a_table );
+    IIR_MD_t *mg_ref_filter = IIR_MD_create_bank_layout( n_coefs, GROUPED_SIGNALS, b_table, a_table, IIR_M_LAYOUT_COEF_MAJOR );
+    IIR_signal_t *grouped_x = (IIR_signal_t*) malloc( BLOCK_FRAMES * GROUPED_SIGNALS * sizeof(IIR_signal_t) );
+    IIR_signal_t *grouped_y = (IIR_signal_t*) malloc( BLOCK_FRAMES * GROUPED_SIGNALS * sizeof(IIR_signal_t) );
+    for ( int i=0; i<BLOCK_FRAMES*GROUPED_SIGNALS; i++ ){
+        grouped_x[i] = 1.5;
+    }
+    long int grouped_cycles = n_cycles * n_signals / GROUPED_SIGNALS;
+
+    clock_t cg1 = clock();
+    for ( long int i=0; i<grouped_cycles; i+=BLOCK_FRAMES ){
+        int n = (grouped_cycles-i < BLOCK_FRAMES) ? (int)(grouped_cycles-i) : BLOCK_FRAMES;
+        IIR_MG_process_block(mg_filter, grouped_x, grouped_y, n);
+    }
+    clock_t cg2 = clock();
+    for ( long int i=0; i<grouped_cycles; i+=BLOCK_FRAMES ){
+        int n = (grouped_cycles-i < BLOCK_FRAMES) ? (int)(grouped_cycles-i) : BLOCK_FRAMES;
+        IIR_MD_process_block(mg_ref_filter, grouped_x, grouped_y, n);
+    }
+    clock_t cg3 = clock();
+
+    IIR_MG_destroy( mg_filter );
+    IIR_MD_destroy( mg_ref_filter );
+    free( grouped_x );
+    free( grouped_y );
+    free( a_table );
+    free( b_table );
+
+    // Variable orders: IIR_MV against an IIR_MD with the short filters
+    // padded with zero coefs up to n_coefs
+    int variable_n_coefs[VARIABLE_SIGNALS];
+    const IIR_signal_t *variable_b[VARIABLE_SIGNALS];
+    const IIR_signal_t *variable_a[VARIABLE_SIGNALS];
+    IIR_signal_t a_short[] = { 1.0, -0.5, 0, 0, 0, 0, 0, 0, 0 };
+    IIR_signal_t b_short[] = { 0.1, 0.2, 0.1, 0.2, 0.1, 0, 0, 0, 0 };
+    IIR_signal_t *padded_a_table = (IIR_signal_t*) malloc( n_coefs * VARIABLE_SIGNALS * sizeof(IIR_signal_t) );
+    IIR_signal_t *padded_b_table = (IIR_signal_t*) malloc( n_coefs * VARIABLE_SIGNALS * sizeof(IIR_signal_t) );
+    for ( int k=0; k<VARIABLE_SIGNALS; k++ ){
+        int short_filter = (k % 3) < 2;
+        variable_n_coefs[k] = short_filter ? 3 + 2*(k % 3) : n_coefs;
+        variable_b[k] = short_filter ? b_short : b;
+        variable_a[k] = short_filter ? a_short : a;
+        for ( int c=0; c<n_coefs; c++ ){
+            padded_a_table[k*n_coefs + c] = (c < variable_n_coefs[k]) ? variable_a[k][c] : 0;
+            padded_b_table[k*n_coefs + c] = (c < variable_n_coefs[k]) ? variable_b[k][c] : 0;
+        }
+    }
+    IIR_MV_t *mv_filter = IIR_MV_create( VARIABLE_SIGNALS, variable_n_coefs, variable_b, variable_a );
+    IIR_MD_t *mv_ref_filter = IIR_MD_create_bank_layout( n_coefs, VARIABLE_SIGNALS, padded_b_table, padded_a_table, IIR_M_LAYOUT_COEF_MAJOR );
+    IIR_signal_t *variable_x = (IIR_signal_t*) malloc( BLOCK_FRAMES * VARIABLE_SIGNALS * sizeof(IIR_signal_t) );
+    IIR_signal_t *variable_y = (IIR_signal_t*) malloc( BLOCK_FRAMES * VARIABLE_SIGNALS * sizeof(IIR_signal_t) );
+    for ( int i=0; i<BLOCK_FRAMES*VARIABLE_SIGNALS; i++ ){
+        variable_x[i] = 1.5;
+    }
+    long int variable_cycles = n_cycles * n_signals / VARIABLE_SIGNALS;
+
+    clock_t cv1 = clock();
+    for ( long int i=0; i<variable_cycles; i+=BLOCK_FRAMES ){
+        int n = (variable_cycles-i < BLOCK_FRAMES) ? (int)(variable_cycles-i) : BLOCK_FRAMES;
+        IIR_MV_process_block(mv_filter, variable_x, variable_y, n);
+    }
+    clock_t cv2 = clock();
+    for ( long int i=0; i<variable_cycles; i+=BLOCK_FRAMES ){
+        int n = (variable_cycles-i < BLOCK_FRAMES) ? (int)(variable_cycles-i) : BLOCK_FRAMES;
+        IIR_MD_process_block(mv_ref_filter, variable_x, variable_y, n);
+    }
+    clock_t cv3 = clock();
+
+    IIR_MV_destroy( mv_filter );
+    IIR_MD_destroy( mv_ref_filter );
+    free( variable_x );
+    free( variable_y );
+    free( padded_a_table );
+    free( padded_b_table );
+
+    // Same blocks with every filter structure
+    const char *structure_names[N_STRUCTURES] = { "TDF2", "DF1", "DF2", "LATTICE" };
+    double structure_times[N_STRUCTURES];
+    for ( int s=0; s<N_STRUCTURES; s++ ){
+        IIR_MD_t *s_filter = IIR_MD_create_structure( n_coefs, n_signals, b, a, s );
+        structure_times[s] = -1;
+        if ( !s_filter ){
+            continue;
+        }
+
+        clock_t cs1 = clock();
+
+        for ( long int i=0; i<n_cycles; i+=BLOCK_FRAMES ){
+            int n = (n_cycles-i < BLOCK_FRAMES) ? (int)(n_cycles-i) : BLOCK_FRAMES;
+            IIR_MD_process_block(s_filter, block_input, block_output, n);
+        }
+
+        clock_t cs2 = clock();
+
+        structure_times[s] = (double)(cs2-cs1)/CLOCKS_PER_SEC;
+        IIR_MD_destroy( s_filter );
+    }
+
+    // Low order filters (Butterworth, order 1 to 4): IIR_MD_process_block
+    // (unrolled kernels) and the generic loop (_IIR_step_tdf2) on each signal
+    double low_times[TEST_LOW_ORDERS], generic_times[TEST_LOW_ORDERS];
+    for ( int o=0; o<TEST_LOW_ORDERS; o++ ){
+        int low_n_coefs = o+2;
+        IIR_MD_t *low_filter = IIR_MD_create( low_n_coefs, n_signals, test_low_order_b[o], test_low_order_a[o] );
+
+        clock_t cl1 = clock();
+
+        for ( long int i=0; i<n_cycles; i+=BLOCK_FRAMES ){
+            int n = (n_cycles-i < BLOCK_FRAMES) ? (int)(n_cycles-i) : BLOCK_FRAMES;
+            IIR_MD_process_block(low_filter, block_input, block_output, n);
+        }
+
+        clock_t cl2 = clock();
+
+        IIR_MD_reset( low_filter );
+
+        clock_t cl3 = clock();
+
+        for ( long int i=0; i<n_cycles; i+=BLOCK_FRAMES ){
+            int n = (n_cycles-i < BLOCK_FRAMES) ? (int)(n_cycles-i) : BLOCK_FRAMES;
+            for ( int k=0; k<n_signals; k++ ){
+                for ( int f=0; f<n; f++ ){
+                    block_output[f*n_signals + k] = _IIR_step_tdf2(low_n_coefs,
+                            low_filter->a + k*low_n_coefs, low_filter->b + k*low_n_coefs,
+                            low_filter->z + k*low_n_coefs, block_input[f*n_signals + k]);
+                }
+            }
+        }
+
+        clock_t cl4 = clock();
+
+        low_times[o] = (double)(cl2-cl1)/CLOCKS_PER_SEC;
+        generic_times[o] = (double)(cl4-cl3)/CLOCKS_PER_SEC;
+        IIR_MD_destroy( low_filter );
+    }
+
+    int cm_simd_level = cm_filter->simd_level;
+    IIR_MD_destroy( cm_filter );
+    free( block_input );
+    free( block_output );
+    free( frame_output );
     IIR_MD_destroy( filter );
     
     printf( "Filter correctly destroyed\n" );
@@ -103,6 +370,49 @@ int main(int argc, char** argv) {
     printf( "Test results:\n\tTotal time: %.4lf sec\n", time );
     printf( "\tTime to add one input (%d signals): %.4lf usec\n", n_signals, time/n_cycles*1e6 );
     printf( "\tTime to add one input for one signal: %.4lf usec\n", n_signals, time/(n_cycles*n_signals)*1e6 );
+    double block_time = (double)(c4-c3)/CLOCKS_PER_SEC;
+    printf( "\tTotal time (blocks of %d frames): %.4lf sec\n", BLOCK_FRAMES, block_time );
+    printf( "\tTime to add one input (%d signals, blocks of %d frames): %.4lf usec\n", n_signals, BLOCK_FRAMES, block_time/n_cycles*1e6 );
+    double cm_time = (double)(c6-c5)/CLOCKS_PER_SEC;
+    printf( "\tTotal time (coefficient major layout, SIMD level %d): %.4lf sec\n", cm_simd_level, cm_time );
+    printf( "\tTime to add one input (%d signals, coefficient major layout): %.4lf usec\n", n_signals, cm_time/n_cycles*1e6 );
+    double copy_time = (double)(c8-c7)/CLOCKS_PER_SEC;
+    double to_time = (double)(c10-c9)/CLOCKS_PER_SEC;
+    printf( "\tTime to add one input (%d signals, add_input_to): %.4lf usec (add_input + get_last_output_copy: %.4lf usec, speedup %.2lfx)\n",
+            n_signals, to_time/n_cycles*1e6, copy_time/n_cycles*1e6, copy_time/to_time );
+    for ( int layout=0; layout<2; layout++ ){
+        printf( "\tTime to build a bank of %d filters (layout %d): %.4lf msec (set_coefs_one_signal for each signal: %.4lf msec, speedup %.2lfx)\n",
+                BANK_SIGNALS, layout, bank_times[layout]/BANK_REPEATS*1e3, per_signal_times[layout]/BANK_REPEATS*1e3,
+                per_signal_times[layout]/bank_times[layout] );
+    }
+    double add_time = (double)(ca2-ca1)/CLOCKS_PER_SEC;
+    double recreate_time = (double)(ca3-ca2)/CLOCKS_PER_SEC;
+    printf( "\tTime to add %d signals one by one: %.4lf msec (recreating the filter: %.4lf msec, speedup %.2lfx)\n",
+            GROWING_SIGNALS, add_time*1e3, recreate_time*1e3, recreate_time/add_time );
+    double mg_time = (double)(cg2-cg1)/CLOCKS_PER_SEC;
+    double mg_ref_time = (double)(cg3-cg2)/CLOCKS_PER_SEC;
+    printf( "\tTime to add one input (%d signals, %d coef sets, IIR_MG, blocks of %d frames): %.4lf usec (coefficient major IIR_MD: %.4lf usec, speedup %.2lfx)\n",
+            GROUPED_SIGNALS, GROUPED_SETS, BLOCK_FRAMES, mg_time/grouped_cycles*1e6, mg_ref_time/grouped_cycles*1e6,
+            mg_ref_time/mg_time );
+    double mv_time = (double)(cv2-cv1)/CLOCKS_PER_SEC;
+    double mv_ref_time = (double)(cv3-cv2)/CLOCKS_PER_SEC;
+    printf( "\tTime to add one input (%d signals, n_coefs 3/5/%d, IIR_MV, blocks of %d frames): %.4lf usec (IIR_MD padded to %d coefs: %.4lf usec, speedup %.2lfx)\n",
+            VARIABLE_SIGNALS, n_coefs, BLOCK_FRAMES, mv_time/variable_cycles*1e6, n_coefs, mv_ref_time/variable_cycles*1e6,
+            mv_ref_time/mv_time );
+    for ( int o=0; o<TEST_LOW_ORDERS; o++ ){
+        printf( "\tTime to add one input (%d signals, n_coefs %d, blocks of %d frames): %.4lf usec (generic loop: %.4lf usec, speedup %.2lfx)\n",
+                n_signals, o+2, BLOCK_FRAMES, low_times[o]/n_cycles*1e6, generic_times[o]/n_cycles*1e6,
+                generic_times[o]/low_times[o] );
+    }
+    for ( int s=0; s<N_STRUCTURES; s++ ){
+        if ( structure_times[s] < 0 ){
+            printf( "\tStructure %s: not available for this filter\n", structure_names[s] );
+        }else{
+            printf( "\tTime to add one input (%d signals, structure %s, blocks of %d frames): %.4lf usec (%.2lf Msamples/sec)\n",
+                    n_signals, structure_names[s], BLOCK_FRAMES, structure_times[s]/n_cycles*1e6,
+                    (double)n_cycles*n_signals/structure_times[s]*1e-6 );
+        }
+    }
         
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 9:05 PM
+ */
+
+// Checks the MS and MD filters with every filter structure against one S
+// filter per signal with the same structure (bit by bit), with sample by
+// sample, block and planar processing.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 13
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+#define N_STRUCTURES 4
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+    const char *names[N_STRUCTURES] = { "TDF2", "DF1", "DF2", "LATTICE" };
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+        size_t block_bytes = sizeof(IIR_signal_t) * n_inputs * N_SIGNALS;
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( block_bytes );
+        IIR_signal_t *ref_outputs = (IIR_signal_t*) malloc( block_bytes );
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( block_bytes );
+        IIR_signal_t *planar = (IIR_signal_t*) malloc( block_bytes );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + j] = inputs[i] + noise;
+            }
+        }
+
+        // Slightly different b coefs for each signal of the MD filter
+        IIR_signal_t *all_a = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SIGNALS );
+        IIR_signal_t *all_b = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SIGNALS );
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            for ( int c=0; c < n_coefs; c++ ){
+                all_a[j*n_coefs + c] = a_coefs[c];
+                all_b[j*n_coefs + c] = b_coefs[c] + ((c%2) ? COEF_STEP_RANGE * j : 0);
+            }
+        }
+
+        for ( int s=0; (s < N_STRUCTURES) && !error; s++ ){
+            for ( int md=0; (md < 2) && !error; md++ ){
+                const char *name = md ? "IIR_MD" : "IIR_MS";
+                IIR_M_t *filter = md ? IIR_MD_create_structure( n_coefs, N_SIGNALS, b_coefs, a_coefs, s )
+                                     : IIR_MS_create_structure( n_coefs, N_SIGNALS, b_coefs, a_coefs, s );
+                if ( !filter ){
+                    printf( "ERROR: unable to create the %s %s filter\n", name, names[s] );
+                    error = 1;
+                    break;
+                }
+                // Different coefs for each signal (also updates the lattice coefs)
+                for ( int j=0; md && (j < N_SIGNALS); j++ ){
+                    IIR_MD_set_coefs_one_signal( filter, n_coefs, &all_b[j*n_coefs], &all_a[j*n_coefs], j );
+                }
+
+                // Reference: one S filter per signal
+                for ( int j=0; j < N_SIGNALS; j++ ){
+                    IIR_S_t *s_filter = IIR_S_create_structure( n_coefs, md ? &all_b[j*n_coefs] : b_coefs,
+                                                                md ? &all_a[j*n_coefs] : a_coefs, s );
+                    for ( int i=0; i < n_inputs; i++ ){
+                        ref_outputs[i*N_SIGNALS + j] = IIR_S_add_input( s_filter, frames[i*N_SIGNALS + j] );
+                    }
+                    IIR_S_destroy( s_filter );
+                }
+
+                // Sample by sample
+                for ( int i=0; (i < n_inputs) && !error; i++ ){
+                    IIR_signal_t *y = md ? IIR_MD_add_input( filter, &frames[i*N_SIGNALS] )
+                                         : IIR_MS_add_input( filter, &frames[i*N_SIGNALS] );
+                    for ( int j=0; j < N_SIGNALS; j++ ){
+                        if ( y[j] != ref_outputs[i*N_SIGNALS + j] ){
+                            printf( "ERROR: %s %s add_input (i=%d, signal %d) %f != %f\n", name, names[s], i, j, y[j], ref_outputs[i*N_SIGNALS + j] );
+                            error = 1;
+                            break;
+                        }
+                    }
+                }
+
+                // Block
+                IIR_MD_reset( filter );
+                if ( md ){
+                    IIR_MD_process_block( filter, frames, outputs, n_inputs );
+                }else{
+                    IIR_MS_process_block( filter, frames, outputs, n_inputs );
+                }
+                for ( int i=0; (i < n_inputs*N_SIGNALS) && !error; i++ ){
+                    if ( outputs[i] != ref_outputs[i] ){
+                        printf( "ERROR: %s %s block output %d %f != %f\n", name, names[s], i, outputs[i], ref_outputs[i] );
+                        error = 1;
+                    }
+                }
+
+                // Planar, in place
+                const IIR_signal_t *x_planar[N_SIGNALS];
+                IIR_signal_t *y_planar[N_SIGNALS];
+                for ( int j=0; j < N_SIGNALS; j++ ){
+                    for ( int i=0; i < n_inputs; i++ ){
+                        planar[j*n_inputs + i] = frames[i*N_SIGNALS + j];
+                    }
+                    x_planar[j] = &planar[j*n_inputs];
+                    y_planar[j] = &planar[j*n_inputs];
+                }
+                IIR_MD_reset( filter );
+                if ( md ){
+                    IIR_MD_process_planar( filter, x_planar, y_planar, n_inputs );
+                }else{
+                    IIR_MS_process_planar( filter, x_planar, y_planar, n_inputs );
+                }
+                for ( int j=0; (j < N_SIGNALS) && !error; j++ ){
+                    for ( int i=0; i < n_inputs; i++ ){
+                        if ( planar[j*n_inputs + i] != ref_outputs[i*N_SIGNALS + j] ){
+                            printf( "ERROR: %s %s planar output (i=%d, signal %d)\n", name, names[s], i, j );
+                            error = 1;
+                            break;
+                        }
+                    }
+                }
+                for ( int j=0; (j < N_SIGNALS) && !error; j++ ){
+                    if ( IIR_MD_get_last_output( filter )[j] != ref_outputs[(n_inputs-1)*N_SIGNALS + j] ){
+                        printf( "ERROR: %s %s last output (signal %d)\n", name, names[s], j );
+                        error = 1;
+                    }
+                }
+
+                IIR_MD_destroy( filter );
+            }
+        }
+
+        // Only the signal major layout supports other structures
+        IIR_MS_t *coef_major = IIR_MS_create_layout( n_coefs, N_SIGNALS, b_coefs, a_coefs, IIR_M_LAYOUT_COEF_MAJOR );
+        if ( IIR_MS_set_structure( coef_major, IIR_STRUCTURE_DF1 ) ){
+            printf( "ERROR: DF1 structure accepted by a coefficient major filter\n" );
+            error = 1;
+        }
+        IIR_MS_destroy( coef_major );
+
+        free( all_a );
+        free( all_b );
+        free( frames );
+        free( ref_outputs );
+        free( outputs );
+        free( planar );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_MS/IIR_MD: filter structures outputs do not match the S filter ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MS/IIR_MD: filter structures outputs match the S filter ones\n" );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 4:20 AM
+ */
+
+// Checks IIR_MG filters (grouped coefs) against IIR_MD filters with the same
+// coefs for each signal, bit by bit: the deduplication of the coef sets,
+// frame by frame and block (in place) filtering, and signals changing their
+// group while filtering (they must keep their state).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 150
+#define N_SETS 5
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *ref_y = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *block = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + k] = inputs[i] + noise;
+            }
+        }
+
+        for ( int shuffled=0; (shuffled < 2) && !error; shuffled++ ){
+            // N_SETS different sets of coefs, shuffled across the signals or
+            // one after the other (the signals of each group are in order)
+            IIR_signal_t *a_table = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SIGNALS );
+            IIR_signal_t *b_table = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_coefs * N_SIGNALS );
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                int set = shuffled ? (k*7) % N_SETS : k * N_SETS / N_SIGNALS;
+                for ( int c=0; c < n_coefs; c++ ){
+                    a_table[k*n_coefs + c] = a_coefs[c];
+                    b_table[k*n_coefs + c] = b_coefs[c] + ((c%2) ? COEF_STEP_RANGE * set : 0);
+                }
+            }
+
+            IIR_MG_t *filter = IIR_MG_create_table( n_coefs, N_SIGNALS, b_table, a_table );
+            IIR_MD_t *ref_filter = IIR_MD_create_bank( n_coefs, N_SIGNALS, b_table, a_table );
+
+            if ( filter->n_groups != N_SETS ){
+                printf( "ERROR: IIR_MG: %d groups for %d different coef sets\n", filter->n_groups, N_SETS );
+                error = 1;
+            }
+            for ( int k=0; (k < N_SIGNALS) && !error; k++ ){
+                for ( int c=0; c < n_coefs; c++ ){
+                    if ( (IIR_MG_COEFS_A_INDEX( filter, c, k ) != IIR_MD_COEFS_A_INDEX( ref_filter, c, k ))
+                            || (IIR_MG_COEFS_B_INDEX( filter, c, k ) != IIR_MD_COEFS_B_INDEX( ref_filter, c, k )) ){
+                        printf( "ERROR: IIR_MG coefs (coef %d, signal %d) differ\n", c, k );
+                        error = 1;
+                        break;
+                    }
+                }
+            }
+
+            // The first inputs in one block, then frame by frame up to the
+            // half of the inputs. Half way, some signals change their coefs
+            // (to another set or to new ones)
+            int first = n_inputs / 8;
+            int half = n_inputs / 2;
+            IIR_MD_process_block( ref_filter, frames, ref_y, first );
+            IIR_MG_process_block( filter, frames, block, first );
+            if ( filter->_in_order == shuffled ){
+                printf( "ERROR: IIR_MG: wrong signals order (shuffled %d)\n", shuffled );
+                error = 1;
+            }
+            for ( int i=0; (i < first*N_SIGNALS) && !error; i++ ){
+                if ( block[i] != ref_y[i] ){
+                    printf( "ERROR: IIR_MG first block output (i=%d, signal %d) %f != %f\n", i / N_SIGNALS, i % N_SIGNALS, block[i], ref_y[i] );
+                    error = 1;
+                }
+            }
+            IIR_signal_t y[N_SIGNALS];
+            for ( int i=first; (i < half) && !error; i++ ){
+                if ( i == half / 2 ){
+                    IIR_signal_t b_new[n_coefs];
+                    for ( int c=0; c < n_coefs; c++ ){
+                        b_new[c] = b_coefs[c] * 0.5;
+                    }
+                    for ( int k=0; k < N_SIGNALS; k += 11 ){
+                        const IIR_signal_t *b_k = (k % 2) ? b_new : &b_table[((k+1) % N_SIGNALS)*n_coefs];
+                        IIR_MG_set_coefs_one_signal( filter, n_coefs, b_k, a_coefs, k );
+                        IIR_MD_set_coefs_one_signal( ref_filter, n_coefs, b_k, a_coefs, k );
+                    }
+                    if ( filter->n_groups != N_SETS + 1 ){
+                        printf( "ERROR: IIR_MG: %d groups after changing coefs\n", filter->n_groups );
+                        error = 1;
+                    }
+                }
+                IIR_MG_add_input_to( filter, &frames[i*N_SIGNALS], y );
+                IIR_signal_t *ref = IIR_MD_add_input( ref_filter, &frames[i*N_SIGNALS] );
+                for ( int k=0; k < N_SIGNALS; k++ ){
+                    if ( y[k] != ref[k] ){
+                        printf( "ERROR: IIR_MG output (i=%d, signal %d) %f != %f\n", i, k, y[k], ref[k] );
+                        error = 1;
+                        break;
+                    }
+                }
+            }
+
+            // The rest of the inputs in one block, in place
+            IIR_MD_process_block( ref_filter, &frames[half*N_SIGNALS], &ref_y[half*N_SIGNALS], n_inputs - half );
+            memcpy( block, frames, sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+            IIR_MG_process_block( filter, &block[half*N_SIGNALS], &block[half*N_SIGNALS], n_inputs - half );
+            for ( int i=half*N_SIGNALS; (i < n_inputs*N_SIGNALS) && !error; i++ ){
+                if ( block[i] != ref_y[i] ){
+                    printf( "ERROR: IIR_MG block output (i=%d, signal %d) %f != %f\n", i / N_SIGNALS, i % N_SIGNALS, block[i], ref_y[i] );
+                    error = 1;
+                }
+            }
+            for ( int k=0; (k < N_SIGNALS) && !error; k++ ){
+                if ( IIR_MG_get_last_output( filter )[k] != IIR_MD_get_last_output( ref_filter )[k] ){
+                    printf( "ERROR: IIR_MG last output (signal %d)\n", k );
+                    error = 1;
+                }
+            }
+
+            // Back to one group
+            IIR_MG_set_coefs_all_signals( filter, n_coefs, b_coefs, a_coefs );
+            if ( filter->n_groups != 1 ){
+                printf( "ERROR: IIR_MG: %d groups after setting the coefs of all the signals\n", filter->n_groups );
+                error = 1;
+            }
+
+            IIR_MG_destroy( filter );
+            IIR_MD_destroy( ref_filter );
+            free( a_table );
+            free( b_table );
+        }
+
+        free( frames );
+        free( ref_y );
+        free( block );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_MG: outputs do not match the IIR_MD ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MG: outputs match the IIR_MD ones\n" );
+    return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include <time.h>
 
 #include "IIR_filters.h"
+#include "load_test_reference_file.h"
 
 #define STR_VALUE2(arg) #arg
 #define STR_VALUE(name) STR_VALUE2(name)
@@ -33,6 +34,7 @@
 
 #define DEFAULT_CYCLES 2000000
 #define DEFAULT_SIGNALS 300
+#define BLOCK_FRAMES 256
 
 int main(int argc, char** argv) {
     
@@ -89,6 +91,71 @@ int main(int argc, char** argv) {
         printf( "\n" );
     }
     
+    // Same number of inputs, but processed in blocks of BLOCK_FRAMES frames
+    IIR_signal_t *block_input = (IIR_signal_t*) malloc( BLOCK_FRAMES * n_signals * sizeof(IIR_signal_t) );
+    IIR_signal_t *block_output = (IIR_signal_t*) malloc( BLOCK_FRAMES * n_signals * sizeof(IIR_signal_t) );
+    for ( int i=0; i<BLOCK_FRAMES*n_signals; i++ ){
+        block_input[i] = 1.5;
+    }
+    IIR_MS_reset( filter );
+
+    clock_t c3 = clock();
+
+    for ( long int i=0; i<n_cycles; i+=BLOCK_FRAMES ){
+        int n = (n_cycles-i < BLOCK_FRAMES) ? (int)(n_cycles-i) : BLOCK_FRAMES;
+        IIR_MS_process_block(filter, block_input, block_output, n);
+    }
+
+    clock_t c4 = clock();
+
+    // Same frame by frame test with the coefficient major layout
+    IIR_MS_t *cm_filter = IIR_MS_create_layout( n_coefs, n_signals, b, a, IIR_M_LAYOUT_COEF_MAJOR );
+
+    clock_t c5 = clock();
+
+    for ( int i=0; i<n_cycles; i++ ){
+        IIR_MS_add_input(cm_filter, input);
+    }
+
+    clock_t c6 = clock();
+
+    // Low order filters (Butterworth, order 1 to 4): IIR_MS_add_input
+    // (unrolled kernels) and the generic loop (_IIR_step_tdf2) on each signal
+    double low_times[TEST_LOW_ORDERS], generic_times[TEST_LOW_ORDERS];
+    for ( int o=0; o<TEST_LOW_ORDERS; o++ ){
+        int low_n_coefs = o+2;
+        IIR_MS_t *low_filter = IIR_MS_create( low_n_coefs, n_signals, test_low_order_b[o], test_low_order_a[o] );
+
+        clock_t cl1 = clock();
+
+        for ( int i=0; i<n_cycles; i++ ){
+            IIR_MS_add_input(low_filter, input);
+        }
+
+        clock_t cl2 = clock();
+
+        IIR_MS_reset( low_filter );
+
+        clock_t cl3 = clock();
+
+        for ( int i=0; i<n_cycles; i++ ){
+            for ( int k=0; k<n_signals; k++ ){
+                low_filter->last_output[k] = _IIR_step_tdf2(low_n_coefs, low_filter->a, low_filter->b,
+                                                            low_filter->z + k*low_n_coefs, input[k]);
+            }
+        }
+
+        clock_t cl4 = clock();
+
+        low_times[o] = (double)(cl2-cl1)/CLOCKS_PER_SEC;
+        generic_times[o] = (double)(cl4-cl3)/CLOCKS_PER_SEC;
+        IIR_MS_destroy( low_filter );
+    }
+
+    int cm_simd_level = cm_filter->simd_level;
+    IIR_MS_destroy( cm_filter );
+    free( block_input );
+    free( block_output );
     IIR_MS_destroy( filter );
     
     printf( "Filter correctly destroyed\n" );
@@ -103,6 +170,17 @@ int main(int argc, char** argv) {
     printf( "Test results:\n\tTotal time: %.4lf sec\n", time );
     printf( "\tTime to add one input (%d signals): %.4lf usec\n", n_signals, time/n_cycles*1e6 );
     printf( "\tTime to add one input for one signal: %.4lf usec\n", n_signals, time/(n_cycles*n_signals)*1e6 );
+    double block_time = (double)(c4-c3)/CLOCKS_PER_SEC;
+    printf( "\tTotal time (blocks of %d frames): %.4lf sec\n", BLOCK_FRAMES, block_time );
+    printf( "\tTime to add one input (%d signals, blocks of %d frames): %.4lf usec\n", n_signals, BLOCK_FRAMES, block_time/n_cycles*1e6 );
+    double cm_time = (double)(c6-c5)/CLOCKS_PER_SEC;
+    printf( "\tTotal time (coefficient major layout, SIMD level %d): %.4lf sec\n", cm_simd_level, cm_time );
+    printf( "\tTime to add one input (%d signals, coefficient major layout): %.4lf usec\n", n_signals, cm_time/n_cycles*1e6 );
+    for ( int o=0; o<TEST_LOW_ORDERS; o++ ){
+        printf( "\tTime to add one input (%d signals, n_coefs %d): %.4lf usec (generic loop: %.4lf usec, speedup %.2lfx)\n",
+                n_signals, o+2, low_times[o]/n_cycles*1e6, generic_times[o]/n_cycles*1e6,
+                generic_times[o]/low_times[o] );
+    }
         
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 5:45 AM
+ */
+
+// Checks IIR_MV filters (a different order for each signal) against one
+// IIR_S filter for each signal, bit by bit, frame by frame and in blocks
+// (in place and with more frames than IIR_MV_BLOCK_FRAMES).
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 120
+#define SIGNAL_NOISE_RANGE 40
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // The test file filter for the first third of the signals (one
+        // after the other), and order 1 and 2 filters mixed across the rest
+        IIR_signal_t b_1[] = { 0.2, 0.2 };
+        IIR_signal_t a_1[] = { 2.0, -1.2 };
+        IIR_signal_t b_2[] = { 0.1, 0.2, 0.1 };
+        IIR_signal_t a_2[] = { 1.0, -0.9, 0.3 };
+        int n_coefs[N_SIGNALS];
+        const IIR_signal_t *b_coefs[N_SIGNALS];
+        const IIR_signal_t *a_coefs[N_SIGNALS];
+        IIR_S_t *ref_filters[N_SIGNALS];
+        for ( int k=0; k < N_SIGNALS; k++ ){
+            if ( k < N_SIGNALS / 3 ){
+                n_coefs[k] = loaded_data->n_coefs; b_coefs[k] = loaded_data->b_coefs; a_coefs[k] = loaded_data->a_coefs;
+            }else if ( k % 2 ){
+                n_coefs[k] = 2; b_coefs[k] = b_1; a_coefs[k] = a_1;
+            }else{
+                n_coefs[k] = 3; b_coefs[k] = b_2; a_coefs[k] = a_2;
+            }
+            ref_filters[k] = IIR_S_create( n_coefs[k], b_coefs[k], a_coefs[k] );
+        }
+
+        IIR_MV_t *filter = IIR_MV_create( N_SIGNALS, n_coefs, b_coefs, a_coefs );
+        if ( !filter || (filter->n_buckets != ((loaded_data->n_coefs > 3) ? 3 : 2)) ){
+            printf( "ERROR: IIR_MV: wrong buckets\n" );
+            return EXIT_FAILURE;
+        }
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + k] = inputs[i] + noise;
+            }
+        }
+
+        // First half frame by frame, second half in one block in place
+        int half = n_inputs / 2;
+        for ( int i=0; (i < half) && !error; i++ ){
+            IIR_signal_t *y = IIR_MV_add_input( filter, &frames[i*N_SIGNALS] );
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                IIR_signal_t ref = IIR_S_add_input( ref_filters[k], frames[i*N_SIGNALS + k] );
+                if ( y[k] != ref ){
+                    printf( "ERROR: IIR_MV output (i=%d, signal %d) %f != %f\n", i, k, y[k], ref );
+                    error = 1;
+                    break;
+                }
+            }
+        }
+
+        IIR_signal_t *block = &frames[half*N_SIGNALS];
+        int n_block = n_inputs - half;
+        IIR_signal_t *ref_block = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_block * N_SIGNALS );
+        for ( int i=0; i < n_block; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                ref_block[i*N_SIGNALS + k] = IIR_S_add_input( ref_filters[k], block[i*N_SIGNALS + k] );
+            }
+        }
+        IIR_MV_process_block( filter, block, block, n_block );
+        for ( int i=0; (i < n_block * N_SIGNALS) && !error; i++ ){
+            if ( block[i] != ref_block[i] ){
+                printf( "ERROR: IIR_MV block output (i=%d, signal %d) %f != %f\n", half + i / N_SIGNALS, i % N_SIGNALS, block[i], ref_block[i] );
+                error = 1;
+            }
+        }
+
+        // Not valid: not enough coefs for one of the signals
+        n_coefs[N_SIGNALS/2] = 1;
+        if ( IIR_MV_create( N_SIGNALS, n_coefs, b_coefs, a_coefs ) ){
+            printf( "ERROR: IIR_MV_create accepted a signal with 1 coefficient\n" );
+            error = 1;
+        }
+
+        IIR_MV_destroy( filter );
+        for ( int k=0; k < N_SIGNALS; k++ ){
+            IIR_S_destroy( ref_filters[k] );
+        }
+        free( frames );
+        free( ref_block );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_MV: outputs do not match the IIR_S ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_MV: outputs match the IIR_S ones\n" );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 7:30 PM
+ */
+
+// Checks the SOS MS and MD filters with every kernel level supported by this
+// CPU against the scalar kernel (bit by bit, unless IIR_USE_FMA is defined),
+// and the planar and strided processing against the interleaved one.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Not a multiple of any vector width and more than one chunk of signals
+#define N_SIGNALS 150
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+// Order 10 filters
+#define N_SECTIONS 5
+
+// Sections (b0, b1, b2, a0, a1, a2)
+static const IIR_signal_t sos[N_SECTIONS*IIR_SOS_INPUT_COEFS] = {
+    0.0200833656, 0.0401667312, 0.0200833656, 1.0, -1.5610180758, 0.6413515381,
+    0.0346, 0.0692, 0.0346, 1.0, -1.3000, 0.4384,
+    1.0, 2.0, 1.0, 1.0, -1.1, 0.71,
+    1.0, -2.0, 1.0, 1.0, -0.2, 0.3,
+    0.5, -0.3, 0.2, 2.0, -0.9, 0.5
+};
+
+// Filter all the frames with the kernel of the given level, as one
+// interleaved block. Returns 1 if done, 0 if the level is not supported and
+// -1 on error
+static int filter_with_level(IIR_SOS_M_t *filter, int level,
+                             const IIR_signal_t *frames, IIR_signal_t *outputs, int n_frames){
+
+    int supported = filter->_different_coefs ? IIR_SOS_MD_set_simd_level( filter, level )
+                                             : IIR_SOS_MS_set_simd_level( filter, level );
+    if ( supported != (level <= IIR_simd_cpu_level()) ){
+        printf( "ERROR: level %d support (%d) does not match the CPU level %d\n", level, supported, IIR_simd_cpu_level() );
+        return -1;
+    }
+    if ( supported ){
+        IIR_SOS_MD_reset( filter );
+        IIR_SOS_MD_process_block( filter, frames, outputs, n_frames );
+    }
+
+    return supported;
+}
+
+static int compare(const IIR_signal_t *ref, const IIR_signal_t *out, int n, const char *what){
+    for ( int i=0; i < n; i++ ){
+        if ( ref[i] != out[i] ){
+            printf( "ERROR: %s output %d %f != %f\n", what, i, ref[i], out[i] );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+        size_t block_bytes = sizeof(IIR_signal_t) * n_inputs * N_SIGNALS;
+
+        // N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( block_bytes );
+        IIR_signal_t *ref_outputs = (IIR_signal_t*) malloc( block_bytes );
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( block_bytes );
+        IIR_signal_t *planar = (IIR_signal_t*) malloc( block_bytes );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + j] = inputs[i] + noise;
+            }
+        }
+
+        // Slightly different sections for each signal
+        IIR_signal_t *all_sos = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * N_SIGNALS * N_SECTIONS * IIR_SOS_INPUT_COEFS );
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            IIR_signal_t *sos_j = &all_sos[j*N_SECTIONS*IIR_SOS_INPUT_COEFS];
+            memcpy( sos_j, sos, sizeof(sos) );
+            for ( int s=0; s < N_SECTIONS; s++ ){
+                sos_j[s*IIR_SOS_INPUT_COEFS + 1] += COEF_STEP_RANGE * (j%7);
+                sos_j[s*IIR_SOS_INPUT_COEFS + 4] -= COEF_STEP_RANGE * (j%5);
+            }
+        }
+
+        IIR_SOS_M_t *filters[2];
+        filters[0] = IIR_SOS_MS_create( N_SECTIONS, N_SIGNALS, sos );
+        filters[1] = IIR_SOS_MD_create_bank( N_SECTIONS, N_SIGNALS, all_sos );
+        if ( !filters[0] || !filters[1] ){
+            printf( "ERROR: unable to create the filters\n" );
+            return EXIT_FAILURE;
+        }
+
+        for ( int f=0; (f < 2) && !error; f++ ){
+            const char *name = f ? "IIR_SOS_MD" : "IIR_SOS_MS";
+
+            // Every level against the scalar kernel
+            if ( filter_with_level( filters[f], IIR_SIMD_LEVEL_SCALAR, frames, ref_outputs, n_inputs ) != 1 ){
+                error = 1;
+            }
+            for ( int level=IIR_SIMD_LEVEL_SSE2; (level <= IIR_SIMD_LEVEL_AVX512) && !error; level++ ){
+                int result = filter_with_level( filters[f], level, frames, outputs, n_inputs );
+                if ( result < 0 ){
+                    error = 1;
+                }
+#ifndef IIR_USE_FMA
+                if ( result == 1 ){
+                    printf( "%s: checking level %d\n", name, level );
+                    error = compare( ref_outputs, outputs, n_inputs * N_SIGNALS, name );
+                }
+#endif
+            }
+
+            // Planar buffers (one per signal) with the best kernel
+            filter_with_level( filters[f], IIR_simd_cpu_level(), frames, ref_outputs, n_inputs );
+            const IIR_signal_t *x_planar[N_SIGNALS];
+            IIR_signal_t *y_planar[N_SIGNALS];
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                for ( int i=0; i < n_inputs; i++ ){
+                    planar[j*n_inputs + i] = frames[i*N_SIGNALS + j];
+                }
+                x_planar[j] = &planar[j*n_inputs];
+                y_planar[j] = &planar[j*n_inputs];
+            }
+            IIR_SOS_MD_reset( filters[f] );
+            if ( !error && !IIR_SOS_MD_process_planar( filters[f], x_planar, y_planar, n_inputs ) ){
+                printf( "ERROR: %s planar processing failed\n", name );
+                error = 1;
+            }
+            for ( int j=0; (j < N_SIGNALS) && !error; j++ ){
+                for ( int i=0; i < n_inputs; i++ ){
+                    outputs[i*N_SIGNALS + j] = planar[j*n_inputs + i];
+                }
+            }
+            error = error || compare( ref_outputs, outputs, n_inputs * N_SIGNALS, "planar" );
+            error = error || compare( &ref_outputs[(n_inputs-1)*N_SIGNALS],
+                                      IIR_SOS_MD_get_last_output( filters[f] ), N_SIGNALS, "planar last output" );
+
+            // Strided input (planar in one buffer) to interleaved output
+            IIR_SOS_MD_reset( filters[f] );
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                for ( int i=0; i < n_inputs; i++ ){
+                    planar[j*n_inputs + i] = frames[i*N_SIGNALS + j];
+                }
+            }
+            if ( !error && !IIR_SOS_MD_process_strided( filters[f], planar, 1, n_inputs,
+                                                         outputs, N_SIGNALS, 1, n_inputs ) ){
+                printf( "ERROR: %s strided processing failed\n", name );
+                error = 1;
+            }
+            error = error || compare( ref_outputs, outputs, n_inputs * N_SIGNALS, "strided" );
+        }
+
+        IIR_SOS_MS_destroy( filters[0] );
+        IIR_SOS_MD_destroy( filters[1] );
+        free( all_sos );
+        free( frames );
+        free( ref_outputs );
+        free( outputs );
+        free( planar );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_SOS_MS/IIR_SOS_MD: vectorized kernels outputs do not match the scalar ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_SOS_MS/IIR_SOS_MD: vectorized kernels outputs match the scalar ones\n" );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 5:10 PM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Not a multiple of the SIMD width and more than one chunk of signals
+#define N_SIGNALS 150
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+#define N_SECTIONS 3
+// Odd block size so the last block is a partial one
+#define BLOCK_SIZE 37
+
+// Sections (b0, b1, b2, a0, a1, a2)
+static const IIR_signal_t sos[N_SECTIONS*IIR_SOS_INPUT_COEFS] = {
+    0.0200833656, 0.0401667312, 0.0200833656, 1.0, -1.5610180758, 0.6413515381,
+    0.0346, 0.0692, 0.0346, 1.0, -1.3000, 0.4384,
+    0.5, -0.3, 0.2, 2.0, -0.9, 0.5
+};
+
+// Filter frames (n_frames*N_SIGNALS values) with one IIR_SOS_t per signal
+// and compare with the outputs of the multi signal filter
+static int compare_with_SOS(IIR_SOS_t **filters, const IIR_signal_t *frames,
+                            const IIR_signal_t *outputs, int n_frames, const char *what){
+    for ( int i=0; i < n_frames; i++ ){
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            IIR_signal_t y = IIR_SOS_add_input( filters[j], frames[i*N_SIGNALS + j] );
+            if ( y != outputs[i*N_SIGNALS + j] ){
+                printf( "ERROR: %s (i=%d, j=%d) %f != %f\n", what, i, j, y, outputs[i*N_SIGNALS + j] );
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // Build N_SIGNALS noisy versions of the input, stored frame by frame
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                frames[i*N_SIGNALS + j] = inputs[i] + noise;
+            }
+        }
+
+        // Slightly different sections for each signal
+        IIR_signal_t *all_sos = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * N_SIGNALS * N_SECTIONS * IIR_SOS_INPUT_COEFS );
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            IIR_signal_t *sos_j = &all_sos[j*N_SECTIONS*IIR_SOS_INPUT_COEFS];
+            memcpy( sos_j, sos, sizeof(sos) );
+            for ( int s=0; s < N_SECTIONS; s++ ){
+                sos_j[s*IIR_SOS_INPUT_COEFS + 1] += COEF_STEP_RANGE * (j%7);
+                sos_j[s*IIR_SOS_INPUT_COEFS + 4] -= COEF_STEP_RANGE * (j%5);
+            }
+        }
+
+        IIR_SOS_MS_t *MS_filter = IIR_SOS_MS_create( N_SECTIONS, N_SIGNALS, sos );
+        IIR_SOS_MD_t *MD_filter = IIR_SOS_MD_create_bank( N_SECTIONS, N_SIGNALS, all_sos );
+        IIR_SOS_t *MS_refs[N_SIGNALS], *MD_refs[N_SIGNALS];
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            MS_refs[j] = IIR_SOS_create( N_SECTIONS, sos );
+            MD_refs[j] = IIR_SOS_create( N_SECTIONS, &all_sos[j*N_SECTIONS*IIR_SOS_INPUT_COEFS] );
+        }
+        if ( !MS_filter || !MD_filter ){
+            printf( "ERROR: unable to create the filters\n" );
+            return EXIT_FAILURE;
+        }
+
+        // Frame by frame (first half) and blocks in place (second half)
+        int half = n_inputs/2;
+        for ( int i=0; i < half; i++ ){
+            memcpy( &outputs[i*N_SIGNALS], IIR_SOS_MS_add_input( MS_filter, &frames[i*N_SIGNALS] ),
+                    sizeof(IIR_signal_t) * N_SIGNALS );
+        }
+        memcpy( &outputs[half*N_SIGNALS], &frames[half*N_SIGNALS], sizeof(IIR_signal_t) * (n_inputs-half) * N_SIGNALS );
+        for ( int i=half; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_SOS_MS_process_in_place( MS_filter, &outputs[i*N_SIGNALS], n );
+        }
+        error = compare_with_SOS( MS_refs, frames, outputs, n_inputs, "MS" );
+        if ( !error && memcmp( IIR_SOS_MS_get_last_output(MS_filter), &outputs[(n_inputs-1)*N_SIGNALS],
+                              sizeof(IIR_signal_t) * N_SIGNALS ) ){
+            printf( "ERROR: MS last output does not match\n" );
+            error = 1;
+        }
+
+        // Same for the MD filter, with blocks out of place
+        for ( int i=0; i < half; i++ ){
+            memcpy( &outputs[i*N_SIGNALS], IIR_SOS_MD_add_input( MD_filter, &frames[i*N_SIGNALS] ),
+                    sizeof(IIR_signal_t) * N_SIGNALS );
+        }
+        for ( int i=half; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_SOS_MD_process_block( MD_filter, &frames[i*N_SIGNALS], &outputs[i*N_SIGNALS], n );
+        }
+        if ( !error ){
+            error = compare_with_SOS( MD_refs, frames, outputs, n_inputs, "MD" );
+        }
+
+        // Reset and set the sections of one signal
+        IIR_SOS_MD_reset( MD_filter );
+        IIR_SOS_reset( MD_refs[3] );
+        if ( !IIR_SOS_MD_set_sos_one_signal( MD_filter, N_SECTIONS, sos, 3 ) || !IIR_SOS_set_sos( MD_refs[3], N_SECTIONS, sos )
+                || IIR_SOS_MD_set_sos_one_signal( MD_filter, N_SECTIONS, sos, N_SIGNALS ) ){
+            printf( "ERROR: MD set sos one signal\n" );
+            error = 1;
+        }
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            IIR_SOS_reset( MD_refs[j] );
+        }
+        IIR_SOS_MD_process_block( MD_filter, frames, outputs, n_inputs );
+        if ( !error ){
+            error = compare_with_SOS( MD_refs, frames, outputs, n_inputs, "MD after reset" );
+        }
+
+        // The same sections for all the signals (IIR_SOS_MD_create and
+        // IIR_SOS_MD_set_sos_all_signals): same outputs as the MS filter
+        IIR_SOS_MD_t *shared_filter = IIR_SOS_MD_create( N_SECTIONS, N_SIGNALS, sos );
+        IIR_SOS_MD_reset( MD_filter );
+        if ( !shared_filter || !IIR_SOS_MD_set_sos_all_signals( MD_filter, N_SECTIONS, sos ) ){
+            printf( "ERROR: MD with the same sections for all the signals\n" );
+            return EXIT_FAILURE;
+        }
+        for ( int md=0; (md < 2) && !error; md++ ){
+            for ( int j=0; j < N_SIGNALS; j++ ){
+                IIR_SOS_reset( MS_refs[j] );
+            }
+            IIR_SOS_MD_process_block( md ? MD_filter : shared_filter, frames, outputs, n_inputs );
+            error = compare_with_SOS( MS_refs, frames, outputs, n_inputs, md ? "MD set_sos_all_signals" : "MD create" );
+        }
+        IIR_SOS_MD_destroy( shared_filter );
+
+        for ( int j=0; j < N_SIGNALS; j++ ){
+            IIR_SOS_destroy( MS_refs[j] );
+            IIR_SOS_destroy( MD_refs[j] );
+        }
+        IIR_SOS_MS_destroy( MS_filter );
+        IIR_SOS_MD_destroy( MD_filter );
+        free( frames );
+        free( outputs );
+        free( all_sos );
+        
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_SOS_MS/MD: outputs do not match the IIR_SOS filters\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_SOS_MS/MD: outputs match the IIR_SOS filters\n" );
+    return EXIT_SUCCESS;
+}
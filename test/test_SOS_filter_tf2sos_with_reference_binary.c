@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 6:20 PM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define MAX_COEFS 16
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+// Multiply the sections back to a transfer function (n_sections*2+1 coefs)
+static void sos_to_tf(int n_sections, const IIR_signal_t *sos, double *b, double *a){
+    b[0] = a[0] = 1.0;
+    for ( int n=0; n < n_sections; n++ ){
+        const IIR_signal_t *row = &sos[n*IIR_SOS_INPUT_COEFS];
+        int deg = 2*n;
+        b[deg+1] = b[deg+2] = a[deg+1] = a[deg+2] = 0;
+        for ( int i=deg; i >= 0; i-- ){
+            b[i+2] += b[i] * row[2];
+            b[i+1] += b[i] * row[1];
+            b[i] *= row[0];
+            a[i+2] += a[i] * row[5];
+            a[i+1] += a[i] * row[4];
+            a[i] *= row[3];
+        }
+    }
+}
+
+// Check that the sections multiply back to the transfer function (the
+// coefs are compared relative to the biggest one)
+static int check_tf(int n_coefs, const IIR_signal_t *b_coefs, const IIR_signal_t *a_coefs,
+                    int n_sections, const IIR_signal_t *sos){
+    double b[MAX_COEFS+2], a[MAX_COEFS+2];
+    double max_b = 0, max_a = 0, err_b = 0, err_a = 0;
+
+    sos_to_tf( n_sections, sos, b, a );
+    for ( int i=0; i < 2*n_sections+1; i++ ){
+        double bi = (i < n_coefs) ? b_coefs[i] / (double)a_coefs[0] : 0;
+        double ai = (i < n_coefs) ? a_coefs[i] / (double)a_coefs[0] : 0;
+        max_b = MAX( max_b, fabs(bi) );
+        max_a = MAX( max_a, fabs(ai) );
+        err_b = MAX( err_b, fabs(b[i] - bi) );
+        err_a = MAX( err_a, fabs(a[i] - ai) );
+    }
+    printf( "Coefs error: b %g, a %g (relative)\n", err_b/max_b, err_a/max_a );
+    if ( (err_b > TEST_TOLERANCE * max_b) || (err_a > TEST_TOLERANCE * max_a) ){
+        printf( "ERROR: the sections do not multiply back to the transfer function\n" );
+        return 1;
+    }
+    return 0;
+}
+
+// Filter the inputs with the SOS filter and compare with the given outputs,
+// relative to the biggest output
+static int check_outputs(IIR_SOS_t *filter, const IIR_signal_t *inputs, const IIR_signal_t *ref, int n){
+    double max_output = 1.0, max_error = 0;
+    for ( int i=0; i < n; i++ ){
+        IIR_signal_t y = IIR_SOS_add_input( filter, inputs[i] );
+        max_output = MAX( max_output, fabs(ref[i]) );
+        max_error = MAX( max_error, fabs( (double)y - (double)ref[i] ) );
+    }
+    printf( "Outputs error: %g (relative %g)\n", max_error, max_error/max_output );
+    if ( max_error > TEST_TOLERANCE * max_output ){
+        printf( "ERROR: SOS outputs differ from the reference\n" );
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    IIR_signal_t sos[IIR_SOS_N_SECTIONS(MAX_COEFS) * IIR_SOS_INPUT_COEFS];
+
+    test_data_t *loaded_data = load_filter_test_data_fields_binary( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+        IIR_signal_t *correct_outputs = loaded_data->correct_outputs;
+
+        // Reference filter
+        int n_sections = IIR_tf2sos( n_coefs, b_coefs, a_coefs, sos );
+        if ( (n_coefs > MAX_COEFS) || (n_sections != IIR_SOS_N_SECTIONS(n_coefs)) ){
+            printf( "ERROR: wrong number of sections %d\n", n_sections );
+            return EXIT_FAILURE;
+        }
+        error = check_tf( n_coefs, b_coefs, a_coefs, n_sections, sos );
+
+        // Poles closest to the unit circle last (complex pairs: |p|^2 == a2)
+        for ( int n=1; (n < n_sections) && !error; n++ ){
+            if ( sos[n*IIR_SOS_INPUT_COEFS + 5] < sos[(n-1)*IIR_SOS_INPUT_COEFS + 5] ){
+                printf( "ERROR: sections not ordered by pole radius\n" );
+                error = 1;
+            }
+        }
+
+        IIR_SOS_t *filter = IIR_SOS_create_from_tf( n_coefs, b_coefs, a_coefs );
+        if ( !filter || (filter->n_sections != n_sections) ){
+            printf( "ERROR: unable to create the SOS filter\n" );
+            return EXIT_FAILURE;
+        }
+        if ( !error ){
+            error = check_outputs( filter, inputs, correct_outputs, n_inputs );
+        }
+        IIR_SOS_destroy( filter );
+
+        // Odd order with a delay (b[0] == 0): poles 0.5 and 0.8*exp(+-0.3j),
+        // compared with the transfer function filter
+        IIR_signal_t b_odd[4] = { 0.0, 0.5, 0.3, -0.2 };
+        IIR_signal_t a_odd[4] = { 2.0, -2.0*(0.5 + 1.6*cos(0.3)), 2.0*(0.8*cos(0.3) + 0.64), -2.0*0.32 };
+        if ( !error ){
+            n_sections = IIR_tf2sos( 4, b_odd, a_odd, sos );
+            error = (n_sections != 2) || (sos[2] != 0) || (sos[5] != 0)
+                    || check_tf( 4, b_odd, a_odd, n_sections, sos );
+            if ( error ){
+                printf( "ERROR: odd order transfer function\n" );
+            }
+        }
+        if ( !error ){
+            IIR_S_t *S_filter = IIR_S_create( 4, b_odd, a_odd );
+            IIR_signal_t *S_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+            IIR_S_process_block( S_filter, inputs, S_outputs, n_inputs );
+            filter = IIR_SOS_create( n_sections, sos );
+            error = check_outputs( filter, inputs, S_outputs, n_inputs );
+            IIR_SOS_destroy( filter );
+            IIR_S_destroy( S_filter );
+            free( S_outputs );
+        }
+
+        // All poles at 0 (FIR) and a double zero at -1
+        IIR_signal_t b_fir[3] = { 0.25, 0.5, 0.25 };
+        IIR_signal_t a_fir[3] = { 1.0, 0.0, 0.0 };
+        if ( !error ){
+            n_sections = IIR_tf2sos( 3, b_fir, a_fir, sos );
+            error = (n_sections != 1) || (sos[4] != 0) || (sos[5] != 0)
+                    || check_tf( 3, b_fir, a_fir, n_sections, sos );
+            if ( error ){
+                printf( "ERROR: FIR transfer function\n" );
+            }
+        }
+
+        // Wrong parameters
+        a_fir[0] = 0;
+        if ( IIR_tf2sos( 3, b_fir, a_fir, sos ) || IIR_tf2sos( 1, b_fir, a_fir, sos ) ){
+            printf( "ERROR: wrong parameters accepted\n" );
+            error = 1;
+        }
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_SOS: tf2sos filter outputs do not match the reference\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_SOS: tf2sos filter outputs match the reference within a tolerance of "
+            TEST_TOLERANCE_DIGITS_STR " digits\n" );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 4:40 PM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SECTIONS 3
+// Odd block size so the last block is a partial one
+#define BLOCK_SIZE 37
+
+// Sections (b0, b1, b2, a0, a1, a2): two low pass resonators and a not
+// normalized one (a0 != 1)
+static const IIR_signal_t sos[N_SECTIONS*IIR_SOS_INPUT_COEFS] = {
+    0.0200833656, 0.0401667312, 0.0200833656, 1.0, -1.5610180758, 0.6413515381,
+    0.0346, 0.0692, 0.0346, 1.0, -1.3000, 0.4384,
+    0.5, -0.3, 0.2, 2.0, -0.9, 0.5
+};
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // One order 2 IIR_S filter per section, chained
+        IIR_S_t *S_filters[N_SECTIONS];
+        for ( int s=0; s < N_SECTIONS; s++ ){
+            const IIR_signal_t *sec = &sos[s*IIR_SOS_INPUT_COEFS];
+            S_filters[s] = IIR_S_create( 3, sec, sec + 3 );
+        }
+        IIR_SOS_t *filter = IIR_SOS_create( N_SECTIONS, sos );
+        if ( !filter ){
+            printf( "ERROR: unable to create the SOS filter\n" );
+            return EXIT_FAILURE;
+        }
+
+        IIR_signal_t *ref_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+        for ( int i=0; i < n_inputs; i++ ){
+            IIR_signal_t y = inputs[i];
+            for ( int s=0; s < N_SECTIONS; s++ ){
+                y = IIR_S_add_input( S_filters[s], y );
+            }
+            ref_outputs[i] = y;
+        }
+
+        // Sample by sample
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            IIR_signal_t y = IIR_SOS_add_input( filter, inputs[i] );
+            if ( (y != ref_outputs[i]) || (y != IIR_SOS_get_last_output(filter)) ){
+                printf( "ERROR: add_input (i=%d) %f != %f\n", i, y, ref_outputs[i] );
+                error = 1;
+            }
+        }
+
+        // Blocks (in place), after a reset
+        IIR_SOS_reset( filter );
+        memcpy( outputs, inputs, sizeof(IIR_signal_t) * n_inputs );
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_SOS_process_in_place( filter, &outputs[i], n );
+        }
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            if ( outputs[i] != ref_outputs[i] ){
+                printf( "ERROR: block (i=%d) %f != %f\n", i, outputs[i], ref_outputs[i] );
+                error = 1;
+            }
+        }
+        if ( !error && (IIR_SOS_get_last_output(filter) != ref_outputs[n_inputs-1]) ){
+            printf( "ERROR: last output does not match\n" );
+            error = 1;
+        }
+
+        // Wrong parameters
+        IIR_signal_t bad_sos[IIR_SOS_INPUT_COEFS] = { 1.0, 0.0, 0.0, 0.0, 0.5, 0.2 };
+        if ( IIR_SOS_create( 0, sos ) || IIR_SOS_create( 1, bad_sos )
+                || IIR_SOS_set_sos( filter, N_SECTIONS-1, sos ) ){
+            printf( "ERROR: wrong parameters accepted\n" );
+            error = 1;
+        }
+
+        for ( int s=0; s < N_SECTIONS; s++ ){
+            IIR_S_destroy( S_filters[s] );
+        }
+        IIR_SOS_destroy( filter );
+        free( ref_outputs );
+        free( outputs );
+        
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_SOS: outputs do not match the chained IIR_S filters\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_SOS: outputs match the chained IIR_S filters\n" );
+    return EXIT_SUCCESS;
+}
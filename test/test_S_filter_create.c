@@ -30,8 +30,8 @@
 
 int main(int argc, char** argv) {
     
-    IIR_signal_t a_coefs[20];
-    IIR_signal_t b_coefs[20];
+    IIR_signal_t a_coefs[20] = {1.0};
+    IIR_signal_t b_coefs[20] = {1.0};
     
     int error = EXIT_SUCCESS;
 
@@ -56,6 +56,22 @@ int main(int argc, char** argv) {
         printf( "SUCCESS: IIR_S: Filter with negative number of coefficients is invalid\n" );
     }
     
+    // One aligned block: a, b and z aligned and inside the block
+    for ( int n_coefs=2; n_coefs <= 20; n_coefs++ ){
+        IIR_S_t *filter = IIR_S_create( n_coefs, b_coefs, a_coefs );
+        char *block = (char*) filter;
+        char *end = block + _IIR_S_BLOCK_SIZE(n_coefs);
+        IIR_signal_t *arrays[3] = { filter->a, filter->b, filter->z };
+        for ( int i=0; i < 3; i++ ){
+            if ( ((size_t)arrays[i] % IIR_SIMD_ALIGNMENT) || ((char*)arrays[i] < block)
+                    || ((char*)(arrays[i] + n_coefs) > end) ){
+                error = EXIT_FAILURE;
+                printf( "ERROR: IIR_S: array %d of a %d coefficients filter not aligned or out of the filter block\n", i, n_coefs );
+            }
+        }
+        IIR_S_destroy( filter );
+    }
+
     if ( error == EXIT_SUCCESS ){
         printf( "SUCCESS: IIR_S: all tests passed\n" );
     }else{
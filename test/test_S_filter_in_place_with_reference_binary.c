@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Odd block size so the last block is a partial one
+#define BLOCK_SIZE 37
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    test_data_t *loaded_data = load_filter_test_data_fields_binary( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+        IIR_signal_t *correct_outputs = loaded_data->correct_outputs;
+
+        // The buffer holds the inputs and will be overwritten with the outputs
+        IIR_signal_t *buffer = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+        memcpy( buffer, inputs, sizeof(IIR_signal_t) * n_inputs );
+        
+        IIR_S_t *filter = IIR_S_create( n_coefs, b_coefs, a_coefs );
+
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_S_process_in_place( filter, &buffer[i], n );
+        }
+
+        IIR_S_destroy(filter);
+    
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+        // Check that values are exactly equal
+        for ( int i=0; i<n_inputs; i++ ){
+            if ( buffer[i] != correct_outputs[i] ){
+                printf( "\nERROR: Outputs are not exactly equal (bit by bit) to the reference (i=%d)\n", i );
+                return EXIT_FAILURE;
+            }
+        }
+        
+        free(buffer);
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    printf( "\nSUCCESS: IIR_S: in-place outputs match the reference bit by bit\n" );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 12:20 AM
+ */
+
+// Checks an S filter built in caller memory (a stack buffer, IIR_S_init)
+// against one from IIR_S_create, bit by bit, and the parameters refused by
+// IIR_S_init.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Size of the stack buffer (enough for the test file filters)
+#define BUFFER_BYTES 4096
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        _Alignas(IIR_SIMD_ALIGNMENT) char buffer[BUFFER_BYTES];
+        size_t n_bytes = IIR_S_required_bytes( n_coefs );
+
+        if ( (n_bytes == 0) || (n_bytes > BUFFER_BYTES) ){
+            printf( "ERROR: IIR_S_required_bytes: %d bytes for %d coefs\n", (int)n_bytes, n_coefs );
+            return EXIT_FAILURE;
+        }
+
+        // Not valid: not enough coefs, NULL or misaligned buffer
+        if ( IIR_S_required_bytes( 1 ) || IIR_S_init( buffer, 1, b_coefs, a_coefs )
+                || IIR_S_init( NULL, n_coefs, b_coefs, a_coefs )
+                || IIR_S_init( buffer + sizeof(IIR_signal_t), n_coefs, b_coefs, a_coefs ) ){
+            printf( "ERROR: IIR_S_init accepted invalid parameters\n" );
+            error = 1;
+        }
+
+        IIR_S_t *filter = IIR_S_init( buffer, n_coefs, b_coefs, a_coefs );
+        IIR_S_t *ref_filter = IIR_S_create( n_coefs, b_coefs, a_coefs );
+        if ( !filter || ((void*)filter != (void*)buffer) ){
+            printf( "ERROR: IIR_S_init failed\n" );
+            return EXIT_FAILURE;
+        }
+
+        // Same outputs, also after a reset and with the DF2 structure (its
+        // state fits in the buffer)
+        for ( int pass=0; (pass < 3) && !error; pass++ ){
+            if ( pass == 1 ){
+                IIR_S_reset( filter );
+                IIR_S_reset( ref_filter );
+            }else if ( pass == 2 ){
+                IIR_S_set_structure( filter, IIR_STRUCTURE_DF2 );
+                IIR_S_set_structure( ref_filter, IIR_STRUCTURE_DF2 );
+            }
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                IIR_signal_t y = IIR_S_add_input( filter, inputs[i] );
+                if ( y != IIR_S_add_input( ref_filter, inputs[i] ) ){
+                    printf( "ERROR: IIR_S_init filter output (pass %d, i=%d) %f != %f\n", pass, i, y, IIR_S_get_last_output( ref_filter ) );
+                    error = 1;
+                }
+            }
+        }
+        if ( (char*)filter->z < buffer || (char*)(filter->z + n_coefs) > buffer + n_bytes ){
+            printf( "ERROR: IIR_S_init filter state out of the buffer\n" );
+            error = 1;
+        }
+
+        IIR_S_deinit( filter );
+        IIR_S_destroy( ref_filter );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_S: filter built in caller memory does not match the created one\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_S: filter built in caller memory matches the created one\n" );
+    return EXIT_SUCCESS;
+}
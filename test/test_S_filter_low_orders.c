@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 11:10 PM
+ */
+
+// Checks the unrolled kernels of the order 1 to 4 filters (n_coefs 2 to 5)
+// of the S, MS and MD filters (and up to order 8 in IIR_S_process_block)
+// against the generic loop (_IIR_step_tdf2), bit by bit, with the inputs of
+// the test file.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 7
+#define COEF_STEP_RANGE 0.001
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+        for ( int i=0; i < n_inputs; i++ ){
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                frames[i*N_SIGNALS + k] = inputs[i] * (k+1);
+            }
+        }
+
+        for ( int o=0; (o < TEST_LOW_ORDERS) && !error; o++ ){
+            int n_coefs = o+2;
+            IIR_signal_t a[5], b[5], z[5] = {0}, z_signals[N_SIGNALS][5] = {{0}};
+            IIR_signal_t md_a[N_SIGNALS][5], md_b[N_SIGNALS][5];
+            IIR_signal_t low_a[5], low_b[5];
+
+            // Butterworth coefs scaled so that they are not normalized, and
+            // the reference ones, normalized as the filters do
+            for ( int c=0; c < n_coefs; c++ ){
+                low_a[c] = a[c] = test_low_order_a[o][c] * (o+2);
+                low_b[c] = b[c] = test_low_order_b[o][c] * (o+2);
+            }
+            IIR_normalize_coefs( n_coefs, b, a );
+
+            // S filter: sample by sample and by blocks
+            IIR_S_t *s_filter = IIR_S_create( n_coefs, low_b, low_a );
+            IIR_S_t *s_block = IIR_S_create( n_coefs, low_b, low_a );
+            IIR_S_process_block( s_block, inputs, outputs, n_inputs );
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                IIR_signal_t y = _IIR_step_tdf2( n_coefs, a, b, z, inputs[i] );
+                if ( (IIR_S_add_input( s_filter, inputs[i] ) != y) || (outputs[i] != y) ){
+                    printf( "ERROR: IIR_S n_coefs %d (i=%d) %f / %f != %f\n", n_coefs, i, IIR_S_get_last_output( s_filter ), outputs[i], y );
+                    error = 1;
+                }
+            }
+            IIR_S_destroy( s_filter );
+            IIR_S_destroy( s_block );
+
+            // MS filter: sample by sample
+            IIR_MS_t *ms_filter = IIR_MS_create( n_coefs, N_SIGNALS, low_b, low_a );
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                IIR_signal_t *y = IIR_MS_add_input( ms_filter, &frames[i*N_SIGNALS] );
+                for ( int k=0; k < N_SIGNALS; k++ ){
+                    if ( y[k] != _IIR_step_tdf2( n_coefs, a, b, z_signals[k], frames[i*N_SIGNALS + k] ) ){
+                        printf( "ERROR: IIR_MS n_coefs %d (i=%d, signal %d)\n", n_coefs, i, k );
+                        error = 1;
+                        break;
+                    }
+                }
+            }
+            IIR_MS_destroy( ms_filter );
+
+            // MD filter (slightly different coefs for each signal): by blocks
+            IIR_MD_t *md_filter = IIR_MD_create( n_coefs, N_SIGNALS, low_b, low_a );
+            for ( int k=0; k < N_SIGNALS; k++ ){
+                for ( int c=0; c < n_coefs; c++ ){
+                    md_a[k][c] = a[c];
+                    md_b[k][c] = b[c] + COEF_STEP_RANGE * k;
+                    z_signals[k][c] = 0;
+                }
+                IIR_MD_set_coefs_one_signal( md_filter, n_coefs, md_b[k], md_a[k], k );
+            }
+            IIR_MD_process_block( md_filter, frames, outputs, n_inputs );
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                for ( int k=0; k < N_SIGNALS; k++ ){
+                    if ( outputs[i*N_SIGNALS + k] != _IIR_step_tdf2( n_coefs, md_a[k], md_b[k], z_signals[k], frames[i*N_SIGNALS + k] ) ){
+                        printf( "ERROR: IIR_MD n_coefs %d (i=%d, signal %d)\n", n_coefs, i, k );
+                        error = 1;
+                        break;
+                    }
+                }
+            }
+            IIR_MD_destroy( md_filter );
+        }
+
+        // S filter blocks of order 5 to 9 (unrolled up to n_coefs 9 in
+        // IIR_S_process_block), split in two blocks
+        for ( int n_coefs=6; (n_coefs <= 10) && !error; n_coefs++ ){
+            IIR_signal_t a[10], b[10], z[10] = {0};
+            for ( int c=0; c < n_coefs; c++ ){
+                a[c] = c ? 0.5 / (c*c + 1) : 1;
+                b[c] = 0.1 * (c+1);
+            }
+            IIR_S_t *s_block = IIR_S_create( n_coefs, b, a );
+            IIR_S_process_block( s_block, inputs, outputs, n_inputs/2 );
+            IIR_S_process_block( s_block, inputs + n_inputs/2, outputs + n_inputs/2, n_inputs - n_inputs/2 );
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                IIR_signal_t y = _IIR_step_tdf2( n_coefs, a, b, z, inputs[i] );
+                if ( outputs[i] != y ){
+                    printf( "ERROR: IIR_S block n_coefs %d (i=%d) %f != %f\n", n_coefs, i, outputs[i], y );
+                    error = 1;
+                }
+            }
+            IIR_S_destroy( s_block );
+        }
+
+        free( outputs );
+        free( frames );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_S/IIR_MS/IIR_MD: low order filters outputs do not match the generic loop ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_S/IIR_MS/IIR_MD: low order filters outputs match the generic loop ones\n" );
+    return EXIT_SUCCESS;
+}
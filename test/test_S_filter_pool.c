@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 18, 2026, 1:40 AM
+ */
+
+// Checks the filters of an IIR_S_pool_t against filters from IIR_S_create
+// (bit by bit), with filters created and destroyed in between, and the
+// reuse of the pool slots after destroying filters and after a reset.
+// Some filters allocate memory apart from their slots (structures and
+// block state-space mode) before the reset and the pool destruction, which
+// must free it (run with a leak checker).
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// More filters than slots in a slab
+#define N_FILTERS 50
+#define SLAB_SLOTS 16
+#define SIGNAL_NOISE_RANGE 40
+#define SS_BLOCK_SIZE 16
+
+// Make filter f allocate memory apart from its slot (some of them)
+static int set_filter_memory( IIR_S_t *filter, int f ){
+    switch ( f % 4 ){
+        case 1:
+            return IIR_S_set_structure( filter, IIR_STRUCTURE_DF1 );
+        case 2:
+            return IIR_S_set_structure( filter, IIR_STRUCTURE_LATTICE );
+        case 3:
+            return IIR_S_set_state_space_block( filter, SS_BLOCK_SIZE );
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        IIR_S_pool_t *pool = IIR_S_pool_create( n_coefs, SLAB_SLOTS );
+        IIR_S_t *filters[N_FILTERS];
+        IIR_S_t *ref_filters[N_FILTERS];
+        for ( int f=0; f < N_FILTERS; f++ ){
+            filters[f] = IIR_S_pool_create_filter( pool, b_coefs, a_coefs );
+            ref_filters[f] = IIR_S_create( n_coefs, b_coefs, a_coefs );
+        }
+
+        for ( int i=0; (i < n_inputs) && !error; i++ ){
+            // Every 100 inputs, one of the filters is destroyed and created
+            // again (it takes the same slot)
+            if ( (i % 100) == 99 ){
+                int f = (i / 100) % N_FILTERS;
+                IIR_S_t *old = filters[f];
+                IIR_S_pool_destroy_filter( pool, filters[f] );
+                IIR_S_destroy( ref_filters[f] );
+                filters[f] = IIR_S_pool_create_filter( pool, b_coefs, a_coefs );
+                ref_filters[f] = IIR_S_create( n_coefs, b_coefs, a_coefs );
+                if ( filters[f] != old ){
+                    printf( "ERROR: IIR_S_pool: freed slot not reused\n" );
+                    error = 1;
+                }
+            }
+            for ( int f=0; f < N_FILTERS; f++ ){
+                IIR_signal_t noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+                IIR_signal_t y = IIR_S_add_input( filters[f], inputs[i] + noise );
+                if ( y != IIR_S_add_input( ref_filters[f], inputs[i] + noise ) ){
+                    printf( "ERROR: IIR_S_pool filter %d output (i=%d) %f != %f\n", f, i, y, IIR_S_get_last_output( ref_filters[f] ) );
+                    error = 1;
+                    break;
+                }
+            }
+        }
+
+        int n_slabs = pool->n_slabs;
+        if ( (pool->n_filters != N_FILTERS) || (n_slabs != (N_FILTERS + SLAB_SLOTS - 1) / SLAB_SLOTS) ){
+            printf( "ERROR: IIR_S_pool: %d filters in %d slabs\n", pool->n_filters, n_slabs );
+            error = 1;
+        }
+
+        // After a reset the same slots are used again, in the same order
+        for ( int f=0; (f < N_FILTERS) && !error; f++ ){
+            if ( !set_filter_memory( filters[f], f ) ){
+                printf( "ERROR: IIR_S_pool: unable to set the structure of filter %d\n", f );
+                error = 1;
+            }
+        }
+        IIR_S_pool_reset( pool );
+        for ( int f=0; (f < N_FILTERS) && !error; f++ ){
+            if ( IIR_S_pool_create_filter( pool, b_coefs, a_coefs ) != filters[f] ){
+                printf( "ERROR: IIR_S_pool: slot %d not reused after reset\n", f );
+                error = 1;
+            }
+        }
+        // Destroying the pool frees the memory of its live filters too
+        for ( int f=0; (f < N_FILTERS) && !error; f += 2 ){
+            if ( !set_filter_memory( filters[f], f + 1 ) ){
+                printf( "ERROR: IIR_S_pool: unable to set the structure of filter %d\n", f );
+                error = 1;
+            }
+        }
+        if ( pool->n_slabs != n_slabs ){
+            printf( "ERROR: IIR_S_pool: new slabs allocated after reset\n" );
+            error = 1;
+        }
+
+        for ( int f=0; f < N_FILTERS; f++ ){
+            IIR_S_destroy( ref_filters[f] );
+        }
+        IIR_S_pool_destroy( pool );
+
+        if ( IIR_S_pool_create( 1, 0 ) ){
+            printf( "ERROR: IIR_S_pool: created a pool with 1 coefficient\n" );
+            error = 1;
+        }
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_S_pool: pool filters outputs do not match the created ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_S_pool: pool filters outputs match the created ones\n" );
+    return EXIT_SUCCESS;
+}
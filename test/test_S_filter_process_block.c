@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Odd block size so the last block is a partial one
+#define BLOCK_SIZE 37
+// Strides for the strided block processing
+#define X_STRIDE 2
+#define Y_STRIDE 3
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        IIR_signal_t *block_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+
+        // Create two filters: one fed sample by sample, one fed by blocks
+        IIR_S_t *filter1 = IIR_S_create( n_coefs, b_coefs, a_coefs );
+        IIR_S_t *filter2 = IIR_S_create( n_coefs, b_coefs, a_coefs );
+        // And a third one fed with strided inputs and outputs
+        IIR_S_t *filter3 = IIR_S_create( n_coefs, b_coefs, a_coefs );
+        IIR_signal_t *strided_inputs = (IIR_signal_t*) calloc( n_inputs*X_STRIDE, sizeof(IIR_signal_t) );
+        IIR_signal_t *strided_outputs = (IIR_signal_t*) calloc( n_inputs*Y_STRIDE, sizeof(IIR_signal_t) );
+        for ( int i=0; i < n_inputs; i++ ){
+            strided_inputs[i*X_STRIDE] = inputs[i];
+        }
+        
+        for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+            int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+            IIR_S_process_block( filter2, &inputs[i], &block_outputs[i], n );
+            IIR_S_process_block_strided( filter3, &strided_inputs[i*X_STRIDE], X_STRIDE,
+                                         &strided_outputs[i*Y_STRIDE], Y_STRIDE, n );
+        }
+        
+        // Outputs must match bit by bit
+        for ( int i=0; i < n_inputs; i++ ){            
+            if (IIR_S_add_input(filter1, inputs[i]) != block_outputs[i]){
+                printf( "ERROR: (i=%d) %f != %f\n", i, IIR_S_get_last_output(filter1), block_outputs[i] );
+                error = 1;
+                break;
+            }
+            if ( strided_outputs[i*Y_STRIDE] != block_outputs[i] ){
+                printf( "ERROR: strided (i=%d) %f != %f\n", i, strided_outputs[i*Y_STRIDE], block_outputs[i] );
+                error = 1;
+                break;
+            }
+        }
+        
+        if ( (IIR_S_get_last_output(filter1) != IIR_S_get_last_output(filter2))
+                || (IIR_S_get_last_output(filter1) != IIR_S_get_last_output(filter3)) ){
+            printf( "ERROR: last outputs do not match after block processing\n" );
+            error = 1;
+        }
+
+        IIR_S_destroy(filter1);
+        IIR_S_destroy(filter2);
+        IIR_S_destroy(filter3);
+        free(strided_inputs);
+        free(strided_outputs);
+        free(block_outputs);
+        
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_S: Block processing outputs do not match the sample by sample outputs\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_S: Block processing outputs match the sample by sample outputs\n" );
+    return EXIT_SUCCESS;
+}
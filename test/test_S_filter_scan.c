@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 2:30 PM
+ */
+
+// Checks IIR_S_process_scan against the sequential filter for order 1 and
+// order 2 filters, with a long signal built from the reference inputs
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Long enough for several chunks, and not a multiple of the number of chunks
+#define N_SAMPLES 200003
+#define SIGNAL_NOISE_RANGE 40
+// Extra inputs added one by one after the scan to check the final state
+#define N_EXTRA 100
+
+#define N_TEST_FILTERS 4
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+
+    // Order 1 lowpass, order 2 lowpass (butterworth), order 2 resonator
+    // (poles close to the unit circle) and order 2 not normalized
+    int n_coefs[N_TEST_FILTERS] = { 2, 3, 3, 3 };
+    IIR_signal_t b_coefs[N_TEST_FILTERS][3] = {
+        { 0.2, 0.2, 0 },
+        { 0.0674553, 0.1349105, 0.0674553 },
+        { 0.01, 0, -0.01 },
+        { 0.5, 1.0, 0.5 } };
+    IIR_signal_t a_coefs[N_TEST_FILTERS][3] = {
+        { 1, -0.6, 0 },
+        { 1, -1.1429805, 0.4128016 },
+        { 1, -1.8, 0.98 },
+        { 2, -1.5, 0.7 } };
+    
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        // The reference inputs repeated with some noise
+        IIR_signal_t *signal = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * (N_SAMPLES + N_EXTRA) );
+        IIR_signal_t *ref_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * N_SAMPLES );
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * N_SAMPLES );
+        for ( int i=0; i < N_SAMPLES + N_EXTRA; i++ ){
+            float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+            signal[i] = inputs[i % n_inputs] + noise;
+        }
+
+        for ( int t=0; (t < N_TEST_FILTERS) && !error; t++ ){
+            IIR_S_t *ref_filter = IIR_S_create( n_coefs[t], b_coefs[t], a_coefs[t] );
+            IIR_S_t *filter = IIR_S_create( n_coefs[t], b_coefs[t], a_coefs[t] );
+
+            // Start both from the same non rest state
+            for ( int i=0; i < 10; i++ ){
+                IIR_S_add_input( ref_filter, signal[i] );
+                IIR_S_add_input( filter, signal[i] );
+            }
+
+            IIR_S_process_block( ref_filter, signal, ref_outputs, N_SAMPLES );
+            // In place
+            memcpy( outputs, signal, sizeof(IIR_signal_t) * N_SAMPLES );
+            if ( !IIR_S_process_scan( filter, outputs, outputs, N_SAMPLES ) ){
+                printf( "ERROR: scan failed for filter %d\n", t );
+                error = 1;
+                break;
+            }
+
+            // The tolerance is relative to the output range
+            double max_output = 1.0, max_error = 0;
+            for ( int i=0; i < N_SAMPLES; i++ ){
+                if ( fabs(ref_outputs[i]) > max_output ){
+                    max_output = fabs(ref_outputs[i]);
+                }
+            }
+            for ( int i=0; i < N_SAMPLES; i++ ){
+                double err = fabs( (double)outputs[i] - (double)ref_outputs[i] );
+                if ( err > max_error ){
+                    max_error = err;
+                }
+            }
+
+            // The final state must be the same
+            for ( int i=N_SAMPLES; i < N_SAMPLES + N_EXTRA; i++ ){
+                double err = fabs( (double)IIR_S_add_input( filter, signal[i] ) - (double)IIR_S_add_input( ref_filter, signal[i] ) );
+                if ( err > max_error ){
+                    max_error = err;
+                }
+            }
+
+            printf( "Filter %d (order %d): max error %g (relative %g)\n", t, n_coefs[t]-1, max_error, max_error/max_output );
+            if ( max_error > TEST_TOLERANCE * max_output ){
+                printf( "ERROR: scan outputs differ from the sequential ones for filter %d\n", t );
+                error = 1;
+            }
+
+            IIR_S_destroy( ref_filter );
+            IIR_S_destroy( filter );
+        }
+
+        // Only order 1 and 2 filters are supported
+        IIR_S_t *filter = IIR_S_create( loaded_data->n_coefs, loaded_data->b_coefs, loaded_data->a_coefs );
+        if ( (loaded_data->n_coefs > 3) && IIR_S_process_scan( filter, signal, outputs, N_SAMPLES ) ){
+            printf( "ERROR: scan did not fail for an order %d filter\n", loaded_data->n_coefs-1 );
+            error = 1;
+        }
+        IIR_S_destroy( filter );
+
+        free( signal );
+        free( ref_outputs );
+        free( outputs );
+    
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_S: scan outputs do not match the sequential ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_S: scan outputs match the sequential ones within a tolerance of "
+            TEST_TOLERANCE_DIGITS_STR " digits\n" );
+    return EXIT_SUCCESS;
+}
@@ -26,12 +26,21 @@
 #include <time.h>
 
 #include "IIR_filters.h"
+#include "load_test_reference_file.h"
 
 #define STR_VALUE2(arg) #arg
 #define STR_VALUE(name) STR_VALUE2(name)
 #define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
 
 #define DEFAULT_CYCLES 20000000
+#define BLOCK_SIZE 4096
+// Samples of the long signal for the scan test (order 2 filter)
+#define SCAN_SIZE (1<<22)
+// Filter structures (IIR_STRUCTURE_*) compared
+#define N_STRUCTURES 4
+// Low order filters (n_coefs 2 to 5) compared with the generic loop
+// Live filters while creating and destroying filters (heap vs pool)
+#define POOL_FILTERS 1000
 
 int main(int argc, char** argv) {
     
@@ -71,6 +80,167 @@ int main(int argc, char** argv) {
     for ( int i=0; i<10; i++ )
         printf( "%.4" IIR_SIGNAL_FORMAT ", %.4" IIR_SIGNAL_FORMAT "\n", IIR_S_add_input(filter, 1.5), IIR_S_get_last_output(filter) );
     
+    // Same number of inputs, but processed in blocks of BLOCK_SIZE
+    IIR_signal_t *block_input = (IIR_signal_t*) malloc( BLOCK_SIZE * sizeof(IIR_signal_t) );
+    IIR_signal_t *block_output = (IIR_signal_t*) malloc( BLOCK_SIZE * sizeof(IIR_signal_t) );
+    for ( int i=0; i<BLOCK_SIZE; i++ ){
+        block_input[i] = 1.5;
+    }
+    IIR_S_reset( filter );
+
+    clock_t c3 = clock();
+
+    for ( long int i=0; i<n_cycles; i+=BLOCK_SIZE ){
+        int n = (n_cycles-i < BLOCK_SIZE) ? (int)(n_cycles-i) : BLOCK_SIZE;
+        IIR_S_process_block(filter, block_input, block_output, n);
+    }
+
+    clock_t c4 = clock();
+
+    printf( "Block last output: %.4" IIR_SIGNAL_FORMAT "\n", IIR_S_get_last_output(filter) );
+
+    // Same blocks with the block state-space mode
+    IIR_S_reset( filter );
+    IIR_S_set_state_space_block( filter, IIR_S_STATE_SPACE_BLOCK );
+
+    clock_t c5 = clock();
+
+    for ( long int i=0; i<n_cycles; i+=BLOCK_SIZE ){
+        int n = (n_cycles-i < BLOCK_SIZE) ? (int)(n_cycles-i) : BLOCK_SIZE;
+        IIR_S_process_block(filter, block_input, block_output, n);
+    }
+
+    clock_t c6 = clock();
+
+    printf( "State-space last output: %.4" IIR_SIGNAL_FORMAT "\n", IIR_S_get_last_output(filter) );
+
+    // Same blocks with every filter structure
+    const char *structure_names[N_STRUCTURES] = { "TDF2", "DF1", "DF2", "LATTICE" };
+    double structure_times[N_STRUCTURES];
+    for ( int s=0; s<N_STRUCTURES; s++ ){
+        IIR_S_t *s_filter = IIR_S_create_structure( n_coefs, b, a, s );
+        structure_times[s] = -1;
+        if ( !s_filter ){
+            continue;
+        }
+
+        clock_t cs1 = clock();
+
+        for ( long int i=0; i<n_cycles; i+=BLOCK_SIZE ){
+            int n = (n_cycles-i < BLOCK_SIZE) ? (int)(n_cycles-i) : BLOCK_SIZE;
+            IIR_S_process_block(s_filter, block_input, block_output, n);
+        }
+
+        clock_t cs2 = clock();
+
+        structure_times[s] = (double)(cs2-cs1)/CLOCKS_PER_SEC;
+        printf( "%s last output: %.4" IIR_SIGNAL_FORMAT "\n", structure_names[s], IIR_S_get_last_output(s_filter) );
+        IIR_S_destroy( s_filter );
+    }
+
+    // One long signal with an order 2 filter: sequential and scan
+    IIR_signal_t a2[] = {1.0000, -1.1430, 0.4128};
+    IIR_signal_t b2[] = {0.0675, 0.1349, 0.0675};
+    IIR_S_t *filter2 = IIR_S_create( 3, b2, a2 );
+    IIR_signal_t *scan_signal = (IIR_signal_t*) malloc( SCAN_SIZE * sizeof(IIR_signal_t) );
+    for ( int i=0; i<SCAN_SIZE; i++ ){
+        scan_signal[i] = 1.5;
+    }
+
+    clock_t c7 = clock();
+
+    IIR_S_process_in_place(filter2, scan_signal, SCAN_SIZE);
+
+    clock_t c8 = clock();
+
+    IIR_S_reset( filter2 );
+    for ( int i=0; i<SCAN_SIZE; i++ ){
+        scan_signal[i] = 1.5;
+    }
+
+    clock_t c9 = clock();
+
+    IIR_S_process_scan(filter2, scan_signal, scan_signal, SCAN_SIZE);
+
+    clock_t c10 = clock();
+
+    printf( "Scan last output: %.4" IIR_SIGNAL_FORMAT "\n", IIR_S_get_last_output(filter2) );
+
+    // Low order filters (Butterworth, order 1 to 4): IIR_S_add_input (unrolled
+    // kernels) and the generic loop (_IIR_step_tdf2)
+    double low_times[TEST_LOW_ORDERS], generic_times[TEST_LOW_ORDERS];
+    for ( int o=0; o<TEST_LOW_ORDERS; o++ ){
+        IIR_S_t *low_filter = IIR_S_create( o+2, test_low_order_b[o], test_low_order_a[o] );
+
+        clock_t cl1 = clock();
+
+        for ( long int i=0; i<n_cycles; i++ ){
+            IIR_S_add_input(low_filter, 1.5);
+        }
+
+        clock_t cl2 = clock();
+
+        IIR_signal_t y_fast = IIR_S_get_last_output(low_filter);
+        IIR_S_reset( low_filter );
+
+        clock_t cl3 = clock();
+
+        for ( long int i=0; i<n_cycles; i++ ){
+            low_filter->last_output = _IIR_step_tdf2(low_filter->n_coefs, low_filter->a, low_filter->b, low_filter->z, 1.5);
+        }
+
+        clock_t cl4 = clock();
+
+        printf( "n_coefs %d last output: %.4" IIR_SIGNAL_FORMAT " (generic loop: %.4" IIR_SIGNAL_FORMAT ")\n",
+                o+2, y_fast, IIR_S_get_last_output(low_filter) );
+        low_times[o] = (double)(cl2-cl1)/CLOCKS_PER_SEC;
+        generic_times[o] = (double)(cl4-cl3)/CLOCKS_PER_SEC;
+        IIR_S_destroy( low_filter );
+    }
+
+    // Create and destroy n_cycles/10 filters (one replaced each time, with
+    // POOL_FILTERS live filters), with IIR_S_create and with a pool
+    long int n_sessions = n_cycles/10;
+    IIR_S_t **live = (IIR_S_t**) malloc( sizeof(IIR_S_t*) * POOL_FILTERS );
+    for ( int f=0; f<POOL_FILTERS; f++ ){
+        live[f] = IIR_S_create( n_coefs, b, a );
+    }
+
+    clock_t cp1 = clock();
+
+    for ( long int i=0; i<n_sessions; i++ ){
+        int f = (int)((i * 7919) % POOL_FILTERS);
+        IIR_S_destroy( live[f] );
+        live[f] = IIR_S_create( n_coefs, b, a );
+    }
+
+    clock_t cp2 = clock();
+
+    for ( int f=0; f<POOL_FILTERS; f++ ){
+        IIR_S_destroy( live[f] );
+    }
+    IIR_S_pool_t *pool = IIR_S_pool_create( n_coefs, 0 );
+    for ( int f=0; f<POOL_FILTERS; f++ ){
+        live[f] = IIR_S_pool_create_filter( pool, b, a );
+    }
+
+    clock_t cp3 = clock();
+
+    for ( long int i=0; i<n_sessions; i++ ){
+        int f = (int)((i * 7919) % POOL_FILTERS);
+        IIR_S_pool_destroy_filter( pool, live[f] );
+        live[f] = IIR_S_pool_create_filter( pool, b, a );
+    }
+
+    clock_t cp4 = clock();
+
+    IIR_S_pool_destroy( pool );
+    free( live );
+
+    free( scan_signal );
+    IIR_S_destroy( filter2 );
+    free( block_input );
+    free( block_output );
     IIR_S_destroy( filter );
     
     printf( "Filter correctly destroyed\n" );
@@ -81,6 +251,34 @@ int main(int argc, char** argv) {
     double time = (double)(c2-c1)/CLOCKS_PER_SEC;
     printf( "Test results:\n\tTotal time: %.4lf sec\n", time );
     printf( "\tTime to add one input: %.4lf usec\n", time/n_cycles*1e6 );
+    double block_time = (double)(c4-c3)/CLOCKS_PER_SEC;
+    printf( "\tTotal time (blocks of %d inputs): %.4lf sec\n", BLOCK_SIZE, block_time );
+    printf( "\tTime to add one input (blocks of %d inputs): %.4lf usec\n", BLOCK_SIZE, block_time/n_cycles*1e6 );
+    double ss_time = (double)(c6-c5)/CLOCKS_PER_SEC;
+    printf( "\tTotal time (state-space, blocks of %d inputs): %.4lf sec\n", IIR_S_STATE_SPACE_BLOCK, ss_time );
+    printf( "\tTime to add one input (state-space, blocks of %d inputs): %.4lf usec\n", IIR_S_STATE_SPACE_BLOCK, ss_time/n_cycles*1e6 );
+    for ( int s=0; s<N_STRUCTURES; s++ ){
+        if ( structure_times[s] < 0 ){
+            printf( "\tStructure %s: not available for this filter\n", structure_names[s] );
+        }else{
+            printf( "\tTime to add one input (structure %s, blocks of %d inputs): %.4lf usec (%.2lf Msamples/sec)\n",
+                    structure_names[s], BLOCK_SIZE, structure_times[s]/n_cycles*1e6,
+                    n_cycles/structure_times[s]*1e-6 );
+        }
+    }
+    for ( int o=0; o<TEST_LOW_ORDERS; o++ ){
+        printf( "\tTime to add one input (n_coefs %d): %.4lf usec (generic loop: %.4lf usec, speedup %.2lfx)\n",
+                o+2, low_times[o]/n_cycles*1e6, generic_times[o]/n_cycles*1e6,
+                generic_times[o]/low_times[o] );
+    }
+    double seq2_time = (double)(c8-c7)/CLOCKS_PER_SEC;
+    double scan_time = (double)(c10-c9)/CLOCKS_PER_SEC;
+    printf( "\tTime to add one input (order 2, %d inputs, sequential): %.4lf usec\n", SCAN_SIZE, seq2_time/SCAN_SIZE*1e6 );
+    printf( "\tTime to add one input (order 2, %d inputs, scan): %.4lf usec (CPU time of all threads)\n", SCAN_SIZE, scan_time/SCAN_SIZE*1e6 );
+    double heap_time = (double)(cp2-cp1)/CLOCKS_PER_SEC;
+    double pool_time = (double)(cp4-cp3)/CLOCKS_PER_SEC;
+    printf( "\tTime to destroy and create one filter (%d live filters): %.4lf usec (pool: %.4lf usec, speedup %.2lfx)\n",
+            POOL_FILTERS, heap_time/n_sessions*1e6, pool_time/n_sessions*1e6, heap_time/pool_time );
         
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 1:05 PM
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+// Chunk size for IIR_S_process_block calls: not a multiple of the state-space
+// block sizes, so blocks and sequential filtering are mixed
+#define CHUNK_SIZE 100
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+    
+    int error = 0;
+    int block_sizes[] = { 1, 7, 16, IIR_S_STATE_SPACE_BLOCK, 64 };
+    int n_block_sizes = sizeof(block_sizes)/sizeof(block_sizes[0]);
+
+    test_data_t *loaded_data = load_filter_test_data_fields_binary( argv[1] );
+    
+    if ( loaded_data ){
+        
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+        IIR_signal_t *correct_outputs = loaded_data->correct_outputs;
+
+        IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+
+        // The tolerance is relative to the output range
+        double max_output = 1.0;
+        for ( int i=0; i < n_inputs; i++ ){
+            if ( fabs(correct_outputs[i]) > max_output ){
+                max_output = fabs(correct_outputs[i]);
+            }
+        }
+
+        for ( int t=0; (t < n_block_sizes) && !error; t++ ){
+            IIR_S_t *filter = IIR_S_create( n_coefs, b_coefs, a_coefs );
+            if ( !IIR_S_set_state_space_block( filter, block_sizes[t] ) ){
+                printf( "ERROR: unable to set the state-space block size %d\n", block_sizes[t] );
+                return EXIT_FAILURE;
+            }
+
+            for ( int i=0; i < n_inputs; i+=CHUNK_SIZE ){
+                int n = (n_inputs-i < CHUNK_SIZE) ? n_inputs-i : CHUNK_SIZE;
+                IIR_S_process_block( filter, &inputs[i], &outputs[i], n );
+            }
+
+            double max_error = 0;
+            for ( int i=0; i < n_inputs; i++ ){
+                double err = fabs( (double)outputs[i] - (double)correct_outputs[i] );
+                if ( err > max_error ){
+                    max_error = err;
+                }
+            }
+            printf( "Block size %d: max error %g (relative %g)\n", block_sizes[t], max_error, max_error/max_output );
+            if ( (max_error > TEST_TOLERANCE * max_output)
+                    || (IIR_S_get_last_output(filter) != outputs[n_inputs-1]) ){
+                printf( "ERROR: state-space outputs differ from the reference with block size %d\n", block_sizes[t] );
+                error = 1;
+            }
+
+            // Disabling the mode returns to the exact sequential filter
+            IIR_S_set_state_space_block( filter, 0 );
+            IIR_S_reset( filter );
+            IIR_S_process_block( filter, inputs, outputs, n_inputs );
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                if ( outputs[i] != correct_outputs[i] ){
+                    printf( "ERROR: outputs with the mode disabled are not exactly equal (i=%d)\n", i );
+                    error = 1;
+                }
+            }
+
+            IIR_S_destroy( filter );
+        }
+
+        free( outputs );
+    
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+               
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+        
+    if (error){
+        printf( "\nERROR: IIR_S: block state-space outputs do not match the reference\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_S: block state-space outputs match the reference within a tolerance of "
+            TEST_TOLERANCE_DIGITS_STR " digits\n" );
+    return EXIT_SUCCESS;
+}
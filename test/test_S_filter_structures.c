@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 8:40 PM
+ */
+
+// Checks every filter structure against the transposed direct form II one
+// (within rounding errors) and, for each structure, the block and strided
+// processing against the sample by sample one (bit by bit).
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define BLOCK_SIZE 37
+#define X_STRIDE 2
+#define Y_STRIDE 3
+#define N_STRUCTURES 4
+
+// Max error relative to the max output
+#ifdef IIR_USE_SIGNAL_TYPE_DOUBLE
+    #define TOLERANCE 1e-10
+#else
+    #define TOLERANCE 1e-4
+#endif
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+    const char *names[N_STRUCTURES] = { "TDF2", "DF1", "DF2", "LATTICE" };
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        int n_coefs = loaded_data->n_coefs;
+        int n_inputs = loaded_data->n_inputs;
+        IIR_signal_t *a_coefs = loaded_data->a_coefs;
+        IIR_signal_t *b_coefs = loaded_data->b_coefs;
+        IIR_signal_t *inputs = loaded_data->inputs;
+
+        IIR_signal_t *ref_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+        IIR_signal_t *block_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+        IIR_signal_t *strided_outputs = (IIR_signal_t*) calloc( n_inputs*Y_STRIDE, sizeof(IIR_signal_t) );
+        IIR_signal_t *strided_inputs = (IIR_signal_t*) calloc( n_inputs*X_STRIDE, sizeof(IIR_signal_t) );
+        for ( int i=0; i < n_inputs; i++ ){
+            strided_inputs[i*X_STRIDE] = inputs[i];
+        }
+
+        // Reference: the default structure
+        IIR_S_t *ref_filter = IIR_S_create( n_coefs, b_coefs, a_coefs );
+        IIR_signal_t max_output = 0;
+        for ( int i=0; i < n_inputs; i++ ){
+            ref_outputs[i] = IIR_S_add_input( ref_filter, inputs[i] );
+            if ( ref_outputs[i] > max_output ){
+                max_output = ref_outputs[i];
+            }
+            if ( -ref_outputs[i] > max_output ){
+                max_output = -ref_outputs[i];
+            }
+        }
+        IIR_S_destroy( ref_filter );
+
+        for ( int s=0; (s < N_STRUCTURES) && !error; s++ ){
+            IIR_S_t *filter1 = IIR_S_create_structure( n_coefs, b_coefs, a_coefs, s );
+            IIR_S_t *filter2 = IIR_S_create_structure( n_coefs, b_coefs, a_coefs, s );
+            IIR_S_t *filter3 = IIR_S_create_structure( n_coefs, b_coefs, a_coefs, s );
+            if ( !filter1 || !filter2 || !filter3 ){
+                printf( "ERROR: unable to create the %s filters\n", names[s] );
+                error = 1;
+                break;
+            }
+
+            for ( int i=0; i < n_inputs; i+=BLOCK_SIZE ){
+                int n = (n_inputs-i < BLOCK_SIZE) ? n_inputs-i : BLOCK_SIZE;
+                IIR_S_process_block( filter2, &inputs[i], &block_outputs[i], n );
+                IIR_S_process_block_strided( filter3, &strided_inputs[i*X_STRIDE], X_STRIDE,
+                                             &strided_outputs[i*Y_STRIDE], Y_STRIDE, n );
+            }
+
+            IIR_signal_t max_error = 0;
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                IIR_signal_t y = IIR_S_add_input( filter1, inputs[i] );
+                if ( (y != block_outputs[i]) || (y != strided_outputs[i*Y_STRIDE]) ){
+                    printf( "ERROR: %s block/strided (i=%d) %f != %f / %f\n", names[s], i, y, block_outputs[i], strided_outputs[i*Y_STRIDE] );
+                    error = 1;
+                }
+                IIR_signal_t diff = (y > ref_outputs[i]) ? y - ref_outputs[i] : ref_outputs[i] - y;
+                if ( diff > max_error ){
+                    max_error = diff;
+                }
+            }
+            printf( "%s: max relative error %g\n", names[s], (double)(max_error / max_output) );
+            if ( max_error > TOLERANCE * max_output ){
+                printf( "ERROR: %s outputs differ from the TDF2 ones\n", names[s] );
+                error = 1;
+            }
+
+            // Back to rest: same outputs again
+            IIR_S_reset( filter1 );
+            for ( int i=0; (i < n_inputs) && !error; i++ ){
+                if ( IIR_S_add_input( filter1, inputs[i] ) != block_outputs[i] ){
+                    printf( "ERROR: %s output (i=%d) differs after reset\n", names[s], i );
+                    error = 1;
+                }
+            }
+
+            IIR_S_destroy( filter1 );
+            IIR_S_destroy( filter2 );
+            IIR_S_destroy( filter3 );
+        }
+
+        // Unstable filters have no lattice form
+        IIR_signal_t a_unstable[] = { 1.0, -2.5, 1.0 };
+        IIR_signal_t b_unstable[] = { 1.0, 0.0, 0.0 };
+        IIR_S_t *unstable = IIR_S_create( 3, b_unstable, a_unstable );
+        if ( IIR_S_set_structure( unstable, IIR_STRUCTURE_LATTICE ) ){
+            printf( "ERROR: lattice structure accepted for an unstable filter\n" );
+            error = 1;
+        }
+        IIR_S_destroy( unstable );
+
+        free( ref_outputs );
+        free( block_outputs );
+        free( strided_outputs );
+        free( strided_inputs );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR_S: filter structures outputs do not match\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR_S: filter structures outputs match\n" );
+    return EXIT_SUCCESS;
+}
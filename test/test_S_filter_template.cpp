@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2018 Jose Marco de la Rosa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Author: Jose Marco
+ *
+ * Created on October 17, 2026, 10:05 PM
+ */
+
+// Checks the C++ filters (IIR_filters.hpp) against the C filters: IIR::Filter
+// against IIR_S_t, IIR::MSFilter against IIR_MS_t and IIR::MDFilter against
+// IIR_MD_t, bit by bit.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IIR_filters.h>
+#include <IIR_filters.hpp>
+#include "load_test_reference_file.h"
+
+#define STR_VALUE2(arg) #arg
+#define STR_VALUE(name) STR_VALUE2(name)
+#define IIR_SIGNAL_TYPE_STR STR_VALUE(IIR_SIGNAL_TYPE)
+
+#define N_SIGNALS 5
+#define SIGNAL_NOISE_RANGE 40
+#define COEF_STEP_RANGE 0.001
+// Number of coefs supported by this test (N is a template parameter)
+#define MAX_COEFS 12
+
+template<int N>
+static int check(test_data_t *data) {
+
+    int error = 0;
+    int n_inputs = data->n_inputs;
+    IIR_signal_t *a_coefs = data->a_coefs;
+    IIR_signal_t *b_coefs = data->b_coefs;
+    IIR_signal_t *inputs = data->inputs;
+
+    // One signal
+    IIR_S_t *s_filter = IIR_S_create( N, b_coefs, a_coefs );
+    IIR::Filter<IIR_signal_t, N> filter( b_coefs, a_coefs );
+    IIR_signal_t *outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs );
+    filter.process_block( inputs, outputs, n_inputs );
+    for ( int i=0; (i < n_inputs) && !error; i++ ){
+        if ( IIR_S_add_input( s_filter, inputs[i] ) != outputs[i] ){
+            printf( "ERROR: IIR::Filter (i=%d) %f != %f\n", i, IIR_S_get_last_output( s_filter ), outputs[i] );
+            error = 1;
+        }
+    }
+    filter.reset();
+    IIR_S_reset( s_filter );
+    for ( int i=0; (i < n_inputs) && !error; i++ ){
+        if ( IIR_S_add_input( s_filter, inputs[i] ) != filter.add_input( inputs[i] ) ){
+            printf( "ERROR: IIR::Filter add_input (i=%d)\n", i );
+            error = 1;
+        }
+    }
+    IIR_S_destroy( s_filter );
+    free( outputs );
+
+    // N_SIGNALS noisy versions of the input, stored frame by frame
+    IIR_signal_t *frames = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+    IIR_signal_t *ms_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+    IIR_signal_t *md_outputs = (IIR_signal_t*) malloc( sizeof(IIR_signal_t) * n_inputs * N_SIGNALS );
+    for ( int i=0; i < n_inputs; i++ ){
+        for ( int k=0; k < N_SIGNALS; k++ ){
+            float noise = ((((float)rand())/RAND_MAX) * SIGNAL_NOISE_RANGE)-(SIGNAL_NOISE_RANGE/2);
+            frames[i*N_SIGNALS + k] = inputs[i] + noise;
+        }
+    }
+
+    // Multiple signals, shared and different coefs (slightly different b
+    // coefs for each signal)
+    IIR_MS_t *ms_filter = IIR_MS_create( N, N_SIGNALS, b_coefs, a_coefs );
+    IIR_MD_t *md_filter = IIR_MD_create( N, N_SIGNALS, b_coefs, a_coefs );
+    IIR::MSFilter<IIR_signal_t, N, N_SIGNALS> ms( b_coefs, a_coefs );
+    IIR::MDFilter<IIR_signal_t, N, N_SIGNALS> md( b_coefs, a_coefs );
+    for ( int k=0; k < N_SIGNALS; k++ ){
+        IIR_signal_t b_k[N];
+        for ( int c=0; c < N; c++ ){
+            b_k[c] = b_coefs[c] + ((c%2) ? COEF_STEP_RANGE * k : 0);
+        }
+        IIR_MD_set_coefs_one_signal( md_filter, N, b_k, a_coefs, k );
+        md.set_coefs_one_signal( b_k, a_coefs, k );
+    }
+    ms.process_block( frames, ms_outputs, n_inputs );
+    md.process_block( frames, md_outputs, n_inputs );
+    for ( int i=0; (i < n_inputs) && !error; i++ ){
+        IIR_signal_t *ms_y = IIR_MS_add_input( ms_filter, &frames[i*N_SIGNALS] );
+        IIR_signal_t *md_y = IIR_MD_add_input( md_filter, &frames[i*N_SIGNALS] );
+        for ( int k=0; k < N_SIGNALS; k++ ){
+            if ( (ms_y[k] != ms_outputs[i*N_SIGNALS + k]) || (md_y[k] != md_outputs[i*N_SIGNALS + k]) ){
+                printf( "ERROR: IIR::MSFilter/IIR::MDFilter (i=%d, signal %d)\n", i, k );
+                error = 1;
+                break;
+            }
+        }
+    }
+    for ( int k=0; (k < N_SIGNALS) && !error; k++ ){
+        if ( (ms.last_output()[k] != IIR_MS_get_last_output( ms_filter )[k])
+                || (md.last_output()[k] != IIR_MD_get_last_output( md_filter )[k]) ){
+            printf( "ERROR: IIR::MSFilter/IIR::MDFilter last output (signal %d)\n", k );
+            error = 1;
+        }
+    }
+
+    IIR_MS_destroy( ms_filter );
+    IIR_MD_destroy( md_filter );
+    free( frames );
+    free( ms_outputs );
+    free( md_outputs );
+
+    return error;
+}
+
+// Call check<N> with N == n_coefs
+template<int N>
+static int check_n_coefs(test_data_t *data) {
+    if ( data->n_coefs == N ){
+        return check<N>( data );
+    }
+    return check_n_coefs<N+1>( data );
+}
+
+template<>
+int check_n_coefs<MAX_COEFS+1>(test_data_t *data) {
+    printf( "ERROR: %d coefs not supported by the test (max is %d)\n", data->n_coefs, MAX_COEFS );
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2){
+        printf( get_usage_str( argv[0] ) );
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    test_data_t *loaded_data = load_filter_test_data_fields( argv[1] );
+
+    if ( loaded_data ){
+
+        error = check_n_coefs<2>( loaded_data );
+
+        printf( "Using IIR_SIGNAL_TYPE %s\n", STR_VALUE(IIR_SIGNAL_TYPE) );
+
+    }else{
+        printf( "Error loading the test data file.\n" );
+        return EXIT_FAILURE;
+    }
+
+    if (error){
+        printf( "\nERROR: IIR::Filter/IIR::MSFilter/IIR::MDFilter: outputs do not match the C filters ones\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "\nSUCCESS: IIR::Filter/IIR::MSFilter/IIR::MDFilter: outputs match the C filters ones\n" );
+    return EXIT_SUCCESS;
+}